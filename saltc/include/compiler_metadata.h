@@ -10,6 +10,7 @@
 #include <string>
 #include <array>
 #include <vector>
+#include <stdint.h>
 using std::string;
 
 namespace salt
@@ -23,8 +24,27 @@ namespace salt
         /* Format version identificator */
         static const std::array<byte, 2> SCC_VERSION;
 
+        /* Last format version with newline delimited instructions, files
+           up to this version are still accepted */
+        constexpr static uint16_t SCC_LEGACY_VERSION = 3;
+
         /* Compiler signature */
         static const std::array<byte, 8> COMPILER_SIGNATURE;
+
+        /* Bits of the header flags field (offset 12) */
+        constexpr static uint SCC_FLAG_COMPACT = 0x01;
+        constexpr static uint SCC_FLAG_SECTIONED = 0x02;
+        constexpr static uint SCC_FLAG_COMPRESSED = 0x04;
+        constexpr static uint SCC_FLAG_VERIFIED = 0x08;
+
+        /**
+         * Read the flags of a 64 byte header. The field is new in SCC4, so
+         * files of a legacy version have no flags, whatever is stored there.
+         *
+         * @param   header  first byte of the header
+         * @return  flags of the file
+         */
+        static uint getFlags(const byte *header);
     };
 
 };
@@ -0,0 +1,132 @@
+/**
+ * The constant folder evaluates constant expressions in the token stream at
+ * compile time and propagates the values of const objects into their uses.
+ */
+#ifndef CONSTANT_FOLDER_H_
+#define CONSTANT_FOLDER_H_
+
+#include "token.h"
+#include "utils.h"
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using std::string;
+
+namespace salt
+{
+
+/* Value of an int, float, bool or string literal known at compile time. */
+struct ConstValue
+{
+    TokenType type = TOK_0;
+    int64_t integer = 0;
+    double real = 0;
+    bool boolean = false;
+    string str;
+    char quote = '"';
+};
+
+/**
+ * The ConstantFolder class rewrites the tokens of a source file, replacing
+ * every constant (sub)expression with a single literal token, so
+ * `1 << 20` or a concatenation of string constants becomes one literal, and
+ * the compiler creates one readonly object instead of emitting instructions
+ * for it. Names of `const` objects with a known value are replaced with that
+ * value, as long as they are visible in the current block.
+ *
+ * Expressions are parsed starting after assignment operators, `return`,
+ * `throw`, `if`, `elif`, `while` and at call statements. If the parser finds
+ * something it doesn't understand in an expression, the whole expression is
+ * left untouched.
+ */
+class ConstantFolder
+{
+private:
+    /* A parsed (sub)expression, spanning tokens [begin, end) */
+    struct Node {
+        size_t begin;
+        size_t end;
+        bool constant;
+        ConstValue value;
+        bool grouped = false;
+    };
+
+    /* Token range replaced with a single literal */
+    struct Fold {
+        size_t begin;
+        size_t end;
+        Token literal;
+    };
+
+    const std::vector<Token> input;
+    std::vector<Fold> folds;
+
+    /* Scopes of known names, a name mapped to TOK_0 is not a constant */
+    std::vector<std::map<string, ConstValue>> scopes;
+
+    size_t folded = 0;
+    size_t propagated = 0;
+
+    /* Return the token at idx, or null_token past the end */
+    const Token& at(size_t idx) const;
+
+    /* Parse an expression, throwing if it can't be folded safely */
+    Node parseExpression(size_t& idx, int min_precedence = 0);
+    Node parseOperand(size_t& idx);
+
+    /* Parse call arguments or an index, up to the closing bracket */
+    void parseArguments(size_t& idx, TokenType close);
+
+    /* Record a fold for the node if it's worth replacing */
+    void record(const Node& node);
+
+    /* Find a visible constant with the given name */
+    const ConstValue* lookup(const string& name) const;
+
+    /* Return true if an expression starts after the token at idx */
+    bool isExpressionStart(size_t idx) const;
+
+public:
+    ConstantFolder(const std::vector<Token>& tokens);
+
+    /* Return the folded tokens */
+    std::vector<Token> fold();
+
+    /* Amount of folded expressions and propagated constants */
+    size_t getFoldedAmount() const;
+    size_t getPropagatedAmount() const;
+
+    /**
+     * Parse the value of a literal token. Returns a value with TOK_0 type
+     * if the token is not an int, float, bool or non-raw string literal.
+     */
+    static ConstValue parseLiteral(const Token& token);
+
+    /* Create a literal token with the given value */
+    static Token makeLiteral(const ConstValue& value, InStringPosition pos);
+
+    /**
+     * Evaluate a binary operator. Returns a value with TOK_0 type if the
+     * operation can't be done at compile time, like a division by zero.
+     */
+    static ConstValue evaluate(
+        TokenType op,
+        const ConstValue& left,
+        const ConstValue& right);
+
+    /* Evaluate an unary operator (- or !) */
+    static ConstValue evaluate(TokenType op, const ConstValue& value);
+
+    /* Synthesize a readonly object holding the value */
+    static std::vector<byte> makeObject(uint id, const ConstValue& value);
+
+    /* Binding power of a binary operator, 0 if it's not one */
+    static int precedence(TokenType op);
+
+}; // salt::ConstantFolder
+
+} // salt
+
+#endif // CONSTANT_FOLDER_H_
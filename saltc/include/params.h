@@ -11,6 +11,7 @@
 #include "utils.h"
 #include <queue>
 #include <string>
+#include <vector>
 
 using std::string;
 
@@ -26,8 +27,14 @@ class Params
 private:
     string executable_path;
     string input_path;
+    std::vector<string> link_paths;
     string output_path = "a.scc";
     bool builtins = true;
+    bool compact = false;
+    string compression;
+    bool disassemble = false;
+    bool link = false;
+    bool validate = false;
 
     /**
      * The initObject method is responsible for parse arguments and
@@ -59,6 +66,24 @@ public:
     /* Gets import init switch value */
     bool getBuiltinsSwitch();
 
+    /* Gets compact operand encoding switch value */
+    bool getCompactSwitch();
+
+    /* Gets section compression argument value, empty if not given */
+    string getCompression();
+
+    /* Gets disassemble switch value */
+    bool getDisassembleSwitch();
+
+    /* Gets validate switch value */
+    bool getValidateSwitch();
+
+    /* Gets link switch value */
+    bool getLinkSwitch();
+
+    /* Gets paths of the modules linked with the input file */
+    std::vector<string> getLinkPaths();
+
     static void print_help_page();
 
 }; // salt::core::Params
@@ -0,0 +1,162 @@
+/**
+ * The bytecode reader decodes instructions and operands from raw SCC
+ * bytecode, for both the fixed and the compact operand encodings and both the
+ * SCC4 binary and the legacy newline delimited layouts.
+ *
+ */
+#ifndef BYTECODE_READER_H_
+#define BYTECODE_READER_H_
+
+#include <string>
+#include <stdint.h>
+
+#include "../utils.h"
+#include "synthesizer.h"
+#include "instruction_set.h"
+
+namespace salt
+{
+
+    /**
+     * The bytecode reader is a cursor over a block of bytecode, which it
+     * doesn't own. Each read method moves the cursor past the read value.
+     * Reading past the end of the block throws a
+     * ValidatorError::invalid_data_width.
+     */
+    class BytecodeReader
+    {
+    public:
+
+        /**
+         * Create a reader over @a __n bytes starting at @a __b.
+         *
+         * @param   __b       pointer to the first byte
+         * @param   __n       amount of bytes
+         * @param   encoding  operand encoding of the bytecode
+         */
+        BytecodeReader(const byte *__b, size_t __n, Encoding encoding);
+
+        /* Current position of the cursor */
+        size_t tell() const;
+
+        /* Move the cursor to the given position */
+        void seek(size_t __n);
+
+        /* Return true if the cursor reached the end of the block */
+        bool atEnd() const;
+
+        /* Return the byte under the cursor, without moving it */
+        byte peek() const;
+
+        byte readByte();
+        uint readId();
+        int readImmediate();
+        int64_t readInt();
+        float readFloat();
+        std::string readString();
+
+        /* Move the cursor over a string, without copying it */
+        void skipString();
+
+        /**
+         * Read an unsigned LEB128 varint, or a zigzag encoded signed one.
+         *
+         * @throw   invalid_data_width
+         */
+        uint64_t readVarUint();
+        int64_t readVarInt();
+
+        /**
+         * Select the legacy SCC3 layout, where each instruction starts with a
+         * 5 character mnemonic (or a '@' for labels) and ends with a newline,
+         * instead of the SCC4 one, where it starts with an opcode byte.
+         *
+         * @param   legacy  true to read the SCC3 layout
+         */
+        void setLegacy(bool legacy);
+
+        /**
+         * Read the start of the next instruction, leaving the cursor at its
+         * first operand. Labels have no description, their name is stored
+         * in @a __label instead.
+         *
+         * @param   __label  set to the label name, without the '@'
+         * @return  description of the instruction, or nullptr for labels
+         * @throw   unknown_instruction, nonterminated_instruction
+         */
+        const InstructionInfo *readInstruction(std::string& __label);
+
+        /**
+         * Move the cursor over the next instruction and all its operands,
+         * without decoding or copying any of them. In the legacy layout the
+         * newline is left for endInstruction().
+         *
+         * @return  description of the instruction, or nullptr for labels
+         * @throw   unknown_instruction, nonterminated_instruction,
+         *          invalid_data_width
+         */
+        const InstructionInfo *skipInstruction();
+
+        /**
+         * Finish reading an instruction, which only has to check the
+         * terminating newline in the legacy layout.
+         *
+         * @throw   nonterminated_instruction
+         */
+        void endInstruction();
+
+        /**
+         * Read and decode a single operand of the given type.
+         *
+         * @param   type  type of the operand
+         * @return  decoded operand
+         * @throw   invalid_data_width
+         */
+        Operand readOperand(OperandType type);
+
+        /**
+         * Move the cursor over a single operand of the given type, without
+         * decoding its value.
+         *
+         * @param   type  type of the operand
+         * @throw   invalid_data_width
+         */
+        void skipOperand(OperandType type);
+
+        /**
+         * Read a raw value at its full width, regardless of the encoding.
+         * Used for the header fields, which are never compacted.
+         *
+         * @throw   invalid_data_width
+         */
+        template<typename T>
+        T readRaw()
+        {
+            require(sizeof(T));
+            T value;
+            for (size_t i = 0; i < sizeof(T); i++)
+                ((byte *) &value)[i] = data[cursor + i];
+            cursor += sizeof(T);
+            return value;
+        }
+
+    private:
+
+        /* Check if @a __n more bytes can be read */
+        void require(size_t __n) const;
+
+        /* Read the opcode or mnemonic, the label name is skipped if
+           @a __label is nullptr */
+        const InstructionInfo *readHead(std::string *__label);
+
+        const byte *data;
+        size_t size;
+        size_t cursor = 0;
+        Encoding encoding;
+        bool legacy = false;
+
+    };
+
+} // salt
+
+#endif // BYTECODE_READER_H_
@@ -0,0 +1,150 @@
+/**
+ * The compressor module holds the LZ codec used for compressed SCC
+ * sections, so there is no dependency on an external library.
+ *
+ */
+#ifndef COMPRESSOR_H_
+#define COMPRESSOR_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "../utils.h"
+
+namespace salt
+{
+
+    enum Compression
+    {
+        COMPRESSION_NONE,
+        COMPRESSION_FAST,   // single hash probe, fast to write
+        COMPRESSION_SMALL   // hash chains and lazy matching, smaller output
+    };
+
+    /**
+     * The compressed data is a list of sequences, each made of:
+     *
+     *  - a token byte: the high 4 bits are the amount of literals, the low 4
+     *    bits are the match length minus MIN_MATCH
+     *  - if the literal nibble is 15, more bytes which are added to it, all
+     *    of them 255 except the last one
+     *  - the literal bytes
+     *  - a 2 byte little endian offset, counted back from the current
+     *    position, and the extra match length bytes like for the literals
+     *
+     * The last sequence ends right after its literals. This is the same
+     * layout as an LZ4 block, so both compression levels are read by the
+     * same decompressor, and decoding is little more than copying bytes.
+     */
+    class Compressor
+    {
+    public:
+
+        constexpr static uint MIN_MATCH = 4;
+        constexpr static uint MAX_OFFSET = 65535;
+
+        /**
+         * Compress a block of data.
+         *
+         * @param   data   bytes to compress
+         * @param   level  COMPRESSION_FAST or COMPRESSION_SMALL
+         * @return  compressed bytes
+         */
+        static std::vector<byte> compress(const std::vector<byte>& data,
+                                          Compression level);
+
+        /**
+         * Return the compression selected by a --compress argument, which is
+         * either "fast" or "small".
+         *
+         * @param   name  name of the compression
+         * @param   level set to the compression
+         * @return  false if the name is unknown
+         */
+        static bool parse(const std::string& name, Compression& level);
+
+    private:
+
+        /* Find the longest match for @a __i, return its length or 0 */
+        static size_t findMatch(const std::vector<byte>& data, size_t __i,
+                                const std::vector<int64_t>& chain,
+                                int64_t candidate, uint depth,
+                                size_t& offset);
+
+        /* Write a sequence; a match length of 0 ends the data */
+        static void pushSequence(std::vector<byte>& out, const byte *literals,
+                                 size_t amount, size_t offset, size_t match);
+
+        /* Write the extra length bytes of a nibble which reached 15 */
+        static void pushLength(std::vector<byte>& out, size_t length);
+
+    };
+
+    /**
+     * The decompressor decodes the data of the Compressor straight into a
+     * buffer allocated by the caller, which is usually the memory the
+     * section is used from. The compressed data may be fed in blocks of any
+     * size, like they are read from a file or a pipe, and matches may point
+     * back into data decoded by earlier blocks.
+     */
+    class Decompressor
+    {
+    public:
+
+        /**
+         * @param   __b  buffer to decode into
+         * @param   __n  size of the buffer, which is the exact size of the
+         *               decompressed data
+         */
+        Decompressor(byte *__b, size_t __n);
+
+        /**
+         * Decode the next @a __n bytes of compressed data.
+         *
+         * @param   __b  pointer to the compressed bytes
+         * @param   __n  amount of bytes
+         * @throw   invalid_compression
+         */
+        void feed(const byte *__b, size_t __n);
+
+        /**
+         * Check that the compressed data ended after a whole sequence and
+         * exactly filled the buffer.
+         *
+         * @throw   invalid_compression
+         */
+        void finish();
+
+        /* Amount of bytes decoded so far */
+        size_t written() const;
+
+    private:
+
+        enum State
+        {
+            STATE_TOKEN,
+            STATE_LITERAL_LENGTH,
+            STATE_LITERALS,
+            STATE_OFFSET_LOW,
+            STATE_OFFSET_HIGH,
+            STATE_MATCH_LENGTH
+        };
+
+        /* Copy the current match, then wait for the next token */
+        void copyMatch();
+
+        byte *output;
+        size_t capacity;
+        size_t position = 0;
+
+        State state = STATE_TOKEN;
+        size_t literals = 0;
+        size_t match = 0;
+        size_t offset = 0;
+
+    };
+
+} // salt
+
+#endif // COMPRESSOR_H_
@@ -0,0 +1,107 @@
+/**
+ * The debug table maps instructions back to the source code they were
+ * compiled from, in a section of its own so the code itself stays dense.
+ *
+ */
+#ifndef DEBUG_TABLE_H_
+#define DEBUG_TABLE_H_
+
+#include <string>
+#include <vector>
+
+#include "../utils.h"
+#include "instruction.h"
+#include "bytecode_reader.h"
+
+namespace salt
+{
+
+    /* The position of the instructions starting at the given index */
+    struct DebugRow
+    {
+        uint index;
+        SourcePosition position;
+    };
+
+    /**
+     * The SECTION_DEBUG section starts with a small header:
+     *
+     *   0  uint32  amount of files
+     *   4  uint32  amount of rows
+     *   8  uint32  offset of the rows
+     *  12  uint32  size of the rows in bytes
+     *
+     * It's followed by an entry for each file, an uint32 offset and uint32
+     * length of its path, then the rows and the paths. A row is only written
+     * where the position changes, and it applies to every instruction up to
+     * the next row. Each row is delta encoded against the previous one
+     * (which starts at index 0, file 0, line 0) as varints:
+     *
+     *  - the index delta shifted left by one, with the lowest bit set if the
+     *    file changes, followed by the new file index if it does
+     *  - the zigzag encoded line delta
+     *  - the column
+     *
+     * Instructions with an unknown position get no row of their own, so
+     * they take the position of the code before them.
+     */
+    class DebugTable
+    {
+    public:
+
+        constexpr static uint HEADER_SIZE = 16;
+        constexpr static uint FILE_SIZE = 8;
+
+        /**
+         * Make the section for the instructions of the code section.
+         *
+         * @param   code   instructions in the order they are written
+         * @param   files  paths of the source files
+         * @return  section bytes, or nothing if no position is known
+         */
+        static std::vector<byte> make(const InstructionList& code,
+                                      const std::vector<std::string>& files);
+
+        /**
+         * Find the position of a single instruction. Only the rows up to
+         * that instruction are decoded.
+         *
+         * @param   __b       pointer to the first byte of the section
+         * @param   __n       size of the section
+         * @param   index     index of the instruction
+         * @param   position  set to the found position
+         * @return  false if there is no row at or before the instruction
+         * @throw   invalid_data_width
+         */
+        static bool find(const byte *__b, size_t __n, uint index,
+                         SourcePosition& position);
+
+        /**
+         * Decode all rows of the section.
+         *
+         * @throw   invalid_data_width
+         */
+        static std::vector<DebugRow> readRows(const byte *__b, size_t __n);
+
+        /**
+         * Read the paths of the source files.
+         *
+         * @throw   invalid_data_width
+         */
+        static std::vector<std::string> readFiles(const byte *__b,
+                                                  size_t __n);
+
+    private:
+
+        /* Return a reader over the rows, and set the amount of rows */
+        static BytecodeReader openRows(const byte *__b, size_t __n,
+                                       uint& rows);
+
+        /* Decode the next row, which updates the previous one */
+        static void readRow(BytecodeReader& reader, DebugRow& row);
+
+    };
+
+} // salt
+
+#endif // DEBUG_TABLE_H_
@@ -0,0 +1,62 @@
+/**
+ * The disassembler module turns SCC bytecode back into a readable listing.
+ *
+ */
+#ifndef DISASSEMBLER_H_
+#define DISASSEMBLER_H_
+
+#include <string>
+
+#include "../utils.h"
+#include "synthesizer.h"
+#include "bytecode_reader.h"
+#include "section_table.h"
+
+namespace salt
+{
+
+    /**
+     * The disassembler class prints the header, the const strings (or the
+     * sections of a sectioned file) and every instruction of a compiled SCC file, decoding the operands of each SVM
+     * call using the InstructionSet. Malformed bytecode makes it throw the
+     * same ValidatorError the validator would.
+     */
+    class Disassembler
+    {
+    public:
+
+        /**
+         * @param   bytecode  the whole contents of the SCC file
+         */
+        explicit Disassembler(const std::string& bytecode);
+
+        /**
+         * Decode the whole bytecode and return the listing.
+         *
+         * @return  disassembled bytecode, one instruction per line
+         * @throw   ValidatorError
+         */
+        std::string render();
+
+    private:
+
+        /* List the sections and the entries of the known ones */
+        std::string formatSections(const SectionTable& table);
+
+        /* Decode and format a single operand */
+        std::string formatOperand(BytecodeReader& reader, OperandType type);
+
+        /* Format the labels (and keys) of a jump table */
+        std::string formatCases(const Operand& operand);
+
+        /* Format a string, escaping non-printable characters */
+        std::string formatString(const std::string& value);
+
+        const std::string& bytecode;
+        Encoding encoding;
+
+    };
+
+} // salt
+
+#endif // DISASSEMBLER_H_
@@ -0,0 +1,49 @@
+/**
+ * The encoder converts synthesized instructions into the SCC4 binary layout,
+ * which is what gets written to the output file.
+ *
+ */
+#ifndef ENCODER_H_
+#define ENCODER_H_
+
+#include <string>
+#include <vector>
+
+#include "../utils.h"
+#include "instruction.h"
+
+namespace salt
+{
+
+    /**
+     * The compiler passes work on instructions in the SCC3 layout: a 5
+     * character mnemonic, the payload and a newline, with the strings kept
+     * as they are. The encoder turns each of them into the SCC4 layout
+     * instead:
+     *
+     *  - a single opcode byte from the InstructionSet descriptor table, or
+     *    InstructionSet::LABEL followed by the label name
+     *  - the operands in the order and layout of the descriptor, in the
+     *    selected operand encoding
+     *  - strings prefixed with their length and stored as they are
+     *
+     * No newline is written after the instruction, because its size is
+     * known from the descriptor and the length prefixes.
+     */
+    class Encoder
+    {
+    public:
+
+        /**
+         * Encode a single instruction or label.
+         *
+         * @param   instruction  synthesized instruction
+         * @return  SCC4 bytes
+         */
+        static std::vector<byte> encode(const Instruction& instruction);
+
+    };
+
+} // salt
+
+#endif // ENCODER_H_
@@ -0,0 +1,146 @@
+/**
+ * The flow graph module finds where each instruction of a function body can
+ * continue, for the passes which have to follow jumps instead of reading the
+ * instructions in order.
+ */
+#ifndef FLOW_GRAPH_H_
+#define FLOW_GRAPH_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../utils.h"
+#include "instruction.h"
+
+namespace salt
+{
+
+    /**
+     * Control flow graph of a single function body (or the prelude), with
+     * one node for each instruction. An extra node at index size() is the
+     * exit, which is where returns, EXITE and KILLX, jumps out of the body
+     * (tail calls) and running off the end of the body all continue.
+     *
+     * The graph only refers to the instructions by their index, so it has to
+     * be built again once the body changes.
+     */
+    class FlowGraph
+    {
+    public:
+
+        /* Objects on the tape at each instruction of the body, and at the
+           exit. The set is empty for instructions which can't be reached */
+        typedef std::vector<std::set<uint>> Liveness;
+
+        /**
+         * @param   body  instructions of the function
+         */
+        explicit FlowGraph(const InstructionList& body);
+
+        /**
+         * Return the amount of instructions, which is also the index of the
+         * exit node.
+         */
+        size_t size() const;
+
+        /**
+         * Return the indexes the instruction can continue at, without
+         * duplicates. The exit has no successors.
+         *
+         * @param   __i  index of the instruction
+         * @return  indexes of the successors
+         */
+        const std::vector<size_t>& successors(size_t __i) const;
+
+        /**
+         * Return true if the instruction can leave the body, by returning,
+         * ending the program, jumping out of it or running off the end.
+         *
+         * @param   __i  index of the instruction
+         */
+        bool leaves(size_t __i) const;
+
+        /**
+         * Return true if the instruction can be reached from the start of
+         * the body.
+         *
+         * @param   __i  index of the instruction
+         */
+        bool reachable(size_t __i) const;
+
+        /**
+         * Return true if every path from @a from to @a to goes through
+         * @a through. An instruction dominates itself, and an instruction
+         * which can't be reached at all is dominated by anything.
+         *
+         * @param   through  index of the dominating instruction
+         * @param   to       index of the dominated instruction
+         * @param   from     where the paths start, the start of the body
+         *                   by default
+         */
+        bool dominates(size_t through, size_t to, size_t from = 0) const;
+
+        /**
+         * Return the index of the label with the given name, or size() if
+         * the label isn't in the body.
+         *
+         * @param   name  name of the label, without the '@'
+         */
+        size_t find(const std::string& name) const;
+
+        /**
+         * Find the objects which may be, and the ones which surely are, on
+         * the tape before each instruction, following every path through
+         * the body. Only objects created in the body are tracked, so objects
+         * coming from outside are in neither set until they're created.
+         *
+         * @param   body     instructions the graph was built from
+         * @param   may      objects on the tape on at least one path
+         * @param   must     objects on the tape on all paths
+         * @param   ignored  IDs which aren't tracked at all
+         */
+        void liveness(const InstructionList& body, Liveness& may,
+                      Liveness& must,
+                      const std::set<uint>& ignored = {}) const;
+
+        /**
+         * Return true if the operand of the instruction creates the object,
+         * like the first one of OBJMK, or the second one of RGPOP which
+         * moves it from a register to the tape.
+         *
+         * @param   instruction  mnemonic of the instruction
+         * @param   __i          index of the operand
+         */
+        static bool creates(const std::string& instruction, size_t __i);
+
+        /**
+         * Return true if the operand of the instruction removes the object
+         * from the tape, like OBJDL or RPUSH moving it into a register.
+         *
+         * @param   instruction  mnemonic of the instruction
+         * @param   __i          index of the operand
+         */
+        static bool deletes(const std::string& instruction, size_t __i);
+
+        /* Apply the instruction to the set of objects on the tape */
+        static void apply(const Instruction& instruction,
+                          std::set<uint>& alive,
+                          const std::set<uint>& ignored = {});
+
+    private:
+
+        /* Return the set of nodes reachable from the start without passing
+           through the blocked node */
+        std::vector<bool> walk(size_t from, size_t blocked) const;
+
+        std::vector<std::vector<size_t>> edges;
+        std::vector<bool> reached;
+        std::map<std::string, size_t> labels;
+
+    };
+
+} // salt
+
+#endif // FLOW_GRAPH_H_
@@ -0,0 +1,119 @@
+/**
+ * The function index lets a loader find a single function of a module by
+ * name, so it can decode just the functions which are called.
+ *
+ */
+#ifndef FUNCTION_INDEX_H_
+#define FUNCTION_INDEX_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "../utils.h"
+#include "module.h"
+
+namespace salt
+{
+
+    /**
+     * A single function of the index. The code range starts at the
+     * function label and ends right before the next function label, or at
+     * the end of the code section.
+     */
+    struct FunctionEntry
+    {
+        uint32_t hash = 0;
+        std::string name;
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        uint32_t index = 0;
+        byte arity = 0;
+        byte registers = 0;
+        byte flags = 0;
+        uint32_t object_slots = 0;
+    };
+
+    /**
+     * The SECTION_FUNCTIONS section has the same layout as the other table
+     * sections: an uint32 entry count and an uint32 reserved for flags, then
+     * the entries sorted by hash and then by name, and the names after them.
+     * Each entry is:
+     *
+     *   0  uint32  FNV-1a hash of the name
+     *   4  uint32  offset of the name in the section
+     *   8  uint32  length of the name
+     *  12  uint32  offset of the function label in the code section
+     *  16  uint32  length of the function code in bytes
+     *  20  uint32  index of the function label instruction
+     *  24  uint8   arity, the amount of arguments popped from registers
+     *  25  uint8   registers used, the highest register ID plus one
+     *  26  uint8   flags, FLAG_PUBLIC for functions callable with CALLX
+     *  27  uint8   padding
+     *  28  uint32  amount of object IDs in the range of the function
+     *
+     * A virtual machine resolving a CALLX can hash the name, binary search
+     * the entries and only then decode and check the code of the function.
+     * The SVM doesn't load lazily yet, it validates and decodes each module
+     * as a whole. The ImageReader takes the details of each function from
+     * the index.
+     */
+    class FunctionIndex
+    {
+    public:
+
+        constexpr static uint ENTRY_SIZE = 32;
+        constexpr static byte FLAG_PUBLIC = 0x01;
+
+        /**
+         * Return the 32 bit FNV-1a hash of a function name.
+         *
+         * @param   name  name of the function
+         * @return  hash of the name
+         */
+        static uint32_t hash(const std::string& name);
+
+        /**
+         * Fill the name, hash, arity, registers, flags and object slots of
+         * the entry for a function. Arguments are passed in registers, and
+         * the function starts by popping them with RGPOP.
+         *
+         * @param   function  function to describe
+         * @return  entry without the code range
+         */
+        static FunctionEntry describe(const Function& function);
+
+        /**
+         * Sort the entries and render the section.
+         *
+         * @param   entries  entry of each function
+         * @return  section bytes
+         */
+        static std::vector<byte> make(std::vector<FunctionEntry> entries);
+
+        /**
+         * Find a function in a rendered section, without reading any other
+         * entry than the ones on the way of the binary search.
+         *
+         * @param   __b    pointer to the first byte of the section
+         * @param   __n    size of the section
+         * @param   name   name of the function
+         * @param   entry  set to the found entry
+         * @return  true if the function was found
+         * @throw   invalid_data_width
+         */
+        static bool find(const byte *__b, size_t __n, const std::string& name,
+                         FunctionEntry& entry);
+
+        /**
+         * Read the entry at the given position of a rendered section.
+         *
+         * @throw   invalid_data_width
+         */
+        static FunctionEntry read(const byte *__b, size_t __n, uint i);
+
+    };
+
+} // salt
+
+#endif // FUNCTION_INDEX_H_
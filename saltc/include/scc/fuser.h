@@ -0,0 +1,83 @@
+/**
+ * The fuser replaces common pairs of instructions with a single
+ * superinstruction, removing a whole dispatch from the virtual machine.
+ *
+ */
+#ifndef FUSER_H_
+#define FUSER_H_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "instruction.h"
+
+namespace salt
+{
+
+    /**
+     * The fuser class is a peephole pass over an already synthesized list of
+     * instructions. Each pair of adjacent instructions which appears in the
+     * FUSIONS table is replaced with the matching superinstruction, whose
+     * payload is just both payloads one after another.
+     *
+     * Because labels are separate entries in the instruction list, a pair can
+     * never span a jump target, so fusing never changes where a jump lands.
+     */
+    class Fuser
+    {
+    public:
+
+        struct Fusion
+        {
+            const char *first;
+            const char *second;
+            const char *fused;
+        };
+
+        /**
+         * The candidate pairs, in order of priority. Compare-and-branch pairs
+         * come first, because they dominate every loop and `if` statement
+         * and fusing them also removes the jump flag round trip. Candidates
+         * can be re-evaluated using the pair histogram below.
+         */
+        static const std::vector<Fusion> FUSIONS;
+
+        typedef std::map<std::pair<std::string, std::string>, uint>
+                PairHistogram;
+
+        /**
+         * Count every pair of adjacent instructions in the list. Labels break
+         * a pair, because they cannot be fused over.
+         *
+         * @param   instructions  list of synthesized instructions
+         * @return  amount of occurrences of each mnemonic pair
+         */
+        static PairHistogram histogram(const InstructionList& instructions);
+
+        /**
+         * Merge the histogram of another instruction list into @a __h, so a
+         * whole corpus of modules can be counted together.
+         *
+         * @param   __h           histogram to add to
+         * @param   instructions  list of synthesized instructions
+         */
+        static void accumulate(PairHistogram& __h,
+                               const InstructionList& instructions);
+
+        /**
+         * Replace all fusable pairs in the instruction list with their
+         * superinstructions. Each entry of FUSIONS is applied in a separate
+         * sweep, so higher priority pairs win when two candidates overlap.
+         *
+         * @param   instructions  list of synthesized instructions
+         * @return  amount of fused pairs
+         */
+        static uint fuse(InstructionList& instructions);
+
+    };
+
+} // salt
+
+#endif // FUSER_H_
@@ -0,0 +1,56 @@
+/**
+ * The image reader turns a compiled SCC file back into a module, so it can
+ * go through the compiler passes again, like when linking.
+ *
+ */
+#ifndef IMAGE_READER_H_
+#define IMAGE_READER_H_
+
+#include <string>
+
+#include "../utils.h"
+#include "module.h"
+
+namespace salt
+{
+
+    /**
+     * The image reader decodes every instruction of a SCC file into the
+     * internal instruction layout, in the operand encoding currently
+     * selected in the Synthesizer. It reads files with and without
+     * sections, compressed or not, and the legacy SCC3 layout.
+     *
+     * Labels which don't start with '#' are function labels, and start a
+     * new function. Everything before the first of them is the prelude. The
+     * constant pool is turned back into OBJMK calls at the start of the
+     * prelude, and the function index and debug table, if there are any,
+     * fill in the function details and the instruction positions.
+     *
+     * Functions of files without a function index are all public, as it's
+     * not known which of them are imported by other modules.
+     */
+    class ImageReader
+    {
+    public:
+
+        /**
+         * Decode a whole SCC file.
+         *
+         * @param   bytecode  contents of the file
+         * @param   name      name of the module
+         * @return  decoded module
+         * @throw   ValidatorError
+         */
+        static Module read(const std::string& bytecode,
+                           const std::string& name);
+
+    private:
+
+        /* Turn the constant pool back into OBJMK calls */
+        static InstructionList readConstants(const byte *__b, size_t __n);
+
+    };
+
+} // salt
+
+#endif // IMAGE_READER_H_
@@ -0,0 +1,165 @@
+/**
+ * The image writer lays out a compiled module as a sectioned SCC file.
+ *
+ */
+#ifndef IMAGE_WRITER_H_
+#define IMAGE_WRITER_H_
+
+#include <string>
+#include <vector>
+
+#include "../utils.h"
+#include "module.h"
+#include "section_table.h"
+#include "function_index.h"
+#include "offset_index.h"
+#include "debug_table.h"
+
+namespace salt
+{
+
+    /**
+     * The image writer splits a module into the sections of the SectionTable:
+     *
+     *  - SECTION_CODE holds the SCC4 instructions of the prelude and every
+     *    function, labels included, so the instruction indices stay the same
+     *    as in a flat file
+     *
+     *  - SECTION_CONSTANTS holds the readonly objects created in the prelude
+     *    which are never written again. They are taken out of the code, and
+     *    the VM creates them when loading the module, before running it.
+     *
+     *  - SECTION_LABELS maps each label to its offset in the code section,
+     *    sorted by name so the VM can binary search it
+     *
+     *  - SECTION_IMPORTS lists the modules loaded with EXTLD
+     *
+     *  - SECTION_FUNCTIONS is the FunctionIndex, so the VM can find and
+     *    decode a single function when it's first called
+     *
+     *  - SECTION_OFFSETS is the OffsetIndex with the offset of every
+     *    instruction, so the VM, the Validator and the Disassembler can
+     *    jump to instruction N without decoding the ones before it
+     *
+     *  - SECTION_DEBUG is the DebugTable with the source positions of the
+     *    instructions, placed last as it's only read for error reports
+     *
+     * With a compression set, every section which gets smaller by it is
+     * stored compressed.
+     *
+     * Every table section starts with an uint32 entry count and an uint32
+     * reserved for flags, followed by the fixed size entries and then the
+     * data they point to. Offsets in the entries are relative to the start
+     * of the section.
+     */
+    class ImageWriter
+    {
+    public:
+
+        /**
+         * Constant pool entry:
+         *
+         *   0  uint32  object ID
+         *   4  uint8   object type, one of the Synthesizer TYPE_ values
+         *   5  uint8   padding [3]
+         *   8  uint64  value; floats are stored in the low 4 bytes, and
+         *              strings as the offset of an uint32 length followed
+         *              by the bytes, aligned to 4 bytes
+         */
+        constexpr static uint CONSTANT_SIZE = 16;
+
+        /**
+         * Label entry:
+         *
+         *   0  uint32  offset of the name
+         *   4  uint32  length of the name
+         *   8  uint32  offset of the label in the code section
+         *  12  uint32  index of the label instruction
+         */
+        constexpr static uint LABEL_SIZE = 16;
+
+        /**
+         * Import entry:
+         *
+         *   0  uint32  offset of the module name
+         *   4  uint32  length of the module name
+         */
+        constexpr static uint IMPORT_SIZE = 8;
+
+        /* Size of the count and flags in front of the entries */
+        constexpr static uint TABLE_HEADER_SIZE = 8;
+
+        explicit ImageWriter(const Module& module);
+
+        /* Select the compression of the sections, none by default */
+        void setCompression(Compression compression);
+
+        /**
+         * Build all sections and return the section table followed by the
+         * page aligned sections.
+         *
+         * @param   __base  amount of bytes before the table, which is the
+         *                  size of the header
+         * @return  bytes to place after the header
+         */
+        std::vector<byte> write(size_t __base);
+
+        /* Amount of instructions (and labels) in the code section */
+        uint getInstructionCount() const;
+
+        /* Size of the widest encoded instruction */
+        uint getMaxWidth() const;
+
+        /* Amount of sections in the table */
+        uint getSectionCount() const;
+
+        /* Return true if any section was compressed */
+        bool isCompressed() const;
+
+        /* Size of the written file once all sections are decompressed */
+        size_t getMemorySize() const;
+
+    private:
+
+        /* Return true if the prelude instruction can go to the pool */
+        bool isConstant(const InstructionList& instructions, size_t i) const;
+
+        std::vector<byte> makeCode(const InstructionList& instructions);
+        std::vector<byte> makeConstants(const InstructionList& constants);
+        std::vector<byte> makeLabels();
+        std::vector<byte> makeImports(const InstructionList& instructions);
+
+        /* Make the function index of a code section of @a __n instructions,
+           using the offsets recorded by makeCode() */
+        std::vector<byte> makeFunctions(size_t __n);
+
+        /* Write the count and flags of a table with @a __n entries */
+        static std::vector<byte> makeTableHeader(uint __n);
+
+        struct Label
+        {
+            std::string name;
+            uint offset;
+            uint index;
+        };
+
+        const Module& module;
+        SectionTable table;
+
+        std::vector<Label> labels;
+
+        /* Offset of each instruction in the code section, followed by the
+           size of the section */
+        std::vector<size_t> offsets;
+        uint instructions = 0;
+        uint max_width = 0;
+
+        Compression compression = COMPRESSION_NONE;
+        bool compressed = false;
+        size_t memory_size = 0;
+
+    };
+
+} // salt
+
+#endif // IMAGE_WRITER_H_
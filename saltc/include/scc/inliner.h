@@ -0,0 +1,100 @@
+/**
+ * The inliner replaces calls to small local functions with a copy of their
+ * body, removing the CALLF and RETRN overhead from hot helpers.
+ *
+ */
+#ifndef INLINER_H_
+#define INLINER_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../utils.h"
+#include "module.h"
+
+namespace salt
+{
+
+    /**
+     * The inliner works on a single module. A CALLF is replaced with the body
+     * of the called function if the function is not recursive (it can't
+     * reach itself through any chain of calls) and it's either small enough,
+     * or it's a private function called from exactly one place, in which case
+     * inlining costs nothing and the tree shaker removes the original.
+     *
+     * Each inlined copy gets its own object IDs for the objects created in
+     * the function and its own '#' labels, so it can't clash with the caller
+     * or with other copies. Objects the function may leave on the tape for
+     * the caller keep their IDs. RETRN calls are turned into jumps to the
+     * end of the copy, and the last one is simply dropped.
+     */
+    class Inliner
+    {
+    public:
+
+        /* Default maximum size of an inlined function, in instructions */
+        static const uint MAX_SIZE = 8;
+
+        /* Each inlined call site, as "caller <- callee" */
+        struct Report
+        {
+            std::vector<std::string> inlined;
+            long bytes = 0;
+        };
+
+        /**
+         * @param   module  module to inline the local calls in
+         */
+        explicit Inliner(Module& module);
+
+        /**
+         * Select the maximum amount of instructions (excluding the final
+         * RETRN) a function can have to be inlined at every call site.
+         *
+         * @param   size  maximum function size, 0 to only inline functions
+         *                with a single call site
+         */
+        void setMaxSize(uint size);
+
+        /**
+         * Inline all matching calls in the module. Callees are expanded
+         * before their callers, so a chain of small helpers collapses into
+         * the outermost one.
+         *
+         * @return  report of the inlined calls
+         */
+        Report run();
+
+    private:
+
+        /* Return true if the call to the function can be replaced */
+        bool isInlinable(const Function& callee);
+
+        /* Return true if the function can reach itself through calls */
+        bool isRecursive(const std::string& name);
+
+        /* Create a copy of the callee body for a single call site */
+        InstructionList expand(const Function& callee);
+
+        /* Names of every local function the instructions refer to */
+        std::set<std::string> references(const InstructionList& body);
+
+        Module& module;
+        uint max_size = MAX_SIZE;
+
+        /* Amount of CALLF calls of each function in the module */
+        std::map<std::string, uint> call_sites;
+
+        /* First object ID not used anywhere in the module */
+        uint next_id = 0;
+
+        /* Amount of copies made so far, used to make unique labels */
+        uint copies = 0;
+
+    };
+
+} // salt
+
+#endif // INLINER_H_
@@ -0,0 +1,102 @@
+/**
+ * The instruction module wraps single synthesized SCC instructions, so the
+ * compiler passes can work on a list of instructions instead of a flat
+ * stream of bytes.
+ */
+#ifndef INSTRUCTION_H_
+#define INSTRUCTION_H_
+
+#include <string>
+#include <vector>
+
+#include "../utils.h"
+#include "instruction_set.h"
+
+namespace salt
+{
+
+    /**
+     * Position of the source code an instruction was compiled from. Lines
+     * and columns start at 1, and a line of 0 means the position is unknown,
+     * like for instructions made up by the compiler passes.
+     */
+    struct SourcePosition
+    {
+        uint file = 0;      // index in Module.files
+        uint line = 0;
+        uint column = 0;
+
+        SourcePosition() = default;
+
+        /* Convert the 0 based position of a token */
+        SourcePosition(const InStringPosition& position, uint file = 0);
+
+        bool isKnown() const;
+
+        bool operator==(const SourcePosition& other) const = default;
+    };
+
+    /**
+     * A single instruction or label, as returned from one of the Synthesizer
+     * methods. The code always contains the 5 byte mnemonic (or the label
+     * starting with '@'), the payload and the terminating newline.
+     */
+    struct Instruction
+    {
+        std::vector<byte> code;
+
+        /* Where the instruction comes from, only used for debug info */
+        SourcePosition position;
+
+        Instruction(std::vector<byte> code);
+        Instruction(std::vector<byte> code, SourcePosition position);
+
+        /**
+         * Return the mnemonic of the instruction. For labels, this returns
+         * the name of the label without the leading '@'.
+         *
+         * @return  name of the instruction
+         */
+        std::string name() const;
+
+        /**
+         * Return true if this is a label and not an actual SVM call.
+         */
+        bool isLabel() const;
+
+        /**
+         * Return the payload of the instruction, which are all the bytes
+         * between the mnemonic and the terminating newline.
+         *
+         * @return  payload bytes
+         */
+        std::vector<byte> payload() const;
+
+        /**
+         * Decode the payload using the InstructionSet layout, in the
+         * encoding currently selected in the Synthesizer. Labels and unknown
+         * instructions have no operands.
+         *
+         * @return  decoded operands
+         */
+        std::vector<Operand> operands() const;
+
+        /**
+         * Return true if the instruction creates, changes or removes the
+         * object with the given ID, like OBJMK, arithmetic on it or moving
+         * it into a register.
+         */
+        bool writes(uint id) const;
+
+        /**
+         * Return true if any operand of the instruction is the object with
+         * the given ID.
+         */
+        bool uses(uint id) const;
+    };
+
+    typedef std::vector<Instruction> InstructionList;
+
+} // salt
+
+#endif // INSTRUCTION_H_
@@ -0,0 +1,92 @@
+/**
+ * The instruction set module describes the operand layout of every SVM call,
+ * so bytecode can be decoded without knowing how it was synthesized.
+ *
+ */
+#ifndef INSTRUCTION_SET_H_
+#define INSTRUCTION_SET_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "../utils.h"
+
+namespace salt
+{
+
+    enum OperandType
+    {
+        OPERAND_ID,         // object ID (uint)
+        OPERAND_IMMEDIATE,  // 32 bit signed value
+        OPERAND_STRING,     // length prefixed string
+        OPERAND_REGISTER,   // single byte register ID
+        OPERAND_OBJECT,     // readonly byte, type byte & typed payload
+        OPERAND_LABELS,     // immediate count & that many strings
+        OPERAND_CASES       // immediate count & that many immediate-string pairs
+    };
+
+    /**
+     * A single decoded operand. Only the fields matching the type are used:
+     * the number holds IDs, immediates, registers and int or bool payloads,
+     * the text holds strings and string payloads.
+     */
+    struct Operand
+    {
+        OperandType type;
+        int64_t number = 0;
+        float real = 0;
+        std::string text;
+
+        /* OBJMK payload only */
+        bool readonly = false;
+        byte object_type = 0;
+
+        /* Jump tables only, the keys are empty for a list of labels */
+        std::vector<int64_t> keys;
+        std::vector<std::string> labels;
+    };
+
+    /**
+     * Description of a single SVM call. The operands are listed in the order
+     * they appear in the payload. The opcode is the single byte identifying
+     * the call in the SCC4 binary format, and never changes once assigned.
+     */
+    struct InstructionInfo
+    {
+        byte opcode;
+        const char *name;
+        std::vector<OperandType> operands;
+    };
+
+    class InstructionSet
+    {
+    public:
+
+        /* Opcode of a label in the SCC4 format, followed by its name. */
+        constexpr static byte LABEL = 0x00;
+
+        /* All known SVM calls, sorted by name. */
+        static const std::vector<InstructionInfo> INSTRUCTIONS;
+
+        /**
+         * Find the description of the instruction with the given mnemonic.
+         *
+         * @param   name  5 character mnemonic
+         * @return  pointer to the description, or nullptr if unknown
+         */
+        static const InstructionInfo *find(const std::string& name);
+
+        /**
+         * Find the description of the instruction with the given opcode.
+         *
+         * @param   opcode  SCC4 opcode
+         * @return  pointer to the description, or nullptr if unknown
+         */
+        static const InstructionInfo *find(byte opcode);
+
+    };
+
+} // salt
+
+#endif // INSTRUCTION_SET_H_
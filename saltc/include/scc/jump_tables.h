@@ -0,0 +1,109 @@
+/**
+ * The jump tables module replaces long chains of compares against int
+ * constants with a single JMPTB or JMPBS dispatch.
+ *
+ */
+#ifndef JUMP_TABLES_H_
+#define JUMP_TABLES_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../utils.h"
+#include "module.h"
+
+namespace salt
+{
+
+    /**
+     * An `if`/`elif` chain comparing one object against many int constants
+     * is compiled to a CXXEQ and a jump for each case, so the last case pays
+     * for every compare before it. Two shapes of such chains are found:
+     *
+     *  - a dispatch block, where each CXXEQ is followed by a JMPFL to the
+     *    case body, and the code after the block is the default
+     *
+     *  - an if/elif chain, where each CXXEQ is followed by a JMPNF to the
+     *    next compare, which is only reachable through that jump
+     *
+     * Chains of at least MIN_CASES cases are replaced with a JMPTB when the
+     * keys are dense enough to be used as an index, or with a JMPBS which
+     * does a binary search over the sorted keys otherwise. This makes the
+     * dispatch O(1) or O(log n) instead of O(n).
+     *
+     * The tables fail on anything but an int, while CXXEQ compares any two
+     * objects, so a chain is only replaced when every copy of the compared
+     * object the module makes is an int.
+     *
+     * The flag is left as the chain would leave it. A value which isn't one
+     * of the keys clears it, so the holes of a JMPTB don't jump to the
+     * fallback label themselves, but to a compare of the object with itself
+     * placed right after the table, which then continues there.
+     */
+    class JumpTables
+    {
+    public:
+
+        /* Minimum amount of cases worth a jump table */
+        static const uint MIN_CASES = 4;
+
+        /* A table may have up to this many slots per case, more holes
+           than that make a binary search the better choice */
+        static const uint MAX_SLOTS_PER_CASE = 2;
+
+        /**
+         * Replace the compare chains in every function of the module. Case
+         * keys can be readonly int objects of the module prelude or of the
+         * function itself.
+         *
+         * @param   module  module to change
+         * @return  amount of created jump tables
+         */
+        static uint build(Module& module);
+
+    private:
+
+        struct Case
+        {
+            int64_t key;
+            std::string label;
+        };
+
+        /* Replace the compare chains of a single function, which compare
+           one of the objects which are always ints */
+        static uint build(Function& function,
+                          const std::map<uint, int64_t>& globals,
+                          const std::set<uint>& ints, uint& tables);
+
+        /**
+         * Decode a CXXEQ as a compare of an object against a known constant.
+         * Returns false if neither or both operands are constants.
+         */
+        static bool matchCompare(const Instruction& instruction,
+                                 const std::map<uint, int64_t>& constants,
+                                 uint& id, int64_t& key);
+
+        /**
+         * Synthesize the dispatch instruction for the cases, at the source
+         * position of the compare it replaces. A JMPTB with holes is
+         * followed by the code clearing the flag for them.
+         *
+         * @param   id        ID of the compared object
+         * @param   fallback  label for values which aren't keys
+         * @param   hole      label to use for the holes of a JMPTB
+         * @param   cases     keys and their labels
+         * @param   position  source position of the replaced compare
+         * @return  the dispatch, and the code for the holes
+         */
+        static InstructionList makeTable(uint id, const std::string& fallback,
+                                         const std::string& hole,
+                                         const std::vector<Case>& cases,
+                                         const SourcePosition& position);
+
+    };
+
+} // salt
+
+#endif // JUMP_TABLES_H_
@@ -0,0 +1,100 @@
+/**
+ * The linker joins compiled modules into a single self contained module, so
+ * the program can be shipped as one SCC file without any EXTLD lookups.
+ *
+ */
+#ifndef LINKER_H_
+#define LINKER_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../utils.h"
+#include "module.h"
+
+namespace salt
+{
+
+    /**
+     * The linker works on whole modules, usually read back from SCC files by
+     * the ImageReader. The first module is the main module, and keeps its
+     * names. Everything of the other modules is renamed with the module name
+     * as a prefix, so "f" in module "lib" becomes "lib.f" and its "#x" labels
+     * become "#lib.x", and their functions become private.
+     *
+     * Before joining, the TreeShaker removes every function the main
+     * function can't reach, now that the whole program is known. Then:
+     *  - object IDs of each module are moved after the ones of the modules
+     *    before it, so all of them fit on a single tape
+     *  - CALLX calls into linked modules become CALLF calls
+     *  - the EXTLD of a linked module is replaced with its prelude, so it
+     *    still runs at the same moment it would have been loaded
+     *  - equal module level constants are only created once
+     *
+     * Calls into modules which weren't passed to the linker, like the
+     * builtins, are left as they are.
+     */
+    class Linker
+    {
+    public:
+
+        /* What was linked and how many constants were merged */
+        struct Report
+        {
+            std::vector<std::string> calls;
+            uint constants = 0;
+        };
+
+        /**
+         * @param   modules  all modules of the program, the first one being
+         *                   the main module
+         */
+        explicit Linker(std::vector<Module> modules);
+
+        /**
+         * Join all the modules. The result is named after the main module.
+         *
+         * @return  linked module
+         */
+        Module link();
+
+        /* Return the report of the last link() */
+        const Report& getReport() const;
+
+    private:
+
+        /* Find the passed module by its name */
+        Module *findModule(const std::string& name);
+
+        /* Return the new name of a function or label of a module */
+        std::string rename(const Module& module, const std::string& name) const;
+
+        /* Rename, renumber and resolve the calls of a single instruction */
+        Instruction relocate(const Module& module, const Instruction& from);
+
+        /* Append the relocated prelude of a module, replacing its EXTLDs */
+        void includePrelude(const Module& module, InstructionList& to);
+
+        /* Create every equal readonly constant only once */
+        void mergeConstants(Module& linked);
+
+        std::vector<Module> modules;
+        Report report;
+
+        /* First object ID and file index of each module */
+        std::map<std::string, uint> id_base;
+        std::map<std::string, uint> file_base;
+
+        /* Modules whose prelude is already in the linked module */
+        std::set<std::string> included;
+
+        /* External modules already loaded by the linked module */
+        std::set<std::string> imports;
+
+    };
+
+} // salt
+
+#endif // LINKER_H_
@@ -0,0 +1,118 @@
+/**
+ * The loop optimizer moves work which is the same in every iteration of a
+ * loop out of it, and replaces multiplications of the loop counter with
+ * additions.
+ *
+ */
+#ifndef LOOP_OPTIMIZER_H_
+#define LOOP_OPTIMIZER_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../utils.h"
+#include "instruction_set.h"
+#include "module.h"
+
+namespace salt
+{
+
+    /**
+     * A loop is a '#' label with a jump back to it from further down in the
+     * same function, which is what `while` and `for` loops are compiled to.
+     * Loops are optimized from the innermost one, so anything hoisted out of
+     * an inner loop can be hoisted out of the outer one in the next round.
+     *
+     * Two things are done to each loop:
+     *
+     *  - invariant hoisting: an OBJMK followed by arithmetic on the new
+     *    object using only objects not changed in the loop is moved in front
+     *    of the loop, and its OBJDL behind it. This covers both constant
+     *    objects re-created each iteration and invariant computations.
+     *
+     *  - strength reduction: an object computed as `i * k` (OBJMK 0, IXADD
+     *    with `i`, IXMUL with `k`), where `i` only changes by a constant
+     *    IVADD step and `k` is a constant int, is computed once before the
+     *    loop and then just incremented by `step * k` right after `i`.
+     *
+     * Moved code runs once before the loop even if the loop body never
+     * runs, so it has to be code which can't fail: the arithmetic works on
+     * a writable int and objects which are surely numbers when the loop
+     * starts, and IXDIV, which fails on zero, is never moved. It must also
+     * run in every iteration, so code on a branch which can skip the back
+     * jump stays where it is.
+     *
+     * Changes are only made if the loop has no entries except its top and no
+     * exits except the labels right after its back jump, so the moved OBJDL
+     * runs on every way out of the loop.
+     */
+    class LoopOptimizer
+    {
+    public:
+
+        /* What was done to the loops of the passed code */
+        struct Report
+        {
+            uint loops = 0;
+            uint hoisted = 0;
+            uint reduced = 0;
+        };
+
+        /**
+         * Optimize every loop in all the functions of a module. Constants
+         * created in the module prelude can be used for strength reduction.
+         *
+         * @param   module  module to optimize
+         * @return  report of the changes
+         */
+        static Report optimize(Module& module);
+
+    private:
+
+        struct Loop
+        {
+            size_t head;    // index of the label
+            size_t back;    // index of the jump back to the label
+            size_t end;     // index of the first instruction after the exits
+        };
+
+        /* Every loop in the function, innermost first */
+        static std::vector<Loop> findLoops(const InstructionList& body);
+
+        /* Return true if the loop can only be left through its exits */
+        static bool isClosed(const InstructionList& body, const Loop& loop);
+
+        /* Try to hoist a single invariant object out of the loop */
+        static bool hoist(InstructionList& body, const Loop& loop,
+                          const std::map<uint, Operand>& globals);
+
+        /* Try to strength reduce a single multiplication in the loop */
+        static bool reduce(InstructionList& body, const Loop& loop,
+                           const std::map<uint, Operand>& globals);
+
+        /* Return true if the object is surely a number, or an int, on
+           every path into the loop */
+        static bool isNumber(const InstructionList& body, const Loop& loop,
+                             uint id, const std::map<uint, Operand>& globals,
+                             bool int_only);
+
+        /* Return true if every iteration of the loop runs the instruction */
+        static bool dominatesBack(const InstructionList& body,
+                                  const Loop& loop, size_t __i);
+
+        /* Return the '#' label the instruction jumps to, or "" */
+        static std::string jumpTarget(const Instruction& instruction);
+
+        /* Move the instructions at the given indices in front of the loop
+           and place the OBJDL of the object after it */
+        static void moveOut(InstructionList& body, const Loop& loop,
+                            const std::vector<size_t>& indices,
+                            long removed_delete, uint id);
+
+    };
+
+} // salt
+
+#endif // LOOP_OPTIMIZER_H_
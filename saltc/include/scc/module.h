@@ -0,0 +1,71 @@
+/**
+ * The module structure holds the synthesized code of a single Salt module,
+ * split into functions, so the compiler passes can work on each of them.
+ *
+ */
+#ifndef MODULE_H_
+#define MODULE_H_
+
+#include <string>
+#include <vector>
+
+#include "../utils.h"
+#include "instruction.h"
+
+namespace salt
+{
+
+    /**
+     * A single function of a module. The body doesn't contain the function
+     * label, which is added when the module is rendered.
+     */
+    struct Function
+    {
+        std::string name;
+        bool is_public = false;
+        InstructionList body;
+
+        /* Amount of object IDs in the range of the function, which starts
+           after the shared ones and the ranges of the functions before it.
+           Set by the allocator. */
+        uint object_slots = 0;
+    };
+
+    /**
+     * A single compiled module. The prelude holds everything that is placed
+     * before the first function label, like EXTLD calls and module level
+     * objects, which are available to every function.
+     */
+    struct Module
+    {
+        std::string name;
+        InstructionList prelude;
+        std::vector<Function> functions;
+
+        /* Source files the instruction positions refer to, the first one
+           is the file of the module itself */
+        std::vector<std::string> files;
+
+        /* Amount of object IDs used by the whole module */
+        uint object_slots = 0;
+
+        /**
+         * Find the function with the given name.
+         *
+         * @param   name  name of the function
+         * @return  pointer to the function, or nullptr if it doesn't exist
+         */
+        Function *findFunction(const std::string& name);
+
+        /**
+         * Return the whole module as a flat list of instructions: the prelude
+         * and then each function label followed by its body.
+         *
+         * @return  list of instructions
+         */
+        InstructionList render() const;
+    };
+
+} // salt
+
+#endif // MODULE_H_
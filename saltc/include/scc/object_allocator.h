@@ -0,0 +1,82 @@
+/**
+ * The object allocator hands out dense object IDs, reusing the IDs of
+ * objects which are never alive at the same time.
+ */
+#ifndef OBJECT_ALLOCATOR_H_
+#define OBJECT_ALLOCATOR_H_
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "../utils.h"
+#include "flow_graph.h"
+#include "instruction.h"
+#include "module.h"
+
+namespace salt
+{
+
+    /**
+     * The object allocator keeps object IDs dense, so the virtual machine can
+     * back the object tape with a flat array indexed by the ID instead of
+     * searching it.
+     *
+     * Objects used by the prelude or by more than one function are shared,
+     * and get the lowest IDs, one each. Each function then gets its own range
+     * of IDs after them, which doesn't overlap the ranges of the other
+     * functions, so a call never shadows the objects of the caller.
+     *
+     * Inside a function, two objects only get the same ID when no path
+     * through the function has both of them on the tape at once. This is
+     * found by following every jump, so an early return or a branch which
+     * deletes an object doesn't free its ID for the other paths. An object
+     * which is created again while it may still be alive, read where it may
+     * not exist or left on the tape when the function returns keeps an ID of
+     * its own, so its behaviour doesn't change.
+     */
+    class ObjectAllocator
+    {
+    public:
+
+        /**
+         * Renumber the prelude and every function of the module, storing the
+         * amount of IDs of the whole module, and the size of its own range
+         * in each function.
+         *
+         * @param   module  module to renumber
+         */
+        static void compact(Module& module);
+
+    private:
+
+        /**
+         * @param   shared   new IDs of the shared objects, the functions
+         *                   get the IDs after them
+         * @param   ignored  IDs of the shared objects, which aren't tracked
+         *                   in the functions
+         */
+        ObjectAllocator(const std::map<uint, uint>& shared,
+                        const std::set<uint>& ignored);
+
+        /**
+         * Map every object of the function to an ID in its own range, and
+         * renumber the body.
+         *
+         * @param   function  function to renumber
+         */
+        void allocate(Function& function);
+
+        /* Replace every ID in the instructions using the map */
+        static void renumber(InstructionList& instructions,
+                             const std::map<uint, uint>& ids);
+
+        const std::map<uint, uint>& shared;
+        const std::set<uint>& ignored;
+        uint base;
+
+    };
+
+} // salt
+
+#endif // OBJECT_ALLOCATOR_H_
@@ -0,0 +1,59 @@
+/**
+ * The offset index lets the virtual machine and the tools jump straight to
+ * any instruction of the code section, without decoding the ones before it.
+ *
+ */
+#ifndef OFFSET_INDEX_H_
+#define OFFSET_INDEX_H_
+
+#include <vector>
+#include <stdint.h>
+
+#include "../utils.h"
+
+namespace salt
+{
+
+    /**
+     * The SECTION_OFFSETS section has the same layout as the other table
+     * sections: an uint32 entry count and an uint32 reserved for flags,
+     * followed by an uint32 for every instruction (labels included), the
+     * offset of the instruction in the code section.
+     *
+     * The count is always the amount of instructions in the header, and the
+     * offsets are increasing, so instruction N starts at entry N and ends
+     * where entry N + 1 starts, or at the end of the code section.
+     */
+    class OffsetIndex
+    {
+    public:
+
+        constexpr static uint ENTRY_SIZE = 4;
+
+        /**
+         * Render the section.
+         *
+         * @param   offsets  offset of each instruction, the size of the code
+         *                   section can follow them and is not written
+         * @param   __n      amount of instructions
+         * @return  section bytes
+         */
+        static std::vector<byte> make(const std::vector<size_t>& offsets,
+                                      uint __n);
+
+        /**
+         * Return the offset of an instruction in the code section.
+         *
+         * @param   __b  pointer to the first byte of the section
+         * @param   __n  size of the section
+         * @param   i    index of the instruction
+         * @return  offset of the instruction in the code section
+         * @throw   invalid_data_width
+         */
+        static uint32_t find(const byte *__b, size_t __n, uint i);
+
+    };
+
+} // salt
+
+#endif // OFFSET_INDEX_H_
@@ -0,0 +1,178 @@
+/**
+ * The section table splits a SCC file into page aligned sections, so the
+ * virtual machine can map the file and use each part of it in place.
+ *
+ */
+#ifndef SECTION_TABLE_H_
+#define SECTION_TABLE_H_
+
+#include <span>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "../utils.h"
+#include "compressor.h"
+
+namespace salt
+{
+
+    enum SectionType
+    {
+        SECTION_CODE        = 0x01,  // SCC4 instructions
+        SECTION_CONSTANTS   = 0x02,  // module level readonly objects
+        SECTION_LABELS      = 0x03,  // label name -> code offset
+        SECTION_IMPORTS     = 0x04,  // names of the EXTLD modules
+        SECTION_DEBUG       = 0x05,  // source positions of instructions
+        SECTION_FUNCTIONS   = 0x06,  // function index, see FunctionIndex
+        SECTION_OFFSETS     = 0x07   // instruction index -> code offset
+    };
+
+    /**
+     * A single entry of the section table. The offset is counted from the
+     * start of the file, and both sizes are the same unless the section is
+     * stored in some other form than it's used in, in which case the memory
+     * size is the amount of bytes to allocate for it.
+     */
+    struct Section
+    {
+        uint type;
+        uint flags = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint64_t memory_size = 0;
+
+        std::vector<byte> data;
+    };
+
+    /**
+     * The section table is placed right after the 64 byte header, with one
+     * 32 byte entry for each section:
+     *
+     *   0  uint32  type, one of SectionType
+     *   4  uint32  flags
+     *   8  uint64  offset in the file
+     *  16  uint64  size in the file
+     *  24  uint64  size in memory
+     *
+     * Every section starts at a PAGE_SIZE aligned offset, so it can be mapped
+     * on its own. All numbers in the table and in the sections are little
+     * endian and naturally aligned, regardless of the operand encoding.
+     *
+     * Sections with FLAG_COMPRESSED are stored compressed by the Compressor,
+     * and their size in memory is the size of the decompressed data. Those
+     * can't be used in place, so they are only aligned to 8 bytes, and the
+     * loader expands the file first, placing each section at the offset it
+     * would have if nothing was compressed.
+     */
+    class SectionTable
+    {
+    public:
+
+        constexpr static uint PAGE_SIZE = 4096;
+        constexpr static uint ENTRY_SIZE = 32;
+
+        /* Bits of the section flags */
+        constexpr static uint FLAG_COMPRESSED = 0x01;
+
+        /* Size of the blocks compressed sections are decoded in */
+        constexpr static uint STREAM_BLOCK = 4096;
+
+        /**
+         * Add a section, which is placed after the previously added ones.
+         *
+         * @param   type  one of SectionType
+         * @param   data  contents of the section
+         */
+        void add(uint type, const std::vector<byte>& data);
+
+        /**
+         * Find the section with the given type.
+         *
+         * @param   type  one of SectionType
+         * @return  pointer to the section, or nullptr if there is none
+         */
+        const Section *find(uint type) const;
+
+        const std::vector<Section>& getSections() const;
+
+        /**
+         * Lay out all sections and return the table followed by the padded
+         * sections. The offsets are counted as if the result was placed
+         * after @a __base bytes, which is the header.
+         *
+         * @param   __base  amount of bytes before the table
+         * @return  table and section bytes
+         */
+        std::vector<byte> render(size_t __base);
+
+        /**
+         * Compress every section which gets smaller by it.
+         *
+         * @param   level  compression level to use
+         * @return  true if any section was compressed
+         */
+        bool compress(Compression level);
+
+        /**
+         * Return the size of the file once every section is decompressed,
+         * which is the single allocation a loader has to make for it.
+         *
+         * @param   __base  amount of bytes before the table
+         * @return  size of the expanded file
+         */
+        size_t getMemorySize(size_t __base) const;
+
+        /**
+         * Read and check the table entries of a sectioned file. The data of
+         * the sections is not copied.
+         *
+         * @param   bytecode  the whole file
+         * @param   count     amount of sections, from the header
+         * @return  the read table
+         * @throw   invalid_section
+         */
+        static SectionTable read(std::span<const byte> bytecode, uint count);
+
+        /**
+         * Read the table when only the header and the table itself are
+         * available, like when the file is streamed. The sections are
+         * checked to fit into a file of @a __n bytes instead.
+         *
+         * @param   table  the header followed by the table
+         * @param   count  amount of sections, from the header
+         * @param   __n    size of the file, if it's known
+         * @return  the read table
+         * @throw   invalid_section
+         */
+        static SectionTable read(std::span<const byte> table, uint count,
+                                 uint64_t __n);
+
+        /**
+         * Decompress all compressed sections of a file. The result is
+         * allocated once and each section is decoded straight into its place,
+         * reading the compressed data in STREAM_BLOCK sized blocks. The table
+         * and header of the result describe an uncompressed file.
+         *
+         * @param   bytecode  the whole file
+         * @param   count     amount of sections, from the header
+         * @return  the expanded file
+         * @throw   invalid_section, invalid_compression
+         */
+        static std::string expand(std::span<const byte> bytecode, uint count);
+
+        /* Return the alignment of the offset of the section */
+        static size_t getAlignment(const Section& section);
+
+        /* Round @a __n up to a multiple of @a __a */
+        static size_t align(size_t __n, size_t __a);
+
+    private:
+
+        std::vector<Section> sections;
+
+    };
+
+} // salt
+
+#endif // SECTION_TABLE_H_
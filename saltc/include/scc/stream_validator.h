@@ -0,0 +1,134 @@
+/**
+ * The stream validator checks SCC files which are read in blocks, like from
+ * a pipe, without ever holding the whole file in memory.
+ *
+ */
+#ifndef STREAM_VALIDATOR_H_
+#define STREAM_VALIDATOR_H_
+
+#include <istream>
+#include <vector>
+#include <stdint.h>
+
+#include "../utils.h"
+#include "synthesizer.h"
+
+namespace salt
+{
+
+    /**
+     * The stream validator does the same checks as the Validator on the
+     * header, the section table, the const strings and the instructions,
+     * but each block of the file is checked as soon as it's fed, and then
+     * forgotten. Only an instruction (or const string) split between two
+     * blocks is kept until it's complete, so the memory used doesn't depend
+     * on the size of the module, only on the widest instruction.
+     *
+     * Because nothing before the current position is kept, the contents of
+     * the table sections can't be checked, only that they fit in the file.
+     * Compressed files are rejected with invalid_compression, as matches may
+     * point anywhere back into a section, so they have to be expanded into
+     * memory and checked by the Validator.
+     */
+    class StreamValidator
+    {
+    public:
+
+        /* Size of the blocks read by validate() */
+        constexpr static size_t BLOCK_SIZE = 4096;
+
+        /**
+         * Check the next @a __n bytes of the file.
+         *
+         * @param   __b  pointer to the bytes
+         * @param   __n  amount of bytes
+         * @throw   ValidatorError
+         */
+        void feed(const byte *__b, size_t __n);
+
+        /**
+         * Check that the file ended after the last instruction and that
+         * every section fits in it.
+         *
+         * @throw   ValidatorError
+         */
+        void finish();
+
+        /**
+         * Read the whole stream in BLOCK_SIZE blocks and check it. This can
+         * run while the file is still being written, like from a named pipe.
+         *
+         * @param   stream  stream to read the file from
+         * @throw   ValidatorError
+         */
+        void validate(std::istream& stream);
+
+        /* Amount of instructions checked so far */
+        uint getInstructionCount() const;
+
+    private:
+
+        enum State
+        {
+            STATE_HEADER,
+            STATE_TABLE,
+            STATE_PADDING,          // between the table and the code
+            STATE_CONST_STRINGS,
+            STATE_INSTRUCTIONS,
+            STATE_TRAILER           // everything after the last instruction
+        };
+
+        /* Check the header once all 64 bytes are there */
+        void loadHeader();
+
+        /* Check the section table once it's complete */
+        void loadTable();
+
+        /* Check const strings or instructions, return the bytes used */
+        size_t feedItems(const byte *__b, size_t __n);
+
+        /**
+         * Check a single const string or instruction at the start of the
+         * bytes, return its width or 0 if it doesn't end in them. If
+         * @a last is set, no more bytes will follow.
+         */
+        size_t checkItem(const byte *__b, size_t __n, bool last);
+
+        /* Count the checked item, which ends at @a __n in the file */
+        void nextItem(uint64_t __n);
+
+        /* Move to the next state if no items are left */
+        void advance(uint64_t __n);
+
+        State state = STATE_HEADER;
+
+        /* The header and table, or an item split between blocks */
+        std::vector<byte> pending;
+
+        /* Amount of bytes of the file fed so far */
+        uint64_t position = 0;
+
+        uint version = 0;
+        uint instruction_amount = 0;
+        uint max_instruction_width = 0;
+        uint section_amount = 0;
+        Encoding encoding = ENCODING_FIXED;
+        bool sectioned = false;
+
+        /* Size of the file from the header of a sectioned file, the
+           amount of const strings in a flat one */
+        uint64_t file_size = 0;
+
+        /* Items left in the current state, and instructions checked */
+        uint items = 0;
+        uint instructions = 0;
+
+        uint64_t code_start = 0;
+        uint64_t code_end = UINT64_MAX;
+        uint64_t sections_end = 0;
+
+    };
+
+} // salt
+
+#endif // STREAM_VALIDATOR_H_
@@ -10,8 +10,11 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <utility>
+#include <stdint.h>
 
 #include "../utils.h"
+#include "instruction_set.h"
 
 namespace salt
 {
@@ -26,6 +29,18 @@ namespace salt
         Array  = 0x05
     };
 
+    /**
+     * Operand encoding of the produced bytecode. The fixed encoding writes
+     * every number at its full width, while the compact one writes IDs,
+     * string lengths and integers as LEB128 varints (zigzag for signed
+     * values). The used encoding is stored in the SCC header flags.
+     */
+    enum Encoding
+    {
+        ENCODING_FIXED   = 0x00,
+        ENCODING_COMPACT = 0x01
+    };
+
     /**
      * The synthesizer class is responsible for generating SCC bytecode.  See
      * Synthesizer.FORMAT for the current used SCC format. This class should be
@@ -40,8 +55,13 @@ namespace salt
     {
     public:
 
-        /* Current version of the SCC format. */
-        static const int FORMAT = 3;
+        /**
+         * Current version of the SCC format. Note that the instructions are
+         * synthesized in the newline delimited SCC3 layout, which is easy to
+         * work with for the compiler passes, and are converted to the SCC4
+         * binary layout by the Encoder when writing the file.
+         */
+        static const int FORMAT = 4;
 
         /* if the object should be read-only */
         constexpr static byte CONSTANT_FALSE = 0x00;
@@ -75,6 +95,46 @@ namespace salt
          */
         static std::vector<byte> callLocal(std::string function);
 
+        /**
+         * Compare two objects for an equal value, can compare bools, ints,
+         * floats and strings. If true, sets the jump flag.
+         *
+         * @param   left   ID of the left object
+         * @param   right  ID of the right object
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> compareEqual(uint left, uint right);
+
+        /**
+         * Compare two objects, setting the jump flag if the left value is in
+         * some way lesser than the right one.
+         *
+         * @param   left   ID of the left object
+         * @param   right  ID of the right object
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> compareLess(uint left, uint right);
+
+        /**
+         * Fused compare-and-branch superinstructions. These behave exactly
+         * like a CXXEQ/CXXLT immediately followed by a JMPFL/JMPNF (the jump
+         * flag is still set), but take only a single dispatch in the virtual
+         * machine.
+         *
+         * @param   left   ID of the left object
+         * @param   right  ID of the right object
+         * @param   label  label to jump to
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> compareEqualJumpFlag(uint left, uint right,
+                                                      std::string label);
+        static std::vector<byte> compareEqualJumpNotFlag(uint left, uint right,
+                                                         std::string label);
+        static std::vector<byte> compareLessJumpFlag(uint left, uint right,
+                                                     std::string label);
+        static std::vector<byte> compareLessJumpNotFlag(uint left, uint right,
+                                                        std::string label);
+
         /**
          * Exit the current executed module.
          *
@@ -91,6 +151,86 @@ namespace salt
          */
         static std::vector<byte> externalLoad(std::string module);
 
+        /**
+         * Add the value to the given object of type int.
+         *
+         * @param   id     ID of the object
+         * @param   value  value to add
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> intAdd(uint id, int value);
+
+        /**
+         * Fused increment-then-compare superinstructions. Add the value to
+         * the object and then compare it with the other object, setting the
+         * jump flag like CXXLT or CXXEQ would. This is the usual step at the
+         * end of a counting loop. The payload keeps both original operand
+         * lists, so the Fuser can create it from any IVADD & compare pair.
+         *
+         * @param   id     ID of the incremented object
+         * @param   value  value to add
+         * @param   other  ID of the object to compare with
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> intAddCompareLess(uint id, int value,
+                                                   uint other);
+        static std::vector<byte> intAddCompareEqual(uint id, int value,
+                                                    uint other);
+
+        /**
+         * Jump to the label only if the jump flag is set.
+         *
+         * @param   label  name of the label, without the '@'
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> jumpFlag(std::string label);
+
+        /**
+         * Jump to the label only if the jump flag is NOT set.
+         *
+         * @param   label  name of the label, without the '@'
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> jumpNotFlag(std::string label);
+
+        /**
+         * Jump to the label without creating a new entry on the callstack.
+         *
+         * @param   label  name of the label, without the '@'
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> jumpTo(std::string label);
+
+        /**
+         * Jump to the label selected by the value of the int object, using
+         * it as an index into the list of labels. Values outside of the
+         * range [base, base + labels.size()) jump to the fallback label.
+         * The jump flag is set if one of the labels was selected.
+         *
+         * @param   id        ID of the int object
+         * @param   base      value selecting the first label
+         * @param   fallback  label to jump to if no case matches
+         * @param   labels    label for each value, starting at base
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> jumpTable(uint id, int base,
+                                           std::string fallback,
+                                           std::vector<std::string> labels);
+
+        /**
+         * Jump to the label of the case matching the value of the int
+         * object, which the virtual machine finds with a binary search.
+         * This is the jumpTable alternative for sparse values. The cases are
+         * sorted by their key before synthesizing.
+         *
+         * @param   id        ID of the int object
+         * @param   fallback  label to jump to if no case matches
+         * @param   cases     key & label of each case
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> jumpSearch(uint id, std::string fallback,
+                std::vector<std::pair<int, std::string>> cases);
+
         /**
          * Kill the whole program on-the-spot. This tried to free any memory it
          * can as fast as possible, and this kills the whole program. Note that
@@ -101,6 +241,16 @@ namespace salt
          */
         static std::vector<byte> kill();
 
+        /**
+         * Create a label, which is added to the module label map by the
+         * virtual machine. Function labels are plain names, local jump
+         * locations should start with a '#'.
+         *
+         * @param   name  name of the label, without the '@'
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> label(std::string name);
+
         /**
          * All these methods create a single object local to the module.
          * Depending on the access modifier.
@@ -112,6 +262,8 @@ namespace salt
         static std::vector<byte> objectMake(uint id, bool readonly);
         static std::vector<byte> objectMake(uint id, bool readonly,
                                             int value);
+        static std::vector<byte> objectMake(uint id, bool readonly,
+                                            int64_t value);
         static std::vector<byte> objectMake(uint id, bool readonly,
                                             float value);
         static std::vector<byte> objectMake(uint id, bool readonly,
@@ -149,6 +301,46 @@ namespace salt
          */
         static std::vector<byte> return_();
 
+        /**
+         * Create an instruction out of already decoded operands. This is used
+         * by the compiler passes, which decode an instruction, change some of
+         * its operands (like object IDs or labels) and assemble it again.
+         *
+         * @param   instruction  mnemonic of the instruction
+         * @param   operands     operands in payload order
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> assemble(const std::string& instruction,
+                                          const std::vector<Operand>& operands);
+
+        /**
+         * Create a superinstruction out of two already synthesized
+         * instructions, by joining both payloads under a new mnemonic. This
+         * is used by the Fuser, which has no access to the original
+         * arguments.
+         *
+         * @param   instruction  mnemonic of the superinstruction
+         * @param   first        payload of the first instruction
+         * @param   second       payload of the second instruction
+         * @return  synthesized bytes
+         */
+        static std::vector<byte> fuse(const char instruction[6],
+                                      std::vector<byte> first,
+                                      std::vector<byte> second);
+
+        /**
+         * Select the operand encoding used by all methods from now on. This
+         * should be set once, before anything gets synthesized.
+         *
+         * @param   encoding  one of the Encoding values
+         */
+        static void setEncoding(Encoding encoding);
+
+        /**
+         * Return the currently used operand encoding.
+         */
+        static Encoding getEncoding();
+
         // Synthesizing
 
         /**
@@ -170,11 +362,46 @@ namespace salt
             return collector;
         }
 
-        static std::vector<byte> makeString(std::string value);
+        /**
+         * Encode an object ID, an instruction immediate (32 bit) or an int
+         * payload (64 bit), depending on the current encoding.
+         */
+        static std::vector<byte> makeId(uint id);
+        static std::vector<byte> makeImmediate(int value);
+        static std::vector<byte> makeInt(int64_t value);
+
+        /**
+         * Encode the value as an unsigned LEB128 varint, or as a zigzag
+         * signed one. Values below 128 (or -64..63) take a single byte.
+         *
+         * @param   value  value
+         * @return  array of 1 to 10 bytes
+         */
+        static std::vector<byte> makeVarUint(uint64_t value);
+        static std::vector<byte> makeVarInt(int64_t value);
+
+        /**
+         * Encode a length prefixed string. The bytes are kept as they are,
+         * the length prefix is what ends the string, so a newline inside of
+         * it doesn't end the instruction.
+         */
+        static std::vector<byte> makeString(const std::string& value);
         static std::vector<byte> makeBool(bool value);
 
+        /**
+         * Encode the payload of an instruction out of its decoded operands.
+         *
+         * @param   operands  operands in payload order
+         * @return  payload bytes
+         */
+        static std::vector<byte> makeOperands(
+                const std::vector<Operand>& operands);
+
     private:
 
+        /* Currently used operand encoding */
+        static Encoding encoding;
+
         /* Create a full instruction adding the newline at the end */
         static std::vector<byte> make(const char instruction[6],
                                       std::vector<byte> bytes);
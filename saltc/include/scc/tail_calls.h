@@ -0,0 +1,78 @@
+/**
+ * The tail calls module turns calls in tail position into plain jumps, so
+ * recursive code runs without growing the SVM call stack.
+ *
+ */
+#ifndef TAIL_CALLS_H_
+#define TAIL_CALLS_H_
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "../utils.h"
+#include "module.h"
+
+namespace salt
+{
+
+    /**
+     * A local call is in tail position if it's followed only by OBJDL calls
+     * cleaning up the caller objects and a RETRN. Such a call is replaced
+     * with a JMPTO to the function label, after moving the OBJDL calls in
+     * front of it. The callee then returns straight to our caller, so no
+     * call stack entry and no extra return dispatch is needed.
+     *
+     * Moving the OBJDL calls is only allowed if the callee, or anything it
+     * calls, can't see the deleted objects: it may not read or delete them
+     * before making its own copy, and may not leave a copy behind for the
+     * OBJDL to delete instead. Functions calling into other modules could
+     * call back into this one, so their calls are never replaced.
+     *
+     * A self-recursive tail call becomes a jump back to the start of the
+     * function, where the arguments pushed into the registers are popped
+     * again, turning the recursion into a loop.
+     *
+     * This has to run after the Inliner, because inlining a function which
+     * jumps to another one would make that one return from the caller.
+     */
+    class TailCalls
+    {
+    public:
+
+        /**
+         * Lower the tail calls in every function of the module.
+         *
+         * @param   module  module to change
+         * @return  amount of replaced calls
+         */
+        static uint lower(Module& module);
+
+    private:
+
+        /* The objects of its caller each function may read, delete or
+           leave on the tape, and the functions which may touch any */
+        struct Footprints
+        {
+            std::map<std::string, std::set<uint>> touched;
+            std::set<std::string> unknown;
+        };
+
+        /* Find the footprint of every function of the module */
+        static Footprints measure(const Module& module);
+
+        /**
+         * Replace all local calls in tail position in the function, whose
+         * callee doesn't touch the deleted objects.
+         *
+         * @param   function    function to change
+         * @param   footprints  footprints of the functions of the module
+         * @return  amount of replaced calls
+         */
+        static uint lower(Function& function, const Footprints& footprints);
+
+    };
+
+} // salt
+
+#endif // TAIL_CALLS_H_
@@ -0,0 +1,103 @@
+/**
+ * The tree shaker removes functions, constants and imports which can never
+ * be reached from the entry points of the program.
+ *
+ */
+#ifndef TREE_SHAKER_H_
+#define TREE_SHAKER_H_
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../utils.h"
+#include "module.h"
+
+namespace salt
+{
+
+    /**
+     * The tree shaker walks the call graph of all passed modules, starting
+     * from the main function of the first module and from every public
+     * function, and drops everything that wasn't reached:
+     *  - private functions nobody calls
+     *  - module level constants (readonly objects) nobody reads
+     *  - EXTLD calls of modules nobody calls into
+     *
+     * Calls to modules which were not passed to the tree shaker are treated
+     * as external, so their functions are never removed.
+     *
+     * Loading a module runs its prelude, so an EXTLD is only removed when
+     * the loaded module was passed too, and its prelude does nothing but
+     * create and delete objects on its own tape. Anything else, like a
+     * PRINT, a call or loading another module, could be seen by the program.
+     */
+    class TreeShaker
+    {
+    public:
+
+        /* What was removed and how many bytes that saved */
+        struct Report
+        {
+            std::vector<std::string> removed;
+            size_t bytes = 0;
+        };
+
+        /**
+         * @param   modules  all modules of the program, the first one being
+         *                   the main module
+         */
+        explicit TreeShaker(std::vector<Module *> modules);
+
+        /**
+         * Select if public functions should be kept even if nothing in the
+         * program calls them. This is on by default, because a separately
+         * compiled module can be imported later by anything. When the whole
+         * program is known, like when linking, it can be switched off.
+         *
+         * @param   keep  true to treat public functions as entry points
+         */
+        void keepExports(bool keep);
+
+        /**
+         * Remove everything unreachable from all the modules.
+         *
+         * @return  report of the removed parts
+         */
+        Report shake();
+
+    private:
+
+        typedef std::pair<Module *, std::string> Node;
+
+        /* Find the passed module by its name */
+        Module *findModule(const std::string& name);
+
+        /* Return true if loading the module can't be seen by the program,
+           because it was passed and its prelude only makes objects */
+        bool isPure(const std::string& name);
+
+        /* Follow every reference made by the instructions in module */
+        void visit(Module *module, const InstructionList& instructions);
+
+        /* Remove unreachable parts of a single module */
+        void sweep(Module *module, Report& report);
+
+        std::vector<Module *> modules;
+        bool keep_exports = true;
+
+        std::set<Node> reachable;
+        std::vector<Node> pending;
+
+        /* Modules called into from each module */
+        std::set<std::pair<Module *, std::string>> used_imports;
+
+        /* Object IDs read by each module */
+        std::set<std::pair<Module *, uint>> used_objects;
+
+    };
+
+} // salt
+
+#endif // TREE_SHAKER_H_
@@ -7,9 +7,13 @@
 #ifndef VALIDATOR_H_
 #define VALIDATOR_H_
 
+#include <span>
 #include <vector>
 
 #include "../utils.h"
+#include "synthesizer.h"
+#include "section_table.h"
+#include "bytecode_reader.h"
 
 namespace salt
 {
@@ -19,26 +23,36 @@ namespace salt
         const_string_size,
         const_string_amount,
         instruction_width_violation,
+        invalid_compression,
         invalid_const_string_id,
         invalid_data_width,
         invalid_header,
+        invalid_section,
+        invalid_type,
         newline_in_string,
         nonterminated_instruction,
         undeleted_object,
         unknown_id,
+        unknown_instruction,
+        unknown_label,
     };
 
     const std::string validator_errors[] {
         "Const string size",
         "Const string amount",
         "Instruction width violation",
+        "Invalid compression",
         "Invalid const string ID",
         "Invalid data width",
         "Invalid header",
+        "Invalid section",
+        "Invalid type",
         "Newline in string",
         "Non-terminated instruction",
         "Undeleted object",
         "Unknown ID",
+        "Unknown instruction",
+        "Unknown label",
     };
 
     /**
@@ -54,32 +68,44 @@ namespace salt
      *  - data width
      *  - unknown object IDs 
      *  - max instruction width
+     *  - operand layout of each known instruction, in both encodings
+     *  - both the SCC4 binary layout and the legacy SCC3 one
+     *  - the section table and the entries of each known section
+     *  - compressed sections, which are expanded before the other checks
+     *  - every entry of the offset index, against the offset the
+     *    instruction really starts at
+     *
+     * Instructions of big sectioned files can be checked on several threads.
+     * The code is split at the offsets of the offset index, or of the label
+     * section in files without one, which are known instruction boundaries,
+     * and each range is checked on its own. The first error in file order is
+     * reported, and if a range doesn't end exactly at the next one (the
+     * label section lies), the code is checked again in one go, so the
+     * result is always the same as on one thread.
+     *
+     * The validator doesn't own or copy the bytecode, every instruction is
+     * checked where it is, in a single pass. Only compressed files need a
+     * buffer of their own, to expand the sections into.
      */
     class Validator
     {
     public:
 
+        /* Minimum size of the code to check it on more than one thread */
+        constexpr static size_t PARALLEL_MIN_SIZE = 256 * 1024;
+
         /* SCC Magic number. */
         const std::string MAGIC = "\x7f\x53\x43\x43\xff\xee\x00\x00";
 
         /**
-         * Explicit validator constructor, initializes the bytecode and loads
-         * the contents into it's private memory. Unfortunately building the
-         * object isn't really possible with RAII, so there might be a little
-         * bit of overhead.
+         * Create a validator over the bytecode, which can be a string, a
+         * vector or a mapped file. The bytecode is not copied, so it has to
+         * outlive the validator.
          *
          * @param   bytecode  the whole bytecode that will be pushed to the
-         *                    output file  
-         */
-        explicit Validator(std::string& bytecode);
-
-        /**
-         * An alternative for the std::string version, which ultimately ends up
-         * calling the std::string version anyway.
-         *
-         * @param   bytecode  vector of bytes 
+         *                    output file
          */
-        explicit Validator(std::vector<byte>& bytecode);
+        explicit Validator(std::span<const byte> bytecode);
 
         /**
          * This adds a function that gets called upon error callback. 
@@ -89,6 +115,14 @@ namespace salt
          */ 
         void setErrorCallback(void (*__callback) (int));
 
+        /**
+         * Select the amount of threads checking the instructions. This is 1
+         * by default, 0 uses every hardware thread.
+         *
+         * @param   threads  amount of threads
+         */
+        void setThreads(uint threads);
+
         /**
          * Start the validation process. This will throw a ValidatorError if 
          * something goes wrong, so I recommend creating a try/catch block for
@@ -98,8 +132,27 @@ namespace salt
          */
         void validate();
 
+        /**
+         * Move the expanded file out of the validator, after a compressed
+         * file was validated, so a loader doesn't have to expand it again.
+         * The validator can't be used anymore after this.
+         *
+         * @return  the expanded file, or an empty string if the file wasn't
+         *          compressed
+         */
+        std::string takeExpanded();
+
     private:
 
+        /* Instructions between two known instruction boundaries */
+        struct Range
+        {
+            size_t start;
+            size_t end;
+            uint first;
+            uint amount;
+        };
+
         /**
          * This is the function that actually calls all the checks, so the try 
          * catch block can be located in the validate function.
@@ -114,6 +167,43 @@ namespace salt
          */
         uint checkConstStrings();
 
+        /**
+         * Read the section table of a sectioned file and check the entries
+         * of the constant, label and import sections.
+         *
+         * @return  the code section
+         * @throw   invalid_section
+         */
+        const Section *checkSections();
+
+        /**
+         * Check a table section: the entry count, that each entry fits and
+         * that the name (or string) it points at is inside the section.
+         *
+         * @param   section     section to check
+         * @param   entry_size  size of a single entry
+         * @throw   invalid_section
+         */
+        void checkTable(const Section& section, uint entry_size);
+
+        /**
+         * Check that every row of the debug section points at an
+         * instruction and a file, in increasing instruction order.
+         *
+         * @param   section  the debug section
+         * @throw   invalid_section
+         */
+        void checkDebug(const Section& section);
+
+        /**
+         * Check that the offset index has an entry for every instruction.
+         * The entries themselves are checked with the instructions.
+         *
+         * @param   section  the offset section
+         * @throw   invalid_section
+         */
+        void checkOffsets(const Section& section);
+
         /**
          * Check the magic number at the beggining of the bytecode. This should
          * always be 7f53 4343 ffee 0000.
@@ -129,7 +219,36 @@ namespace salt
          * @param   __n  start of instruction section
          * @throw   instruction_width_violation
          */
-        void checkInstructions(uint __n);
+        void checkInstructions(size_t __n);
+
+        /**
+         * Check the width of @a amount instructions from the reader, the
+         * first of which is instruction @a first.
+         *
+         * @throw   instruction_width_violation, nonterminated_instruction,
+         *          unknown_instruction, invalid_section
+         */
+        void checkRange(BytecodeReader& reader, uint first,
+                        uint amount) const;
+
+        /**
+         * Split the code at the offsets of the offset index or the label
+         * section into about four ranges for each thread.
+         *
+         * @param   __n  start of the code section
+         * @return  the ranges, or nothing if the code can't be split
+         */
+        std::vector<Range> splitCode(size_t __n) const;
+
+        /**
+         * Check the ranges on the threads, and throw the first error found.
+         *
+         * @param   ranges  ranges from splitCode()
+         * @return  false if a range didn't end at the start of the next one
+         * @throw   instruction_width_violation, nonterminated_instruction,
+         *          unknown_instruction
+         */
+        bool checkRanges(const std::vector<Range>& ranges) const;
 
         /**
          * Read the first 64 bytes from the bytecode and load the contents of
@@ -165,26 +284,52 @@ namespace salt
         uint getUint(uint __n);
 
         /**
-         * Fetch a single instruction starting from @a __n. This will read the
-         * bytecode until it finds a newline or the end of the code.
+         * Move the reader over a single instruction. The operands are
+         * decoded using the InstructionSet layout, because in both encodings
+         * they may contain 0x0a bytes. In the legacy layout, labels are read
+         * until the newline.
          *
-         * @param   __n  position to start reading from
-         * @return  whole instruction (without the newline)
-         * @throw   nonterminated_instruction
+         * @param   reader  reader at the start of the instruction
+         * @return  width of the instruction (without the legacy newline)
+         * @throw   nonterminated_instruction, unknown_instruction
          */
-        std::string getInstruction(uint __n);
+        size_t skipInstruction(BytecodeReader& reader) const;
+
+        /**
+         * Return true if the bytecode uses the newline delimited SCC3
+         * layout, which is still accepted for older files.
+         */
+        bool isLegacy() const;
 
 
         bool is_callback_set = false;
         void (*f_callback) (int);
+        uint threads = 1;
 
+        uint version;
         uint instruction_amount;
         uint cstring_amount;
         uint max_instruction_width;
+        uint section_amount;
+        Encoding encoding;
+        bool sectioned;
+        bool compressed;
 
-        std::string bytecode;
+        /* End of the instructions, the end of the code section if the
+           file is sectioned */
+        size_t code_start = 0;
+        size_t code_end;
+        SectionTable sections;
+
+        /* The offset index of a sectioned file, if it has one */
+        const Section *offsets = nullptr;
+
+        std::span<const byte> bytecode;
         std::vector<uint> object_ids;
 
+        /* Owns the bytecode of a compressed file, once it's expanded */
+        std::string expanded;
+
     };
 
 
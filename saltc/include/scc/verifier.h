@@ -0,0 +1,185 @@
+/**
+ * The verifier proves properties of a whole module which the Validator can't
+ * see from the structure alone, so the virtual machine can trust the module
+ * instead of checking each instruction as it runs it.
+ *
+ */
+#ifndef VERIFIER_H_
+#define VERIFIER_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../utils.h"
+#include "module.h"
+
+namespace salt
+{
+
+    /**
+     * The verifier runs every function (and the prelude) on abstract
+     * values: instead of the objects themselves, it tracks which object IDs
+     * are on the tape and the set of types each of them may have, following
+     * every jump until nothing changes anymore. Then it checks that:
+     *
+     *  - every object read by an instruction exists on all paths to it
+     *    (unknown_id)
+     *  - the int operands of IVADD, IVSUB, IXADD and the others, and the
+     *    index of jump tables, are ints, and the second operand of IXADD
+     *    and the others is an int or a float (invalid_type)
+     *  - every jump goes to a label of the same function or, as a tail
+     *    call, to a function, and every CALLF calls a function of the module
+     *    (unknown_label)
+     *  - every object created by a function is deleted, or moved into a
+     *    register, before it returns, and no module level object is
+     *    deleted, moved into a register or created again by a function
+     *    which returns (undeleted_object)
+     *  - module level objects are as the prelude leaves them at each call,
+     *    so the callee can rely on them (unknown_id, invalid_type)
+     *
+     * The prelude runs first, so the objects it leaves on the tape are
+     * available to every function. Calls are expected to leave the tape as
+     * they found it, which the return check makes sure of, but they clear
+     * what is known about the registers. CALLX and EXTLD are treated as
+     * calls too, because the other module can call back into this one.
+     * Calls made by the prelude itself are checked once the prelude is
+     * done, against the objects it leaves; a module loaded by EXTLD or
+     * called with CALLX may only find fewer objects there, which the virtual
+     * machine always checks for.
+     *
+     * The type of an object moved from a register which wasn't filled in the
+     * same function, like an argument, is unknown. Such objects pass the
+     * type checks, but the module is then not fully proven, and shouldn't be
+     * marked as verified.
+     */
+    class Verifier
+    {
+    public:
+
+        /* How much was checked, and how much of it couldn't be proven */
+        struct Report
+        {
+            uint instructions = 0;
+            uint unproven = 0;
+        };
+
+        /**
+         * @param   module  module to verify
+         */
+        explicit Verifier(const Module& module);
+
+        /**
+         * Verify the whole module.
+         *
+         * @return  report of the checks
+         * @throw   unknown_id, invalid_type, unknown_label, undeleted_object
+         */
+        Report verify();
+
+        /**
+         * Return true if the last verify() proved every check, so the
+         * module can get the SCC_FLAG_VERIFIED flag.
+         */
+        bool isProven() const;
+
+    private:
+
+        /* Possible states of a single object ID or register, as bits */
+        enum Value : uint8_t
+        {
+            VALUE_ABSENT  = 0x01,   // not on the tape
+            VALUE_NULL    = 0x02,
+            VALUE_INT     = 0x04,
+            VALUE_FLOAT   = 0x08,
+            VALUE_BOOL    = 0x10,
+            VALUE_STRING  = 0x20,
+            VALUE_UNKNOWN = 0x40    // any type
+        };
+
+        /* Everything known at a single point of the code. Objects which
+           are not listed are absent, registers which are not listed have
+           an unknown value. */
+        struct State
+        {
+            std::map<uint, uint8_t> objects;
+            std::map<uint, uint8_t> registers;
+
+            /* Objects of the entry state which were deleted, moved into a
+               register or created again on any path */
+            std::set<uint> touched;
+
+            /* Join the other state, return true if this one changed */
+            bool merge(const State& other);
+        };
+
+        /**
+         * Run a function body (or the prelude) until all states are stable,
+         * then check every instruction once more with the final states.
+         *
+         * @param   body      instructions to run
+         * @param   entry     state at the first instruction
+         * @param   function  true to check for undeleted objects on return
+         * @return  state at the end of the body
+         */
+        State run(const InstructionList& body, const State& entry,
+                  bool function);
+
+        /**
+         * Apply a single instruction to the state. Checks are only done
+         * if @a check is set, on the last round.
+         *
+         * @return  false if the instruction ends the path
+         */
+        bool step(const Instruction& instruction, State& state, bool check);
+
+        /* Return the indexes of the instructions a jump can continue at */
+        std::vector<size_t> targets(const Instruction& instruction) const;
+
+        /* Check that the object exists and has one of the allowed types */
+        void require(const State& state, uint id, uint8_t types, bool check);
+
+        /* Follow a jump which isn't to a label of the body, which is only
+           allowed as a tail call to a function */
+        void jumpOut(const std::string& label, const State& state,
+                     bool check);
+
+        /* Check that no object outside of the entry state is left, and
+           that the ones of the entry state weren't changed */
+        void checkReturn(const State& state) const;
+
+        /* Check that the module level objects are intact at a call, or
+           remember the state until the end of the prelude. Only the types
+           are checked if @a strict isn't set. */
+        void checkCall(const State& state, bool strict);
+
+        /* Check the calls made by the prelude against its final state */
+        void checkPreludeCalls(const State& globals) const;
+
+        /* Remember that the body changed an object of the entry state */
+        void touch(State& state, uint id) const;
+
+        /* Return true if the module has a function with the name */
+        bool hasFunction(const std::string& name) const;
+
+        /* Abstract value of a new object of the given Synthesizer type */
+        static uint8_t typeOf(byte type);
+
+        const Module& module;
+        Report report;
+
+        /* Labels of the body being run, its entry state and if it's a
+           function, which has to clean up before returning */
+        std::map<std::string, size_t> labels;
+        State body_entry;
+        bool in_function = false;
+
+        /* State at each call of the prelude, and if the call was strict */
+        std::vector<std::pair<State, bool>> prelude_calls;
+
+    };
+
+} // salt
+
+#endif // VERIFIER_H_
@@ -6,6 +6,9 @@
 #include <array>
 #include <stdint.h>
 #include "utils.h"
+#include "token.h"
+#include "scc/module.h"
+#include "scc/compressor.h"
 
 using std::string;
 
@@ -23,7 +26,13 @@ private:
         uint32_t instructions = 0;
         //uint32_t string_literals = 0; ??
         uint32_t max_instruction_width = 0;
+        uint32_t object_slots = 0;
+        uint32_t sections = 0;
+        bool compressed = false;
+        bool verified = false;
+        uint64_t memory_size = 0;
     } meta;
+    Compression compression = COMPRESSION_NONE;
 
 public:
 
@@ -32,6 +41,12 @@ public:
 
     string code;
 
+    /* Tokens of the code, after constant folding */
+    std::vector<Token> tokens;
+
+    /* Synthesized code of this source file */
+    Module module;
+
     /* Gets source file name */
     string getFilename() const;
 
@@ -41,7 +56,16 @@ public:
     /* Toogle global import 'init' standard library on */
     void includeBuiltins();
 
-    /* Returns SCC file header for this source file */
+    /* Sets compression of the SCC file sections */
+    void setCompression(Compression compression);
+
+    /* Marks the module as proven by the Verifier */
+    void setVerified(bool verified);
+
+    /**
+     * Returns SCC file header for this source file. The header contains
+     * metadata of the body, so makeSCCBody() has to be called first.
+     */
     std::array<byte, 64> makeSCCHeader();
 
     /* Return SCC file body for this source file */
@@ -8,6 +8,7 @@
 #include <queue>
 #include <string>
 #include <array>
+#include <vector>
 #include <stdint.h>
 
 using std::string;
@@ -25,6 +26,9 @@ T pop(Q& container) {
 
 string load_file(string filepath);
 
+/* Write the bytes to the file, replacing its contents. */
+void save_file(string filepath, const std::vector<byte>& data);
+
 template<typename T, size_t N, class A = std::array<T, N>>
 A ptr_to_array(T* data) {
     A array;
@@ -11,9 +11,51 @@
 #include "include/source_file.h"
 #include "include/logging.h"
 #include "include/tokenizer.h"
+#include "include/constant_folder.h"
+#include "include/scc/synthesizer.h"
+#include "include/scc/validator.h"
+#include "include/scc/disassembler.h"
+#include "include/scc/object_allocator.h"
+#include "include/scc/fuser.h"
+#include "include/scc/tree_shaker.h"
+#include "include/scc/inliner.h"
+#include "include/scc/tail_calls.h"
+#include "include/scc/loop_optimizer.h"
+#include "include/scc/jump_tables.h"
+#include "include/scc/compressor.h"
+#include "include/scc/image_reader.h"
+#include "include/scc/linker.h"
+#include "include/scc/stream_validator.h"
+#include "include/scc/verifier.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using std::filesystem::path;
 
 using namespace salt;
 
+/* Runs the verifier on the finished module of the source file. A module
+ * which fails or isn't fully proven is still written, just without the
+ * verified flag, so the virtual machine keeps checking it at runtime.
+ */
+static void verify_module(SourceFile& source) {
+    Verifier verifier(source.module);
+    try {
+        Verifier::Report report = verifier.verify();
+        iprint(
+            "Verified %u instructions, %u unproven operands",
+            report.instructions,
+            report.unproven);
+        source.setVerified(verifier.isProven());
+    } catch(ValidatorError e) {
+        wprint(
+            "Module not verified: %s",
+            validator_errors[e].c_str());
+    }
+}
+
 /* This is the main function for the salt compiler. It takes care of the 
  * arguments and controls the core parts of this program, like the
  * precompilation, parser, tokenizer, validator and synthesizer.
@@ -24,14 +66,119 @@ int main(int argc, char* argv[]) {
     dprint("Parameters parsed");
     reset_print_padding();
 
+    if(parameters.getDisassembleSwitch()) {
+        string bytecode = load_file(parameters.getInputPath());
+        try {
+            printf("%s", Disassembler(bytecode).render().c_str());
+        } catch(ValidatorError e) {
+            eprint(new CustomError(
+                "Cannot disassemble: " + validator_errors[e]));
+        }
+        return 0;
+    }
+
+    // The file is checked block by block, so it can be a pipe which is
+    // still being written to
+    if(parameters.getValidateSwitch()) {
+        StreamValidator validator;
+        std::ifstream file;
+        if(parameters.getInputPath() != "-")
+            file.open(parameters.getInputPath(), std::ios::binary);
+        std::istream& stream = parameters.getInputPath() == "-"
+            ? std::cin : file;
+        try {
+            validator.validate(stream);
+        } catch(ValidatorError e) {
+            eprint(new CustomError(
+                "Invalid SCC file: " + validator_errors[e]));
+        }
+        iprint(
+            "Validated %u instructions",
+            validator.getInstructionCount());
+        return 0;
+    }
+
+    if(parameters.getCompactSwitch())
+        Synthesizer::setEncoding(ENCODING_COMPACT);
+
+    Compression compression = COMPRESSION_NONE;
+    if(!parameters.getCompression().empty()
+            && !Compressor::parse(parameters.getCompression(), compression))
+        eprint(new CustomError(
+            "Unknown compression level '" + parameters.getCompression()
+            + "', use 'fast' or 'small'"));
+
+    if(parameters.getLinkSwitch()) {
+        std::vector<string> paths = parameters.getLinkPaths();
+        paths.insert(paths.begin(), parameters.getInputPath());
+
+        std::vector<Module> modules;
+        for(const string& module_path : paths) {
+            iprint("Reading module from: %s", module_path.c_str());
+            try {
+                modules.push_back(ImageReader::read(load_file(module_path),
+                    path(module_path).stem().string()));
+            } catch(ValidatorError e) {
+                eprint(new CustomError(
+                    "Cannot link '" + module_path + "': "
+                    + validator_errors[e]));
+            }
+        }
+
+        SourceFile linked_source(parameters.getInputPath());
+        linked_source.module = Linker(modules).link();
+        linked_source.setCompression(compression);
+        verify_module(linked_source);
+
+        std::vector<byte> output = linked_source.makeSCCBody();
+        std::array<byte, 64> header = linked_source.makeSCCHeader();
+        output.insert(output.begin(), header.begin(), header.end());
+        save_file(parameters.getOutputPath(), output);
+        iprint(
+            "Linked %zu modules, written %zu bytes to: %s",
+            modules.size(),
+            output.size(),
+            parameters.getOutputPath().c_str());
+        return 0;
+    }
+
     iprint(
         "Initializing main source file from: %s",
         parameters.getInputPath().c_str());
     SourceFile main_source(parameters.getInputPath());
     if(parameters.getBuiltinsSwitch())
         main_source.includeBuiltins();
+    main_source.setCompression(compression);
     Tokenizer main_tokenizer(main_source);
-    
+    ConstantFolder folder(main_tokenizer.getTokens());
+    main_source.tokens = folder.fold();
+    iprint(
+        "Folded %zu constant expressions, propagated %zu constants",
+        folder.getFoldedAmount(),
+        folder.getPropagatedAmount());
+
+    // There is no parser turning the tokens into functions yet, so the
+    // module only holds what was added above, like the builtins import.
+    Module& module = main_source.module;
+    Inliner(module).run();
+    TailCalls::lower(module);
+    TreeShaker({&module}).shake();
+    LoopOptimizer::optimize(module);
+    JumpTables::build(module);
+    ObjectAllocator::compact(module);
+    for(Function& function : module.functions)
+        Fuser::fuse(function.body);
+    verify_module(main_source);
+
+    std::vector<byte> output = main_source.makeSCCBody();
+    std::array<byte, 64> header = main_source.makeSCCHeader();
+    output.insert(output.begin(), header.begin(), header.end());
+    save_file(parameters.getOutputPath(), output);
+    iprint(
+        "Written %zu bytes to: %s",
+        output.size(),
+        parameters.getOutputPath().c_str());
+
 
     return 0;
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "../include/utils.h"
 #include "../include/scc/synthesizer.h"
 #include <stdint.h>
+#include <string.h>
 #include <array>
 
 namespace salt
@@ -18,7 +19,8 @@ namespace salt
 
     /* Format version identificator */
     const std::array<byte, 2> CompilerMetadata::SCC_VERSION =
-        ptr_to_array<byte, 2>(Synthesizer::makeNum((uint16_t) 1).data());
+        ptr_to_array<byte, 2>(
+            Synthesizer::makeNum((uint16_t) Synthesizer::FORMAT).data());
         /*                     format version number (uint16) ^         */
 
     /* Compiler signature */
@@ -26,4 +28,12 @@ namespace salt
         '\x7f','\x7a','\x7b','\x7c','\x00','\x00','\x00','\x0a'};
         /*                             xx     xx     xx         */
 
+    uint CompilerMetadata::getFlags(const byte *header) {
+        uint16_t version;
+        uint flags;
+        memcpy(&version, header + 8, sizeof(version));
+        memcpy(&flags, header + 12, sizeof(flags));
+        return version > SCC_LEGACY_VERSION ? flags : 0;
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,532 @@
+/**
+ * constant_folder.h implementation
+ *
+ */
+#include "../include/constant_folder.h"
+
+#include "../include/utils.h"
+#include "../include/logging.h"
+#include "../include/scc/synthesizer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using std::string;
+
+namespace salt
+{
+
+/* Thrown when an expression can't be folded safely */
+struct Unfoldable {};
+
+ConstantFolder::ConstantFolder(const std::vector<Token>& tokens)
+    :input(tokens) {}
+
+std::vector<Token> ConstantFolder::fold() {
+    std::vector<Token> output;
+    scopes = {{}};
+
+    for(size_t i = 0; i < input.size();) {
+        const Token& token = input[i];
+        if(token.type == BKT_CULRL) scopes.push_back({});
+        if(token.type == BKT_CULRR && scopes.size() > 1) scopes.pop_back();
+
+        // A non-const declaration hides any outer constant with that name
+        bool declaration = token.type >= TYPE_BOOL &&
+            token.type <= TYPE_STRING &&
+            at(i+1).type == TOK_NAME;
+        if(declaration && (!i || at(i-1).type != KW_CONST))
+            scopes.back()[at(i+1).value] = ConstValue();
+
+        output.push_back(token);
+        i++;
+        if(!isExpressionStart(i-1)) continue;
+
+        size_t start = i;
+        size_t end = i;
+        Node node = {start, start, false, {}};
+        folds.clear();
+        try {
+            node = parseExpression(end);
+            TokenType next = at(end).type;
+            if(next != OP_SEMIC && next != OP_COMMA && next != OP_COLON &&
+               next != BKT_ROUNDR && next != BKT_SQUARER &&
+               next != BKT_CULRL && next != BKT_CULRR && next != TOK_0)
+                throw Unfoldable();
+            record(node);
+        } catch(Unfoldable) {
+            folds.clear();
+            node.constant = false;
+            end = start;
+        }
+
+        // const TYPE NAME = <expression>
+        if(start >= 4 &&
+           at(start-1).type == ASOP_ASSIGN &&
+           at(start-2).type == TOK_NAME &&
+           at(start-4).type == KW_CONST) {
+            TokenType declared = at(start-3).type;
+            bool matches = node.constant && (
+                (declared == TYPE_INT && node.value.type == TOKL_INT) ||
+                (declared == TYPE_FLOAT && node.value.type == TOKL_FLOAT) ||
+                (declared == TYPE_BOOL && node.value.type == TOKL_BOOL) ||
+                (declared == TYPE_STRING && node.value.type == TOKL_STRING));
+            scopes.back()[at(start-2).value] =
+                matches ? node.value : ConstValue();
+        }
+
+        size_t next_fold = 0;
+        while(i < end) {
+            if(next_fold < folds.size() && folds[next_fold].begin == i) {
+                output.push_back(folds[next_fold].literal);
+                i = folds[next_fold].end;
+                next_fold++;
+                continue;
+            }
+            output.push_back(input[i]);
+            i++;
+        }
+    }
+
+    dprint(
+        "Folded %zu constant expressions, propagated %zu constants",
+        folded,
+        propagated);
+    return output;
+}
+
+size_t ConstantFolder::getFoldedAmount() const {return folded;}
+
+size_t ConstantFolder::getPropagatedAmount() const {return propagated;}
+
+ConstValue ConstantFolder::parseLiteral(const Token& token) {
+    ConstValue value;
+    const string& text = token.value;
+    try {
+        switch(token.type) {
+            case TOKL_INT: {
+                int base = 10;
+                if(text.size() > 1 && (text[1] == 'x' || text[1] == 'X'))
+                    base = 16;
+                else if(text.size() > 1 && text[0] == '0')
+                    base = 8;
+                value.integer = (int64_t) std::stoull(text, nullptr, base);
+                if(text[0] == '-')
+                    value.integer = std::stoll(text, nullptr, base);
+                break;
+            }
+            case TOKL_FLOAT:
+                value.real = std::stod(text);
+                break;
+            case TOKL_BOOL:
+                value.boolean = text == "true";
+                break;
+            case TOKL_STRING:
+                if(text.size() < 2 || !isstropen(text[0])) return value;
+                value.quote = text[0];
+                value.str = text.substr(1, text.size()-2);
+                break;
+            default:
+                return value;
+        }
+    } catch(std::exception&) {
+        return value;
+    }
+    value.type = token.type;
+    return value;
+}
+
+Token ConstantFolder::makeLiteral(
+    const ConstValue& value,
+    InStringPosition pos) {
+        string text;
+        char buf[32];
+        switch(value.type) {
+            case TOKL_INT:
+                text = std::to_string(value.integer);
+                break;
+            case TOKL_FLOAT:
+                snprintf(buf, sizeof(buf), "%.17g", value.real);
+                text = buf;
+                if(text.find_first_of(".e") == string::npos) text += ".0";
+                break;
+            case TOKL_BOOL:
+                text = value.boolean ? "true" : "false";
+                break;
+            case TOKL_STRING:
+                text = value.quote + value.str + value.quote;
+                break;
+            default:
+                break;
+        }
+        return token_create(value.type, pos, text);
+    }
+
+ConstValue ConstantFolder::evaluate(
+    TokenType op,
+    const ConstValue& left,
+    const ConstValue& right) {
+        ConstValue result;
+        bool ints = left.type == TOKL_INT && right.type == TOKL_INT;
+        bool numbers =
+            (left.type == TOKL_INT || left.type == TOKL_FLOAT) &&
+            (right.type == TOKL_INT || right.type == TOKL_FLOAT);
+
+        if(ints) {
+            // Wrap around like the 64-bit int in the virtual machine
+            uint64_t a = left.integer;
+            uint64_t b = right.integer;
+            auto boolean = [&](bool value) {
+                result.type = TOKL_BOOL;
+                result.boolean = value;
+                return result;
+            };
+            result.type = TOKL_INT;
+            switch(op) {
+                // Compared exactly like in the virtual machine, as doubles
+                // can't tell all of them apart
+                case COP_EQUAL: return boolean(left.integer == right.integer);
+                case COP_LT: return boolean(left.integer < right.integer);
+                case COP_GT: return boolean(left.integer > right.integer);
+                case COP_LOREQ: return boolean(left.integer <= right.integer);
+                case COP_GOREQ: return boolean(left.integer >= right.integer);
+                case AOP_ADD: result.integer = a + b; return result;
+                case AOP_SUB: result.integer = a - b; return result;
+                case MULTOP_STAR: result.integer = a * b; return result;
+                case AOP_DIV:
+                case AOP_MOD:
+                    if(!right.integer ||
+                       (right.integer == -1 && left.integer == INT64_MIN))
+                        return ConstValue();
+                    result.integer = op == AOP_DIV
+                        ? left.integer / right.integer
+                        : left.integer % right.integer;
+                    return result;
+                case AOP_POW: {
+                    if(right.integer < 0) return ConstValue();
+                    uint64_t power = 1;
+                    for(; b; b >>= 1, a *= a) if(b & 1) power *= a;
+                    result.integer = power;
+                    return result;
+                }
+                case BOP_OR: result.integer = a | b; return result;
+                case BOP_AND: result.integer = a & b; return result;
+                case BOP_XOR: result.integer = a ^ b; return result;
+                case BOP_LS:
+                case BOP_RS:
+                    if(right.integer < 0 || right.integer > 63)
+                        return ConstValue();
+                    result.integer = op == BOP_LS
+                        ? (int64_t) (a << b)
+                        : left.integer >> right.integer;
+                    return result;
+                default: break;
+            }
+        }
+
+        if(numbers) {
+            double a = left.type == TOKL_INT ? left.integer : left.real;
+            double b = right.type == TOKL_INT ? right.integer : right.real;
+            result.type = TOKL_BOOL;
+            switch(op) {
+                case COP_EQUAL: result.boolean = a == b; return result;
+                case COP_LT: result.boolean = a < b; return result;
+                case COP_GT: result.boolean = a > b; return result;
+                case COP_LOREQ: result.boolean = a <= b; return result;
+                case COP_GOREQ: result.boolean = a >= b; return result;
+                default: break;
+            }
+
+            if(ints) return ConstValue();
+            result.type = TOKL_FLOAT;
+            switch(op) {
+                case AOP_ADD: result.real = a + b; break;
+                case AOP_SUB: result.real = a - b; break;
+                case MULTOP_STAR: result.real = a * b; break;
+                case AOP_DIV:
+                    if(b == 0) return ConstValue();
+                    result.real = a / b;
+                    break;
+                case AOP_POW: result.real = pow(a, b); break;
+                default: return ConstValue();
+            }
+            if(!std::isfinite(result.real)) return ConstValue();
+            return result;
+        }
+
+        if(left.type == TOKL_BOOL && right.type == TOKL_BOOL) {
+            result.type = TOKL_BOOL;
+            switch(op) {
+                case LOP_AND:
+                    result.boolean = left.boolean && right.boolean;
+                    return result;
+                case LOP_OR:
+                    result.boolean = left.boolean || right.boolean;
+                    return result;
+                case COP_EQUAL:
+                    result.boolean = left.boolean == right.boolean;
+                    return result;
+                default: break;
+            }
+        }
+
+        // Strings are kept as source text, so only fold them if both use
+        // the same quotes and equality isn't affected by escapes
+        if(left.type == TOKL_STRING && right.type == TOKL_STRING &&
+           left.quote == right.quote) {
+            if(op == AOP_ADD) {
+                result = left;
+                result.str += right.str;
+                return result;
+            }
+            if(op == COP_EQUAL &&
+               left.str.find('\\') == string::npos &&
+               right.str.find('\\') == string::npos) {
+                result.type = TOKL_BOOL;
+                result.boolean = left.str == right.str;
+                return result;
+            }
+        }
+
+        return ConstValue();
+    }
+
+ConstValue ConstantFolder::evaluate(TokenType op, const ConstValue& value) {
+    ConstValue result = value;
+    if(op == AOP_SUB && value.type == TOKL_INT) {
+        result.integer = (int64_t) (0 - (uint64_t) value.integer);
+        return result;
+    }
+    if(op == AOP_SUB && value.type == TOKL_FLOAT) {
+        result.real = -value.real;
+        return result;
+    }
+    if(op == MULTOP_NOT && value.type == TOKL_BOOL) {
+        result.boolean = !value.boolean;
+        return result;
+    }
+    return ConstValue();
+}
+
+std::vector<byte> ConstantFolder::makeObject(
+    uint id,
+    const ConstValue& value) {
+        switch(value.type) {
+            case TOKL_INT:
+                return Synthesizer::objectMake(id, true, value.integer);
+            case TOKL_FLOAT:
+                return Synthesizer::objectMake(id, true, (float) value.real);
+            case TOKL_BOOL:
+                return Synthesizer::objectMake(id, true, value.boolean);
+            default:
+                break;
+        }
+
+        // Strings hold the source text, so the escapes need resolving
+        string str;
+        for(size_t i = 0; i < value.str.size(); i++) {
+            char chr = value.str[i];
+            if(chr == '\\' && i + 1 < value.str.size()) {
+                switch(value.str[++i]) {
+                    case 'n': chr = '\n'; break;
+                    case 't': chr = '\t'; break;
+                    case 'r': chr = '\r'; break;
+                    case 'v': chr = '\v'; break;
+                    case 'b': chr = '\b'; break;
+                    case 'a': chr = '\a'; break;
+                    case 'f': chr = '\f'; break;
+                    case 'e': chr = '\x1b'; break;
+                    default: chr = value.str[i]; break;
+                }
+            }
+            str += chr;
+        }
+        return Synthesizer::objectMake(id, true, str);
+    }
+
+int ConstantFolder::precedence(TokenType op) {
+    switch(op) {
+        case LOP_OR: return 1;
+        case LOP_AND: return 2;
+        case BOP_OR: return 3;
+        case BOP_XOR: return 4;
+        case BOP_AND: return 5;
+        case COP_EQUAL: return 6;
+        case COP_LT:
+        case COP_GT:
+        case COP_LOREQ:
+        case COP_GOREQ: return 7;
+        case BOP_LS:
+        case BOP_RS: return 8;
+        case AOP_ADD:
+        case AOP_SUB: return 9;
+        case MULTOP_STAR:
+        case AOP_DIV:
+        case AOP_MOD: return 10;
+        case AOP_POW: return 11;
+        default: return 0;
+    }
+}
+
+const Token& ConstantFolder::at(size_t idx) const {
+    if(idx >= input.size()) return null_token;
+    return input[idx];
+}
+
+ConstantFolder::Node ConstantFolder::parseExpression(
+    size_t& idx,
+    int min_precedence) {
+        Node left = parseOperand(idx);
+
+        while(true) {
+            TokenType op = at(idx).type;
+            int prec = precedence(op);
+            if(!prec || prec <= min_precedence) break;
+            idx++;
+
+            // The power operator is right associative
+            Node right = parseExpression(idx, op == AOP_POW ? prec-1 : prec);
+            Node node = {left.begin, right.end, false, {}};
+            if(left.constant && right.constant) {
+                node.value = evaluate(op, left.value, right.value);
+                node.constant = node.value.type != TOK_0;
+            }
+            if(!node.constant) {
+                record(left);
+                record(right);
+            }
+            left = node;
+        }
+
+        return left;
+    }
+
+ConstantFolder::Node ConstantFolder::parseOperand(size_t& idx) {
+    const Token& token = at(idx);
+    Node node = {idx, idx+1, false, {}};
+
+    switch(token.type) {
+        case AOP_SUB:
+        case MULTOP_NOT: {
+            idx++;
+            Node operand = parseExpression(idx, precedence(AOP_POW)-1);
+            node.end = operand.end;
+            if(operand.constant) {
+                node.value = evaluate(token.type, operand.value);
+                node.constant = node.value.type != TOK_0;
+            }
+            if(!node.constant) record(operand);
+            return node;
+        }
+        case TOKL_INT:
+        case TOKL_FLOAT:
+        case TOKL_BOOL:
+        case TOKL_STRING:
+            idx++;
+            node.value = parseLiteral(token);
+            node.constant = node.value.type != TOK_0;
+            return node;
+        case TOKL_NULL:
+            idx++;
+            return node;
+        case BKT_ROUNDL: {
+            idx++;
+            Node inner = parseExpression(idx);
+            if(at(idx).type != BKT_ROUNDR) throw Unfoldable();
+            idx++;
+            // Fold the inside, so the parentheses stay where they were
+            record(inner);
+            node.end = idx;
+            node.constant = inner.constant;
+            node.value = inner.value;
+            node.grouped = true;
+            return node;
+        }
+        case TOK_NAME:
+            break;
+        default:
+            throw Unfoldable();
+    }
+
+    idx++;
+    bool postfix = false;
+    while(true) {
+        TokenType next = at(idx).type;
+        if(next == OP_DOT) {
+            if(at(idx+1).type != TOK_NAME) throw Unfoldable();
+            idx += 2;
+        }
+        else if(next == BKT_ROUNDL) parseArguments(idx, BKT_ROUNDR);
+        else if(next == BKT_SQUAREL) parseArguments(idx, BKT_SQUARER);
+        else break;
+        postfix = true;
+    }
+    node.end = idx;
+
+    const ConstValue* value = lookup(token.value);
+    if(!postfix && value) {
+        node.constant = true;
+        node.value = *value;
+    }
+    return node;
+}
+
+void ConstantFolder::parseArguments(size_t& idx, TokenType close) {
+    idx++;
+    if(at(idx).type == close) {
+        idx++;
+        return;
+    }
+    while(true) {
+        record(parseExpression(idx));
+        TokenType next = at(idx).type;
+        idx++;
+        if(next == close) return;
+        if(next != OP_COMMA) throw Unfoldable();
+    }
+}
+
+void ConstantFolder::record(const Node& node) {
+    if(!node.constant || node.grouped) return;
+    bool name = node.end - node.begin == 1 && at(node.begin).type == TOK_NAME;
+    if(node.end - node.begin < 2 && !name) return;
+
+    // Nested records come first, drop the ones this node covers
+    while(!folds.empty() && folds.back().begin >= node.begin)
+        folds.pop_back();
+
+    folds.push_back({
+        node.begin,
+        node.end,
+        makeLiteral(node.value, at(node.begin).position)});
+    if(name) propagated++;
+    else folded++;
+}
+
+const ConstValue* ConstantFolder::lookup(const string& name) const {
+    for(auto scope = scopes.rbegin(); scope != scopes.rend(); scope++) {
+        auto found = scope->find(name);
+        if(found == scope->end()) continue;
+        if(found->second.type == TOK_0) return nullptr;
+        return &found->second;
+    }
+    return nullptr;
+}
+
+bool ConstantFolder::isExpressionStart(size_t idx) const {
+    TokenType type = at(idx).type;
+    if(type >= ASOP_ASSIGN && type <= ASOP_ASSBRS)
+        return type != ASOP_INCR && type != ASOP_DECR;
+    if(type == KW_RETURN || type == KW_THROW || type == KW_IF ||
+       type == KW_ELIF || type == KW_WHILE)
+        return true;
+
+    // Call statements, like print(...);
+    return (type == OP_SEMIC || type == BKT_CULRL || type == BKT_CULRR) &&
+        at(idx+1).type == TOK_NAME &&
+        at(idx+2).type == BKT_ROUNDL;
+}
+
+} // salt
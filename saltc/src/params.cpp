@@ -41,6 +41,33 @@ void Params::initObject(std::queue<string> args) {
             builtins = false;
             dprint("Include builtins switched off");
         }
+        else if (Params::arg_comp(arg, "--compact", "")) {
+            dprint("Switching compact operand encoding on");
+            compact = true;
+            dprint("Compact operand encoding switched on");
+        }
+        else if (Params::arg_comp(arg, "--compress", "")) {
+            dprint("Setting up section compression");
+            compression = pop<string>(args);
+            dprint(
+                "Section compression setted up to: %s",
+                compression.c_str());
+        }
+        else if (Params::arg_comp(arg, "--disassemble", "-D")) {
+            dprint("Switching disassemble mode on");
+            disassemble = true;
+            dprint("Disassemble mode switched on");
+        }
+        else if (Params::arg_comp(arg, "--validate", "")) {
+            dprint("Switching validate mode on");
+            validate = true;
+            dprint("Validate mode switched on");
+        }
+        else if (Params::arg_comp(arg, "--link", "")) {
+            dprint("Switching link mode on");
+            link = true;
+            dprint("Link mode switched on");
+        }
         else if (Params::arg_comp(arg, "--output", "-o")) {
             dprint("Setting up output file path");
             output_path = pop<string>(args);
@@ -48,7 +75,7 @@ void Params::initObject(std::queue<string> args) {
                 "Output file path setted up at: %s",
                 output_path.c_str());
         }
-        else if (arg[0] == '-')
+        else if (arg[0] == '-' && arg != "-")
             eprint(new UnrecognizedOptionError(arg));
         else { // Nameless arguments
             if (input_path.empty()) {
@@ -59,10 +86,8 @@ void Params::initObject(std::queue<string> args) {
                     input_path.c_str());
             }
             else {
-                wprint(
-                    "Argument '%s' can not be parsed now. "
-                    "This will be implemented in a future",
-                    arg.c_str());
+                dprint("Adding linked file path: %s", arg.c_str());
+                link_paths.push_back(arg);
             }
         }
     }
@@ -70,6 +95,15 @@ void Params::initObject(std::queue<string> args) {
     if (input_path.empty()) {
         eprint(new UnspecifiedMainError());
     }
+
+    if (!link) {
+        for (const string& arg : link_paths) {
+            wprint(
+                "Argument '%s' can not be parsed now. "
+                "This will be implemented in a future",
+                arg.c_str());
+        }
+    }
 }
 
 /**
@@ -126,15 +160,44 @@ string Params::getOutputPath() {return this->output_path;}
 /* Gets builtins include switch value */
 bool Params::getBuiltinsSwitch() {return this->builtins;}
 
+/* Gets compact operand encoding switch value */
+bool Params::getCompactSwitch() {return this->compact;}
+
+/* Gets section compression argument value */
+string Params::getCompression() {return this->compression;}
+
+/* Gets disassemble switch value */
+bool Params::getDisassembleSwitch() {return this->disassemble;}
+
+/* Gets validate switch value */
+bool Params::getValidateSwitch() {return this->validate;}
+
+/* Gets link switch value */
+bool Params::getLinkSwitch() {return this->link;}
+
+/* Gets paths of the modules linked with the input file */
+std::vector<string> Params::getLinkPaths() {return this->link_paths;}
+
 void Params::print_help_page() {
     printf(
-        "Usage: saltc [OPTIONS]... FILE\n\n"
+        "Usage: saltc [OPTIONS]... FILE\n"
+        "       saltc --link [OPTIONS]... MAIN MODULE...\n\n"
         "\tFILE                 "
             "name of the file to be compiled\n"
         "\t-h, --help           "
             "show this page\n"
         "\t-o, --output <path>  "
             "path of the compilation output file\n"
+        "\t-D, --disassemble    "
+            "disassemble the passed SCC file instead of compiling\n"
+        "\t--validate           "
+            "validate the passed SCC file while reading it, '-' for stdin\n"
+        "\t--link               "
+            "link compiled SCC modules into a single SCC file\n"
+        "\t--compact            "
+            "encode operands as varints to make the output smaller\n"
+        "\t--compress <level>   "
+            "compress the sections, level is 'fast' or 'small'\n"
         "\t--no-builtins        "
             "don't link builtin functionality when compiling\n"
         "\n");
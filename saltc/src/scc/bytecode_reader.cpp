@@ -0,0 +1,293 @@
+/**
+ * bytecode_reader.h implementation
+ *
+ */
+#include "../../include/scc/bytecode_reader.h"
+#include "../../include/scc/validator.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace salt
+{
+
+BytecodeReader::BytecodeReader(const byte *__b, size_t __n,
+                               Encoding encoding)
+    : data(__b), size(__n), encoding(encoding) {}
+
+size_t BytecodeReader::tell() const
+{
+    return cursor;
+}
+
+void BytecodeReader::seek(size_t __n)
+{
+    cursor = __n;
+}
+
+bool BytecodeReader::atEnd() const
+{
+    return cursor >= size;
+}
+
+byte BytecodeReader::peek() const
+{
+    require(1);
+    return data[cursor];
+}
+
+byte BytecodeReader::readByte()
+{
+    return readRaw<byte>();
+}
+
+uint BytecodeReader::readId()
+{
+    if (encoding == ENCODING_COMPACT)
+        return (uint) readVarUint();
+    return readRaw<uint>();
+}
+
+int BytecodeReader::readImmediate()
+{
+    if (encoding == ENCODING_COMPACT)
+        return (int) readVarInt();
+    return readRaw<int>();
+}
+
+int64_t BytecodeReader::readInt()
+{
+    // SCC3 ints are only 4 bytes, and legacy files are never compact
+    if (legacy)
+        return readRaw<int>();
+    if (encoding == ENCODING_COMPACT)
+        return readVarInt();
+    return readRaw<int64_t>();
+}
+
+float BytecodeReader::readFloat()
+{
+    return readRaw<float>();
+}
+
+std::string BytecodeReader::readString()
+{
+    size_t len;
+    if (encoding == ENCODING_COMPACT)
+        len = readVarUint();
+    else
+        len = readRaw<uint>();
+
+    require(len);
+    std::string value(data + cursor, len);
+    cursor += len;
+
+    // SCC3 strings can't hold a newline, it's escaped as 0x11
+    if (legacy)
+        std::replace(value.begin(), value.end(), '\x11', '\n');
+    return value;
+}
+
+void BytecodeReader::skipString()
+{
+    size_t len;
+    if (encoding == ENCODING_COMPACT)
+        len = readVarUint();
+    else
+        len = readRaw<uint>();
+
+    require(len);
+    cursor += len;
+}
+
+uint64_t BytecodeReader::readVarUint()
+{
+    uint64_t value = 0;
+    for (uint shift = 0; shift < 64; shift += 7) {
+        byte part = readByte();
+        value |= (uint64_t) (part & 0x7f) << shift;
+        if (!(part & 0x80))
+            return value;
+    }
+
+    // More than 10 bytes, this cannot be a valid varint
+    throw ValidatorError::invalid_data_width;
+}
+
+int64_t BytecodeReader::readVarInt()
+{
+    uint64_t value = readVarUint();
+    return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+void BytecodeReader::setLegacy(bool legacy)
+{
+    this->legacy = legacy;
+}
+
+const InstructionInfo *BytecodeReader::readInstruction(std::string& __label)
+{
+    return readHead(&__label);
+}
+
+const InstructionInfo *BytecodeReader::skipInstruction()
+{
+    const InstructionInfo *info = readHead(nullptr);
+    if (info) {
+        for (OperandType type : info->operands)
+            skipOperand(type);
+    }
+
+    return info;
+}
+
+void BytecodeReader::endInstruction()
+{
+    if (!legacy)
+        return;
+    if (atEnd() || readByte() != '\n')
+        throw ValidatorError::nonterminated_instruction;
+}
+
+Operand BytecodeReader::readOperand(OperandType type)
+{
+    Operand operand;
+    operand.type = type;
+
+    switch (type) {
+        case OPERAND_ID:
+            operand.number = readId();
+            break;
+        case OPERAND_IMMEDIATE:
+            operand.number = readImmediate();
+            break;
+        case OPERAND_STRING:
+            operand.text = readString();
+            break;
+        case OPERAND_REGISTER:
+            operand.number = (unsigned char) readByte();
+            break;
+        case OPERAND_OBJECT:
+            operand.readonly = readByte() != Synthesizer::CONSTANT_FALSE;
+            operand.object_type = readByte();
+            switch (operand.object_type) {
+                case Synthesizer::TYPE_INT:
+                    operand.number = readInt();
+                    break;
+                case Synthesizer::TYPE_FLOAT:
+                    operand.real = readFloat();
+                    break;
+                case Synthesizer::TYPE_BOOL:
+                    operand.number = readByte();
+                    break;
+                case Synthesizer::TYPE_STRING:
+                    operand.text = readString();
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case OPERAND_LABELS:
+        case OPERAND_CASES:
+            for (int i = readImmediate(); i > 0; i--) {
+                if (type == OPERAND_CASES)
+                    operand.keys.push_back(readImmediate());
+                operand.labels.push_back(readString());
+            }
+            break;
+    }
+
+    return operand;
+}
+
+void BytecodeReader::skipOperand(OperandType type)
+{
+    switch (type) {
+        case OPERAND_ID:
+            readId();
+            break;
+        case OPERAND_IMMEDIATE:
+            readImmediate();
+            break;
+        case OPERAND_STRING:
+            skipString();
+            break;
+        case OPERAND_REGISTER:
+            readByte();
+            break;
+        case OPERAND_OBJECT:
+            readByte();
+            switch (readByte()) {
+                case Synthesizer::TYPE_INT:
+                    readInt();
+                    break;
+                case Synthesizer::TYPE_FLOAT:
+                    readFloat();
+                    break;
+                case Synthesizer::TYPE_BOOL:
+                    readByte();
+                    break;
+                case Synthesizer::TYPE_STRING:
+                    skipString();
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case OPERAND_LABELS:
+        case OPERAND_CASES:
+            for (int i = readImmediate(); i > 0; i--) {
+                if (type == OPERAND_CASES)
+                    readImmediate();
+                skipString();
+            }
+            break;
+    }
+}
+
+void BytecodeReader::require(size_t __n) const
+{
+    // A varint length can be close to 2^64, so this can't add to cursor
+    if (cursor > size || __n > size - cursor)
+        throw ValidatorError::invalid_data_width;
+}
+
+const InstructionInfo *BytecodeReader::readHead(std::string *__label)
+{
+    if (!legacy) {
+        byte opcode = readByte();
+        if (opcode == InstructionSet::LABEL) {
+            if (__label)
+                *__label = readString();
+            else
+                skipString();
+            return nullptr;
+        }
+
+        const InstructionInfo *info = InstructionSet::find(opcode);
+        if (!info)
+            throw ValidatorError::unknown_instruction;
+        return info;
+    }
+
+    if (peek() == '@') {
+        const byte *endl = (const byte *) memchr(data + cursor, '\n',
+                                                 size - cursor);
+        if (!endl)
+            throw ValidatorError::nonterminated_instruction;
+        if (__label)
+            *__label = std::string(data + cursor + 1, endl);
+        cursor = endl - data;
+        return nullptr;
+    }
+
+    require(5);
+    const InstructionInfo *info;
+    info = InstructionSet::find(std::string(data + cursor, 5));
+    if (!info)
+        throw ValidatorError::unknown_instruction;
+    cursor += 5;
+    return info;
+}
+
+} // salt
@@ -0,0 +1,234 @@
+/**
+ * compressor.h implementation
+ *
+ */
+#include "../../include/scc/compressor.h"
+#include "../../include/scc/validator.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace salt
+{
+
+/* Amount of bits of the match finder hash */
+static const uint HASH_BITS = 16;
+
+static uint32_t hashAt(const std::vector<byte>& data, size_t __i)
+{
+    uint32_t value;
+    memcpy(&value, data.data() + __i, sizeof(value));
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+std::vector<byte> Compressor::compress(const std::vector<byte>& data,
+                                       Compression level)
+{
+    std::vector<byte> out;
+    size_t n = data.size();
+
+    // The fast level only probes the newest position with the same hash,
+    // and skips ahead quicker the longer it finds nothing
+    bool small = level == COMPRESSION_SMALL;
+    uint depth = small ? 64 : 1;
+    std::vector<int64_t> head((size_t) 1 << HASH_BITS, -1);
+    std::vector<int64_t> chain(n, -1);
+
+    auto insert = [&](size_t i) {
+        uint32_t hash = hashAt(data, i);
+        chain[i] = head[hash];
+        head[hash] = i;
+    };
+
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + MIN_MATCH <= n) {
+        size_t offset;
+        size_t length = findMatch(data, i, chain, head[hashAt(data, i)],
+                                  depth, offset);
+        insert(i);
+
+        if (!length) {
+            i += small ? 1 : 1 + ((i - anchor) >> 6);
+            continue;
+        }
+
+        // Lazy matching, a longer match right after this one wins
+        if (small && i + 1 + MIN_MATCH <= n) {
+            size_t next_offset;
+            if (findMatch(data, i + 1, chain, head[hashAt(data, i + 1)],
+                          depth, next_offset) > length) {
+                i++;
+                continue;
+            }
+        }
+
+        pushSequence(out, data.data() + anchor, i - anchor, offset, length);
+        if (small) {
+            for (size_t k = i + 1; k < i + length && k + MIN_MATCH <= n; k++)
+                insert(k);
+        }
+        i += length;
+        anchor = i;
+    }
+
+    pushSequence(out, data.data() + anchor, n - anchor, 0, 0);
+    return out;
+}
+
+bool Compressor::parse(const std::string& name, Compression& level)
+{
+    if (name == "fast")
+        level = COMPRESSION_FAST;
+    else if (name == "small")
+        level = COMPRESSION_SMALL;
+    else
+        return false;
+
+    return true;
+}
+
+// private
+
+size_t Compressor::findMatch(const std::vector<byte>& data, size_t __i,
+                             const std::vector<int64_t>& chain,
+                             int64_t candidate, uint depth, size_t& offset)
+{
+    size_t best = 0;
+    for (uint tries = 0; candidate >= 0 && tries < depth
+            && __i - candidate <= MAX_OFFSET; tries++) {
+        size_t length = 0;
+        while (__i + length < data.size()
+                && data[candidate + length] == data[__i + length])
+            length++;
+
+        if (length >= MIN_MATCH && length > best) {
+            best = length;
+            offset = __i - candidate;
+        }
+        candidate = chain[candidate];
+    }
+
+    return best;
+}
+
+void Compressor::pushSequence(std::vector<byte>& out, const byte *literals,
+                              size_t amount, size_t offset, size_t match)
+{
+    size_t extra = match ? match - MIN_MATCH : 0;
+    out.push_back((byte) ((std::min<size_t>(amount, 15) << 4)
+                          | std::min<size_t>(extra, 15)));
+    if (amount >= 15)
+        pushLength(out, amount - 15);
+    out.insert(out.end(), literals, literals + amount);
+
+    if (!match)
+        return;
+
+    out.push_back((byte) (offset & 0xff));
+    out.push_back((byte) (offset >> 8));
+    if (extra >= 15)
+        pushLength(out, extra - 15);
+}
+
+void Compressor::pushLength(std::vector<byte>& out, size_t length)
+{
+    for (; length >= 255; length -= 255)
+        out.push_back((byte) 255);
+    out.push_back((byte) length);
+}
+
+// Decompressor
+
+Decompressor::Decompressor(byte *__b, size_t __n)
+    : output(__b), capacity(__n) {}
+
+void Decompressor::feed(const byte *__b, size_t __n)
+{
+    size_t i = 0;
+    while (i < __n) {
+        unsigned char value;
+        switch (state) {
+            case STATE_TOKEN:
+                value = __b[i++];
+                literals = value >> 4;
+                match = value & 0x0f;
+                state = literals == 15 ? STATE_LITERAL_LENGTH
+                      : literals ? STATE_LITERALS : STATE_OFFSET_LOW;
+                break;
+
+            case STATE_LITERAL_LENGTH:
+                value = __b[i++];
+                literals += value;
+                if (value != 255)
+                    state = STATE_LITERALS;
+                break;
+
+            case STATE_LITERALS: {
+                size_t amount = std::min(literals, __n - i);
+                if (amount > capacity - position)
+                    throw ValidatorError::invalid_compression;
+                memcpy(output + position, __b + i, amount);
+                position += amount;
+                literals -= amount;
+                i += amount;
+                if (!literals)
+                    state = STATE_OFFSET_LOW;
+                break;
+            }
+
+            case STATE_OFFSET_LOW:
+                offset = (unsigned char) __b[i++];
+                state = STATE_OFFSET_HIGH;
+                break;
+
+            case STATE_OFFSET_HIGH:
+                offset |= (size_t) (unsigned char) __b[i++] << 8;
+                if (!offset || offset > position)
+                    throw ValidatorError::invalid_compression;
+                if (match == 15)
+                    state = STATE_MATCH_LENGTH;
+                else
+                    copyMatch();
+                break;
+
+            case STATE_MATCH_LENGTH:
+                value = __b[i++];
+                match += value;
+                if (value != 255)
+                    copyMatch();
+                break;
+        }
+    }
+}
+
+void Decompressor::finish()
+{
+    // The last sequence has no match, so the data ends where the offset
+    // of the next one would be
+    if (state != STATE_OFFSET_LOW || position != capacity)
+        throw ValidatorError::invalid_compression;
+}
+
+size_t Decompressor::written() const
+{
+    return position;
+}
+
+// private
+
+void Decompressor::copyMatch()
+{
+    size_t length = match + Compressor::MIN_MATCH;
+    if (length > capacity - position)
+        throw ValidatorError::invalid_compression;
+
+    // The match may overlap the bytes it produces, so it's copied one byte
+    // at a time
+    for (size_t k = 0; k < length; k++, position++)
+        output[position] = output[position - offset];
+
+    state = STATE_TOKEN;
+}
+
+} // salt
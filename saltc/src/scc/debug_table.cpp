@@ -0,0 +1,143 @@
+/**
+ * debug_table.h implementation
+ *
+ */
+#include "../../include/scc/debug_table.h"
+#include "../../include/scc/synthesizer.h"
+#include "../../include/scc/validator.h"
+
+namespace salt
+{
+
+std::vector<byte> DebugTable::make(const InstructionList& code,
+                                   const std::vector<std::string>& files)
+{
+    std::vector<byte> rows;
+    uint amount = 0;
+    DebugRow last = {0, SourcePosition()};
+
+    auto push = [](std::vector<byte>& to, const std::vector<byte>& bytes) {
+        to.insert(to.end(), bytes.begin(), bytes.end());
+    };
+
+    for (size_t i = 0; i < code.size(); i++) {
+        const SourcePosition& position = code[i].position;
+        if (!position.isKnown() || (amount && position == last.position))
+            continue;
+
+        bool file = position.file != last.position.file;
+        push(rows, Synthesizer::makeVarUint((i - last.index) << 1 | file));
+        if (file)
+            push(rows, Synthesizer::makeVarUint(position.file));
+        push(rows, Synthesizer::makeVarInt((int64_t) position.line
+                                           - last.position.line));
+        push(rows, Synthesizer::makeVarUint(position.column));
+
+        last = {(uint) i, position};
+        amount++;
+    }
+
+    if (!amount)
+        return {};
+
+    std::vector<byte> section;
+    size_t rows_start = HEADER_SIZE + files.size() * FILE_SIZE;
+    size_t names_start = rows_start + rows.size();
+    for (size_t value : {files.size(), (size_t) amount, rows_start,
+                         rows.size()})
+        push(section, Synthesizer::makeNum<uint32_t>(value));
+
+    std::vector<byte> names;
+    for (const std::string& file : files) {
+        push(section, Synthesizer::makeNum<uint32_t>(names_start
+                                                     + names.size()));
+        push(section, Synthesizer::makeNum<uint32_t>(file.size()));
+        names.insert(names.end(), file.begin(), file.end());
+    }
+
+    push(section, rows);
+    push(section, names);
+    return section;
+}
+
+bool DebugTable::find(const byte *__b, size_t __n, uint index,
+                      SourcePosition& position)
+{
+    uint rows;
+    BytecodeReader reader = openRows(__b, __n, rows);
+    DebugRow row = {0, SourcePosition()};
+    bool found = false;
+
+    for (uint i = 0; i < rows; i++) {
+        readRow(reader, row);
+        if (row.index > index)
+            break;
+        position = row.position;
+        found = true;
+    }
+
+    return found;
+}
+
+std::vector<DebugRow> DebugTable::readRows(const byte *__b, size_t __n)
+{
+    uint rows;
+    BytecodeReader reader = openRows(__b, __n, rows);
+    std::vector<DebugRow> result;
+    DebugRow row = {0, SourcePosition()};
+
+    for (uint i = 0; i < rows; i++) {
+        readRow(reader, row);
+        result.push_back(row);
+    }
+
+    return result;
+}
+
+std::vector<std::string> DebugTable::readFiles(const byte *__b, size_t __n)
+{
+    BytecodeReader reader(__b, __n, ENCODING_FIXED);
+    uint files = reader.readRaw<uint32_t>();
+    std::vector<std::string> result;
+
+    for (uint i = 0; i < files; i++) {
+        reader.seek(HEADER_SIZE + (size_t) i * FILE_SIZE);
+        uint offset = reader.readRaw<uint32_t>();
+        uint length = reader.readRaw<uint32_t>();
+
+        std::string name;
+        reader.seek(offset);
+        for (uint k = 0; k < length; k++)
+            name += reader.readByte();
+        result.push_back(name);
+    }
+
+    return result;
+}
+
+// private
+
+BytecodeReader DebugTable::openRows(const byte *__b, size_t __n, uint& rows)
+{
+    BytecodeReader header(__b, __n, ENCODING_FIXED);
+    header.seek(4);
+    rows = header.readRaw<uint32_t>();
+    uint offset = header.readRaw<uint32_t>();
+    uint size = header.readRaw<uint32_t>();
+
+    if (offset > __n || size > __n - offset)
+        throw ValidatorError::invalid_data_width;
+    return BytecodeReader(__b + offset, size, ENCODING_FIXED);
+}
+
+void DebugTable::readRow(BytecodeReader& reader, DebugRow& row)
+{
+    uint64_t delta = reader.readVarUint();
+    row.index += delta >> 1;
+    if (delta & 1)
+        row.position.file = reader.readVarUint();
+    row.position.line += reader.readVarInt();
+    row.position.column = reader.readVarUint();
+}
+
+} // salt
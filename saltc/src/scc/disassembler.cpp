@@ -0,0 +1,311 @@
+/**
+ * disassembler.h implementation
+ *
+ */
+#include "../../include/scc/disassembler.h"
+#include "../../include/scc/instruction_set.h"
+#include "../../include/scc/validator.h"
+#include "../../include/scc/image_writer.h"
+#include "../../include/scc/debug_table.h"
+#include "../../include/compiler_metadata.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace salt
+{
+
+Disassembler::Disassembler(const std::string& bytecode)
+    : bytecode(bytecode), encoding(ENCODING_FIXED) {}
+
+std::string Disassembler::render()
+{
+    if (bytecode.size() < 64)
+        throw ValidatorError::invalid_header;
+
+    BytecodeReader header(bytecode.data(), 64, ENCODING_FIXED);
+    header.seek(8);
+    uint16_t version = header.readRaw<uint16_t>();
+    uint flags = CompilerMetadata::getFlags(bytecode.data());
+    header.seek(16);
+    uint instructions = header.readRaw<uint>();
+    header.seek(24);
+    uint cstrings = header.readRaw<uint>();
+    header.seek(48);
+    uint sections = header.readRaw<uint>();
+    if (flags & CompilerMetadata::SCC_FLAG_SECTIONED)
+        cstrings = 0;
+
+    // Compressed sections are listed and then expanded like a loader would
+    if (flags & CompilerMetadata::SCC_FLAG_COMPRESSED) {
+        std::string listing;
+        char buf[128];
+        SectionTable table = SectionTable::read(bytecode, sections);
+        for (const Section& section : table.getSections()) {
+            if (!(section.flags & SectionTable::FLAG_COMPRESSED))
+                continue;
+            snprintf(buf, sizeof(buf), "      .compressed section %u, "
+                     "%lu -> %lu bytes\n", section.type,
+                     (unsigned long) section.size,
+                     (unsigned long) section.memory_size);
+            listing += buf;
+        }
+
+        std::string image = SectionTable::expand(bytecode, sections);
+        std::string expanded = Disassembler(image).render();
+        size_t line = expanded.find('\n') + 1;
+        return expanded.insert(line, listing);
+    }
+
+    if (flags & CompilerMetadata::SCC_FLAG_COMPACT)
+        encoding = ENCODING_COMPACT;
+    bool legacy = version <= CompilerMetadata::SCC_LEGACY_VERSION;
+
+    char buf[128];
+    snprintf(buf, sizeof(buf), "SCC version %hu%s, %u instructions, "
+             "%u const strings, %s encoding%s\n", version,
+             legacy ? " (legacy)" : "", instructions, cstrings,
+             encoding == ENCODING_COMPACT ? "compact" : "fixed",
+             flags & CompilerMetadata::SCC_FLAG_VERIFIED ? ", verified" : "");
+    std::string listing = buf;
+
+    size_t start = 64;
+    size_t end = bytecode.size();
+    if (flags & CompilerMetadata::SCC_FLAG_SECTIONED) {
+        SectionTable table = SectionTable::read(bytecode, sections);
+        const Section *code = table.find(SECTION_CODE);
+        if (!code)
+            throw ValidatorError::invalid_section;
+        listing += formatSections(table);
+        start = code->offset;
+        end = code->offset + code->size;
+    }
+
+    BytecodeReader reader(bytecode.data(), end, encoding);
+    reader.setLegacy(legacy);
+    reader.seek(start);
+
+    for (uint i = 0; i < cstrings; i++) {
+        snprintf(buf, sizeof(buf), "      .string  ");
+        listing += buf + formatString(reader.readString()) + "\n";
+        if (legacy && reader.readByte() != '\n')
+            throw ValidatorError::const_string_size;
+    }
+
+    for (uint i = 0; !reader.atEnd(); i++) {
+        snprintf(buf, sizeof(buf), "%04x  ", i);
+        listing += buf;
+
+        std::string label;
+        const InstructionInfo *info = reader.readInstruction(label);
+        if (!info) {
+            listing += "@" + label + "\n";
+            reader.endInstruction();
+            continue;
+        }
+
+        listing += "  " + std::string(info->name);
+        for (OperandType operand : info->operands)
+            listing += " " + formatOperand(reader, operand);
+        listing += "\n";
+
+        reader.endInstruction();
+    }
+
+    return listing;
+}
+
+// private
+
+std::string Disassembler::formatSections(const SectionTable& table)
+{
+    const char *names[] = {"?", "code", "constants", "labels", "imports",
+                           "debug", "functions", "offsets"};
+    char buf[128];
+    std::string listing;
+
+    for (const Section& section : table.getSections()) {
+        snprintf(buf, sizeof(buf), "      .section %-10s offset 0x%lx, "
+                 "%lu bytes\n", names[section.type],
+                 (unsigned long) section.offset,
+                 (unsigned long) section.size);
+        listing += buf;
+
+        if (section.type == SECTION_CODE)
+            continue;
+
+        const byte *data = bytecode.data() + section.offset;
+        if (section.type == SECTION_OFFSETS) {
+            BytecodeReader reader(data, section.size, ENCODING_FIXED);
+            snprintf(buf, sizeof(buf), "        %u instructions\n",
+                     reader.readRaw<uint32_t>());
+            listing += buf;
+            continue;
+        }
+
+        if (section.type == SECTION_DEBUG) {
+            std::vector<std::string> files = DebugTable::readFiles(
+                    data, section.size);
+            for (const DebugRow& row : DebugTable::readRows(data,
+                                                            section.size)) {
+                if (row.position.file >= files.size())
+                    throw ValidatorError::invalid_section;
+                snprintf(buf, sizeof(buf), "        %04x  ", row.index);
+                listing += buf + files[row.position.file] + ":"
+                         + std::to_string(row.position.line) + ":"
+                         + std::to_string(row.position.column) + "\n";
+            }
+            continue;
+        }
+
+        BytecodeReader reader(bytecode.data() + section.offset, section.size,
+                              ENCODING_FIXED);
+        uint count = reader.readRaw<uint32_t>();
+        reader.seek(ImageWriter::TABLE_HEADER_SIZE);
+
+        for (uint i = 0; i < count; i++) {
+            if (section.type == SECTION_FUNCTIONS) {
+                FunctionEntry entry = FunctionIndex::read(
+                        bytecode.data() + section.offset, section.size, i);
+                snprintf(buf, sizeof(buf), "        %04x  +0x%04x  %u bytes, "
+                         "%u args, %u registers, %u slots%s  ", entry.index,
+                         entry.offset, entry.length, entry.arity,
+                         entry.registers, entry.object_slots,
+                         entry.flags & FunctionIndex::FLAG_PUBLIC
+                         ? ", public" : "");
+                listing += buf + formatString(entry.name) + "\n";
+                continue;
+            }
+
+            if (section.type == SECTION_CONSTANTS) {
+                uint id = reader.readRaw<uint32_t>();
+                byte type = reader.readByte();
+                reader.seek(reader.tell() + 3);
+                uint64_t value = reader.readRaw<uint64_t>();
+                size_t next = reader.tell();
+
+                std::string text;
+                switch (type) {
+                    case Synthesizer::TYPE_INT:
+                        text = "int " + std::to_string((int64_t) value);
+                        break;
+                    case Synthesizer::TYPE_FLOAT: {
+                        float real;
+                        memcpy(&real, &value, sizeof(float));
+                        text = "float " + std::to_string(real);
+                        break;
+                    }
+                    case Synthesizer::TYPE_BOOL:
+                        text = value ? "bool true" : "bool false";
+                        break;
+                    case Synthesizer::TYPE_STRING: {
+                        reader.seek(value);
+                        uint length = reader.readRaw<uint32_t>();
+                        std::string data;
+                        for (uint k = 0; k < length; k++)
+                            data += reader.readByte();
+                        text = "string " + formatString(data);
+                        break;
+                    }
+                    default:
+                        text = "?";
+                }
+                reader.seek(next);
+
+                snprintf(buf, sizeof(buf), "        $%u  ", id);
+                listing += buf + text + "\n";
+                continue;
+            }
+
+            uint offset = reader.readRaw<uint32_t>();
+            uint length = reader.readRaw<uint32_t>();
+            std::string name = bytecode.substr(section.offset + offset,
+                                               length);
+            if (section.type == SECTION_IMPORTS) {
+                listing += "        " + formatString(name) + "\n";
+                continue;
+            }
+
+            uint code = reader.readRaw<uint32_t>();
+            uint index = reader.readRaw<uint32_t>();
+            snprintf(buf, sizeof(buf), "        %04x  +0x%04x  ", index,
+                     code);
+            listing += buf + formatString(name) + "\n";
+        }
+    }
+
+    return listing;
+}
+
+std::string Disassembler::formatOperand(BytecodeReader& reader,
+                                        OperandType type)
+{
+    switch (type) {
+        case OPERAND_ID:
+            return "$" + std::to_string(reader.readId());
+        case OPERAND_IMMEDIATE:
+            return std::to_string(reader.readImmediate());
+        case OPERAND_STRING:
+            return formatString(reader.readString());
+        case OPERAND_REGISTER:
+            return "r" + std::to_string((unsigned char) reader.readByte());
+        case OPERAND_LABELS:
+        case OPERAND_CASES:
+            return formatCases(reader.readOperand(type));
+        case OPERAND_OBJECT:
+            break;
+    }
+
+    std::string value = reader.readByte() ? "const " : "";
+    switch (reader.readByte()) {
+        case Synthesizer::TYPE_NULL:
+            return value + "null";
+        case Synthesizer::TYPE_INT:
+            return value + "int " + std::to_string(reader.readInt());
+        case Synthesizer::TYPE_FLOAT:
+            return value + "float " + std::to_string(reader.readFloat());
+        case Synthesizer::TYPE_BOOL:
+            return value + (reader.readByte() ? "bool true" : "bool false");
+        case Synthesizer::TYPE_STRING:
+            return value + "string " + formatString(reader.readString());
+        default:
+            return value + "?";
+    }
+}
+
+std::string Disassembler::formatCases(const Operand& operand)
+{
+    std::string result = "[";
+    for (size_t i = 0; i < operand.labels.size(); i++) {
+        if (i)
+            result += ", ";
+        if (operand.type == OPERAND_CASES)
+            result += std::to_string(operand.keys[i]) + ": ";
+        result += formatString(operand.labels[i]);
+    }
+
+    return result + "]";
+}
+
+std::string Disassembler::formatString(const std::string& value)
+{
+    std::string result = "\"";
+    char buf[8];
+    for (char c : value) {
+        if (c == '\n') {
+            result += "\\n";
+        } else if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (c < 0x20 || c == 0x7f) {
+            snprintf(buf, sizeof(buf), "\\x%02hhx", c);
+            result += buf;
+        } else {
+            result += c;
+        }
+    }
+
+    return result + "\"";
+}
+
+} // salt
@@ -0,0 +1,32 @@
+/**
+ * encoder.h implementation
+ *
+ */
+#include "../../include/scc/encoder.h"
+#include "../../include/scc/instruction_set.h"
+#include "../../include/scc/synthesizer.h"
+
+namespace salt
+{
+
+std::vector<byte> Encoder::encode(const Instruction& instruction)
+{
+    std::vector<byte> collector;
+
+    if (instruction.isLabel()) {
+        collector.push_back(InstructionSet::LABEL);
+        std::vector<byte> name = Synthesizer::makeString(instruction.name());
+        collector.insert(collector.end(), name.begin(), name.end());
+        return collector;
+    }
+
+    const InstructionInfo *info = InstructionSet::find(instruction.name());
+    collector.push_back(info->opcode);
+
+    std::vector<byte> payload = Synthesizer::makeOperands(
+            instruction.operands());
+    collector.insert(collector.end(), payload.begin(), payload.end());
+    return collector;
+}
+
+} // salt
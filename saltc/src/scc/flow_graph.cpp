@@ -0,0 +1,192 @@
+/**
+ * flow_graph.h implementation
+ */
+#include "../../include/scc/flow_graph.h"
+
+#include <algorithm>
+
+namespace salt
+{
+
+FlowGraph::FlowGraph(const InstructionList& body)
+    : edges(body.size() + 1)
+{
+    for (size_t i = 0; i < body.size(); i++) {
+        if (body[i].isLabel())
+            labels[body[i].name()] = i;
+    }
+
+    for (size_t i = 0; i < body.size(); i++) {
+        std::vector<size_t>& next = edges[i];
+        auto add = [&](size_t target) {
+            if (std::find(next.begin(), next.end(), target) == next.end())
+                next.push_back(target);
+        };
+
+        if (body[i].isLabel()) {
+            add(i + 1);
+            continue;
+        }
+
+        std::string name = body[i].name();
+        if (name == "RETRN" || name == "EXITE" || name == "KILLX") {
+            add(body.size());
+            continue;
+        }
+
+        bool conditional = name == "JMPFL" || name == "JMPNF"
+                || name == "CEQJF" || name == "CEQJN" || name == "CLTJF"
+                || name == "CLTJN";
+        bool jump = conditional || name == "JMPTO" || name == "JMPTB"
+                || name == "JMPBS";
+        if (!jump) {
+            add(i + 1);
+            continue;
+        }
+
+        // A label which isn't in the body is a tail call, which leaves it
+        for (const Operand& operand : body[i].operands()) {
+            std::vector<std::string> names = operand.labels;
+            if (operand.type == OPERAND_STRING)
+                names = {operand.text};
+            else if (operand.type != OPERAND_LABELS
+                    && operand.type != OPERAND_CASES)
+                continue;
+            for (const std::string& label : names)
+                add(find(label));
+        }
+        if (conditional)
+            add(i + 1);
+    }
+
+    reached = walk(0, body.size() + 1);
+}
+
+size_t FlowGraph::size() const
+{
+    return edges.size() - 1;
+}
+
+const std::vector<size_t>& FlowGraph::successors(size_t __i) const
+{
+    return edges[__i];
+}
+
+bool FlowGraph::leaves(size_t __i) const
+{
+    const std::vector<size_t>& next = edges[__i];
+    return __i < size()
+        && std::find(next.begin(), next.end(), size()) != next.end();
+}
+
+bool FlowGraph::reachable(size_t __i) const
+{
+    return reached[__i];
+}
+
+bool FlowGraph::dominates(size_t through, size_t to, size_t from) const
+{
+    if (through == to || through == from)
+        return true;
+    return !walk(from, through)[to];
+}
+
+size_t FlowGraph::find(const std::string& name) const
+{
+    auto found = labels.find(name);
+    return found == labels.end() ? size() : found->second;
+}
+
+void FlowGraph::liveness(const InstructionList& body, Liveness& may,
+                         Liveness& must, const std::set<uint>& ignored) const
+{
+    may.assign(body.size() + 1, std::set<uint>());
+    must.assign(body.size() + 1, std::set<uint>());
+
+    // Objects join the states where paths meet: any object on one of the
+    // paths may be alive, only objects on all of them surely are
+    std::vector<bool> seen(body.size() + 1, false);
+    std::vector<size_t> pending = {0};
+    seen[0] = true;
+
+    while (!pending.empty()) {
+        size_t i = pending.back();
+        pending.pop_back();
+        if (i == body.size())
+            continue;
+
+        std::set<uint> may_after = may[i], must_after = must[i];
+        apply(body[i], may_after, ignored);
+        apply(body[i], must_after, ignored);
+
+        for (size_t next : edges[i]) {
+            if (!seen[next]) {
+                may[next] = may_after;
+                must[next] = must_after;
+                seen[next] = true;
+                pending.push_back(next);
+                continue;
+            }
+
+            size_t may_size = may[next].size();
+            may[next].insert(may_after.begin(), may_after.end());
+            size_t removed = std::erase_if(must[next], [&](uint id) {
+                return !must_after.count(id);
+            });
+            if (removed || may[next].size() != may_size)
+                pending.push_back(next);
+        }
+    }
+}
+
+bool FlowGraph::creates(const std::string& instruction, size_t __i)
+{
+    return (instruction == "OBJMK" && __i == 0)
+        || (instruction == "RGPOP" && __i == 1);
+}
+
+bool FlowGraph::deletes(const std::string& instruction, size_t __i)
+{
+    return (instruction == "OBJDL" && __i == 0)
+        || (instruction == "RPUSH" && __i == 1);
+}
+
+void FlowGraph::apply(const Instruction& instruction, std::set<uint>& alive,
+                      const std::set<uint>& ignored)
+{
+    std::string name = instruction.name();
+    std::vector<Operand> operands = instruction.operands();
+    for (size_t i = 0; i < operands.size(); i++) {
+        uint id = (uint) operands[i].number;
+        if (operands[i].type != OPERAND_ID || ignored.count(id))
+            continue;
+        if (creates(name, i))
+            alive.insert(id);
+        else if (deletes(name, i))
+            alive.erase(id);
+    }
+}
+
+// private
+
+std::vector<bool> FlowGraph::walk(size_t from, size_t blocked) const
+{
+    std::vector<bool> seen(edges.size(), false);
+    std::vector<size_t> pending = {from};
+    seen[from] = true;
+
+    while (!pending.empty()) {
+        size_t i = pending.back();
+        pending.pop_back();
+        for (size_t next : edges[i]) {
+            if (next == blocked || seen[next])
+                continue;
+            seen[next] = true;
+            pending.push_back(next);
+        }
+    }
+
+    return seen;
+}
+
+} // salt
@@ -0,0 +1,138 @@
+/**
+ * function_index.h implementation
+ *
+ */
+#include "../../include/scc/function_index.h"
+#include "../../include/scc/bytecode_reader.h"
+#include "../../include/scc/image_writer.h"
+#include "../../include/scc/synthesizer.h"
+
+#include <algorithm>
+
+namespace salt
+{
+
+uint32_t FunctionIndex::hash(const std::string& name)
+{
+    uint32_t value = 2166136261u;
+    for (char c : name) {
+        value ^= (unsigned char) c;
+        value *= 16777619u;
+    }
+
+    return value;
+}
+
+FunctionEntry FunctionIndex::describe(const Function& function)
+{
+    FunctionEntry entry;
+    entry.hash = hash(function.name);
+    entry.name = function.name;
+    entry.flags = function.is_public ? FLAG_PUBLIC : 0;
+    entry.object_slots = function.object_slots;
+
+    bool arguments = true;
+    uint registers = 0;
+    for (const Instruction& instruction : function.body) {
+        std::string name = instruction.name();
+        arguments = arguments && !instruction.isLabel() && name == "RGPOP";
+        if (arguments)
+            entry.arity++;
+
+        if (instruction.isLabel() || (name != "RGPOP" && name != "RPUSH"
+                && name != "RDUMP"))
+            continue;
+        registers = std::max(registers,
+                             (uint) instruction.operands()[0].number + 1);
+    }
+    entry.registers = (byte) registers;
+
+    return entry;
+}
+
+std::vector<byte> FunctionIndex::make(std::vector<FunctionEntry> entries)
+{
+    std::sort(entries.begin(), entries.end(),
+              [](const FunctionEntry& a, const FunctionEntry& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.name < b.name;
+    });
+
+    std::vector<byte> section = Synthesizer::makeNum<uint32_t>(
+            entries.size());
+    section.resize(ImageWriter::TABLE_HEADER_SIZE, '\0');
+    std::vector<byte> names;
+    size_t names_start = ImageWriter::TABLE_HEADER_SIZE
+                       + entries.size() * ENTRY_SIZE;
+
+    auto push = [&section](std::vector<byte> bytes) {
+        section.insert(section.end(), bytes.begin(), bytes.end());
+    };
+
+    for (const FunctionEntry& entry : entries) {
+        push(Synthesizer::makeNum<uint32_t>(entry.hash));
+        push(Synthesizer::makeNum<uint32_t>(names_start + names.size()));
+        push(Synthesizer::makeNum<uint32_t>(entry.name.size()));
+        push(Synthesizer::makeNum<uint32_t>(entry.offset));
+        push(Synthesizer::makeNum<uint32_t>(entry.length));
+        push(Synthesizer::makeNum<uint32_t>(entry.index));
+        push({(byte) entry.arity, (byte) entry.registers, (byte) entry.flags,
+              '\0'});
+        push(Synthesizer::makeNum<uint32_t>(entry.object_slots));
+        names.insert(names.end(), entry.name.begin(), entry.name.end());
+    }
+
+    push(names);
+    return section;
+}
+
+bool FunctionIndex::find(const byte *__b, size_t __n, const std::string& name,
+                         FunctionEntry& entry)
+{
+    BytecodeReader reader(__b, __n, ENCODING_FIXED);
+    uint32_t wanted = hash(name);
+    uint low = 0;
+    uint high = reader.readRaw<uint32_t>();
+
+    while (low < high) {
+        uint middle = low + (high - low) / 2;
+        FunctionEntry found = read(__b, __n, middle);
+        if (found.hash == wanted && found.name == name) {
+            entry = found;
+            return true;
+        }
+
+        if (found.hash < wanted || (found.hash == wanted && found.name < name))
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return false;
+}
+
+FunctionEntry FunctionIndex::read(const byte *__b, size_t __n, uint i)
+{
+    BytecodeReader reader(__b, __n, ENCODING_FIXED);
+    reader.seek(ImageWriter::TABLE_HEADER_SIZE + (size_t) i * ENTRY_SIZE);
+
+    FunctionEntry entry;
+    entry.hash = reader.readRaw<uint32_t>();
+    uint32_t name = reader.readRaw<uint32_t>();
+    uint32_t length = reader.readRaw<uint32_t>();
+    entry.offset = reader.readRaw<uint32_t>();
+    entry.length = reader.readRaw<uint32_t>();
+    entry.index = reader.readRaw<uint32_t>();
+    entry.arity = reader.readByte();
+    entry.registers = reader.readByte();
+    entry.flags = reader.readByte();
+    reader.readByte();
+    entry.object_slots = reader.readRaw<uint32_t>();
+
+    reader.seek(name);
+    for (uint32_t k = 0; k < length; k++)
+        entry.name += reader.readByte();
+
+    return entry;
+}
+
+} // salt
@@ -0,0 +1,70 @@
+/**
+ * fuser.h implementation
+ *
+ */
+#include "../../include/scc/fuser.h"
+#include "../../include/scc/synthesizer.h"
+
+namespace salt
+{
+
+const std::vector<Fuser::Fusion> Fuser::FUSIONS = {
+    {"CXXLT", "JMPFL", "CLTJF"},
+    {"CXXLT", "JMPNF", "CLTJN"},
+    {"CXXEQ", "JMPFL", "CEQJF"},
+    {"CXXEQ", "JMPNF", "CEQJN"},
+    {"IVADD", "CXXLT", "IVALT"},
+    {"IVADD", "CXXEQ", "IVAEQ"},
+};
+
+Fuser::PairHistogram Fuser::histogram(const InstructionList& instructions)
+{
+    PairHistogram pairs;
+    accumulate(pairs, instructions);
+    return pairs;
+}
+
+void Fuser::accumulate(PairHistogram& __h,
+                       const InstructionList& instructions)
+{
+    for (size_t i = 1; i < instructions.size(); i++) {
+        const Instruction& first = instructions[i - 1];
+        const Instruction& second = instructions[i];
+        if (first.isLabel() || second.isLabel())
+            continue;
+        __h[{first.name(), second.name()}]++;
+    }
+}
+
+uint Fuser::fuse(InstructionList& instructions)
+{
+    uint fused = 0;
+
+    for (const Fusion& fusion : FUSIONS) {
+        InstructionList result;
+        result.reserve(instructions.size());
+
+        for (size_t i = 0; i < instructions.size(); i++) {
+            if (i + 1 < instructions.size()
+                    && !instructions[i].isLabel()
+                    && !instructions[i + 1].isLabel()
+                    && instructions[i].name() == fusion.first
+                    && instructions[i + 1].name() == fusion.second) {
+                result.push_back(Synthesizer::fuse(fusion.fused,
+                        instructions[i].payload(),
+                        instructions[i + 1].payload()));
+                result.back().position = instructions[i].position;
+                fused++;
+                i++;
+                continue;
+            }
+            result.push_back(instructions[i]);
+        }
+
+        instructions = result;
+    }
+
+    return fused;
+}
+
+} // salt
@@ -0,0 +1,179 @@
+/**
+ * image_reader.h implementation
+ *
+ */
+#include "../../include/scc/image_reader.h"
+#include "../../include/scc/bytecode_reader.h"
+#include "../../include/scc/debug_table.h"
+#include "../../include/scc/function_index.h"
+#include "../../include/scc/image_writer.h"
+#include "../../include/scc/section_table.h"
+#include "../../include/scc/synthesizer.h"
+#include "../../include/scc/validator.h"
+#include "../../include/compiler_metadata.h"
+
+#include <cstring>
+
+namespace salt
+{
+
+Module ImageReader::read(const std::string& bytecode, const std::string& name)
+{
+    if (bytecode.size() < 64)
+        throw ValidatorError::invalid_header;
+
+    BytecodeReader header(bytecode.data(), 64, ENCODING_FIXED);
+    header.seek(8);
+    uint16_t version = header.readRaw<uint16_t>();
+    uint flags = CompilerMetadata::getFlags(bytecode.data());
+    header.seek(24);
+    uint cstrings = header.readRaw<uint>();
+    header.seek(40);
+    uint slots = header.readRaw<uint>();
+    header.seek(48);
+    uint sections = header.readRaw<uint>();
+
+    if (version > Synthesizer::FORMAT)
+        throw ValidatorError::invalid_header;
+
+    Module module;
+    module.name = name;
+    module.object_slots = slots;
+
+    Encoding encoding = flags & CompilerMetadata::SCC_FLAG_COMPACT
+                      ? ENCODING_COMPACT : ENCODING_FIXED;
+    std::string image = flags & CompilerMetadata::SCC_FLAG_COMPRESSED
+                      ? SectionTable::expand(bytecode, sections) : bytecode;
+
+    size_t start = 64;
+    size_t end = image.size();
+    std::vector<DebugRow> rows;
+    std::vector<FunctionEntry> index;
+
+    if (flags & CompilerMetadata::SCC_FLAG_SECTIONED) {
+        SectionTable table = SectionTable::read(image, sections);
+        const Section *code = table.find(SECTION_CODE);
+        if (!code)
+            throw ValidatorError::invalid_section;
+        start = code->offset;
+        end = code->offset + code->size;
+        cstrings = 0;
+
+        for (const Section& section : table.getSections()) {
+            const byte *data = image.data() + section.offset;
+            if (section.type == SECTION_CONSTANTS) {
+                module.prelude = readConstants(data, section.size);
+            } else if (section.type == SECTION_DEBUG) {
+                rows = DebugTable::readRows(data, section.size);
+                module.files = DebugTable::readFiles(data, section.size);
+            } else if (section.type == SECTION_FUNCTIONS) {
+                BytecodeReader entries(data, section.size, ENCODING_FIXED);
+                uint count = entries.readRaw<uint32_t>();
+                for (uint i = 0; i < count; i++)
+                    index.push_back(FunctionIndex::read(data, section.size,
+                                                        i));
+            }
+        }
+    }
+
+    BytecodeReader reader(image.data(), end, encoding);
+    reader.setLegacy(version <= CompilerMetadata::SCC_LEGACY_VERSION);
+    reader.seek(start);
+
+    for (uint i = 0; i < cstrings; i++) {
+        reader.readString();
+        reader.endInstruction();
+    }
+
+    SourcePosition position;
+    size_t row = 0;
+    for (uint i = 0; !reader.atEnd(); i++) {
+        while (row < rows.size() && rows[row].index <= i)
+            position = rows[row++].position;
+
+        std::string label;
+        const InstructionInfo *info = reader.readInstruction(label);
+        if (!info && (label.empty() || label[0] != '#')) {
+            reader.endInstruction();
+            Function function;
+            function.name = label;
+            function.is_public = true;
+            module.functions.push_back(function);
+            continue;
+        }
+
+        std::vector<Operand> operands;
+        if (info) {
+            for (OperandType type : info->operands)
+                operands.push_back(reader.readOperand(type));
+        }
+        reader.endInstruction();
+
+        Instruction instruction(info
+                ? Synthesizer::assemble(info->name, operands)
+                : Synthesizer::label(label), position);
+        if (module.functions.empty())
+            module.prelude.push_back(instruction);
+        else
+            module.functions.back().body.push_back(instruction);
+    }
+
+    for (const FunctionEntry& entry : index) {
+        Function *function = module.findFunction(entry.name);
+        if (!function)
+            throw ValidatorError::invalid_section;
+        function->is_public = entry.flags & FunctionIndex::FLAG_PUBLIC;
+        function->object_slots = entry.object_slots;
+    }
+
+    return module;
+}
+
+// private
+
+InstructionList ImageReader::readConstants(const byte *__b, size_t __n)
+{
+    InstructionList constants;
+    BytecodeReader reader(__b, __n, ENCODING_FIXED);
+    uint count = reader.readRaw<uint32_t>();
+
+    for (uint i = 0; i < count; i++) {
+        reader.seek(ImageWriter::TABLE_HEADER_SIZE
+                    + (size_t) i * ImageWriter::CONSTANT_SIZE);
+        uint id = reader.readRaw<uint32_t>();
+        byte type = reader.readByte();
+        reader.seek(reader.tell() + 3);
+        uint64_t value = reader.readRaw<uint64_t>();
+
+        switch (type) {
+            case Synthesizer::TYPE_INT:
+                constants.push_back(Synthesizer::objectMake(id, true,
+                                    (int64_t) value));
+                break;
+            case Synthesizer::TYPE_FLOAT: {
+                float real;
+                memcpy(&real, &value, sizeof(real));
+                constants.push_back(Synthesizer::objectMake(id, true, real));
+                break;
+            }
+            case Synthesizer::TYPE_BOOL:
+                constants.push_back(Synthesizer::objectMake(id, true,
+                                    value != 0));
+                break;
+            case Synthesizer::TYPE_STRING: {
+                reader.seek(value);
+                std::string text;
+                for (uint k = reader.readRaw<uint32_t>(); k > 0; k--)
+                    text += reader.readByte();
+                constants.push_back(Synthesizer::objectMake(id, true, text));
+                break;
+            }
+            default:
+                throw ValidatorError::invalid_section;
+        }
+    }
+
+    return constants;
+}
+
+} // salt
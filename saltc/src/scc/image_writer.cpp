@@ -0,0 +1,256 @@
+/**
+ * image_writer.h implementation
+ *
+ */
+#include "../../include/scc/image_writer.h"
+#include "../../include/scc/encoder.h"
+#include "../../include/scc/synthesizer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace salt
+{
+
+ImageWriter::ImageWriter(const Module& module)
+    : module(module) {}
+
+void ImageWriter::setCompression(Compression compression)
+{
+    this->compression = compression;
+}
+
+std::vector<byte> ImageWriter::write(size_t __base)
+{
+    InstructionList rendered = module.render();
+    InstructionList code;
+    InstructionList constants;
+    for (size_t i = 0; i < rendered.size(); i++) {
+        if (i < module.prelude.size() && isConstant(rendered, i))
+            constants.push_back(rendered[i]);
+        else
+            code.push_back(rendered[i]);
+    }
+
+    table = SectionTable();
+    table.add(SECTION_CODE, makeCode(code));
+    if (!constants.empty())
+        table.add(SECTION_CONSTANTS, makeConstants(constants));
+    if (!labels.empty())
+        table.add(SECTION_LABELS, makeLabels());
+
+    std::vector<byte> imports = makeImports(code);
+    if (!imports.empty())
+        table.add(SECTION_IMPORTS, imports);
+
+    if (!module.functions.empty())
+        table.add(SECTION_FUNCTIONS, makeFunctions(code.size()));
+    if (!code.empty())
+        table.add(SECTION_OFFSETS, OffsetIndex::make(offsets, instructions));
+
+    std::vector<byte> debug = DebugTable::make(code, module.files);
+    if (!debug.empty())
+        table.add(SECTION_DEBUG, debug);
+
+    compressed = compression != COMPRESSION_NONE
+              && table.compress(compression);
+    memory_size = table.getMemorySize(__base);
+    return table.render(__base);
+}
+
+uint ImageWriter::getInstructionCount() const
+{
+    return instructions;
+}
+
+uint ImageWriter::getMaxWidth() const
+{
+    return max_width;
+}
+
+uint ImageWriter::getSectionCount() const
+{
+    return table.getSections().size();
+}
+
+bool ImageWriter::isCompressed() const
+{
+    return compressed;
+}
+
+size_t ImageWriter::getMemorySize() const
+{
+    return memory_size;
+}
+
+// private
+
+bool ImageWriter::isConstant(const InstructionList& instructions,
+                             size_t i) const
+{
+    if (instructions[i].name() != "OBJMK")
+        return false;
+
+    std::vector<Operand> operands = instructions[i].operands();
+    if (!operands[1].readonly
+            || operands[1].object_type == Synthesizer::TYPE_NULL)
+        return false;
+
+    // Anything else touching the object, even an OBJDL, keeps it in the
+    // code where it runs in order
+    uint id = (uint) operands[0].number;
+    for (size_t k = 0; k < instructions.size(); k++) {
+        if (k != i && !instructions[k].isLabel() && instructions[k].writes(id))
+            return false;
+    }
+
+    return true;
+}
+
+std::vector<byte> ImageWriter::makeCode(const InstructionList& code)
+{
+    std::vector<byte> section;
+    labels.clear();
+    offsets.clear();
+    max_width = 0;
+
+    for (const Instruction& instruction : code) {
+        offsets.push_back(section.size());
+        if (instruction.isLabel())
+            labels.push_back({instruction.name(), (uint) section.size(),
+                              (uint) (&instruction - code.data())});
+
+        std::vector<byte> encoded = Encoder::encode(instruction);
+        section.insert(section.end(), encoded.begin(), encoded.end());
+        max_width = std::max(max_width, (uint) encoded.size());
+    }
+
+    offsets.push_back(section.size());
+    instructions = code.size();
+    return section;
+}
+
+std::vector<byte> ImageWriter::makeConstants(const InstructionList& constants)
+{
+    std::vector<byte> section = makeTableHeader(constants.size());
+    std::vector<byte> data;
+    size_t data_start = TABLE_HEADER_SIZE + constants.size() * CONSTANT_SIZE;
+
+    auto push = [](std::vector<byte>& to, const std::vector<byte>& bytes) {
+        to.insert(to.end(), bytes.begin(), bytes.end());
+    };
+
+    for (const Instruction& constant : constants) {
+        std::vector<Operand> operands = constant.operands();
+        const Operand& object = operands[1];
+
+        uint64_t value = 0;
+        switch (object.object_type) {
+            case Synthesizer::TYPE_FLOAT:
+                memcpy(&value, &object.real, sizeof(float));
+                break;
+            case Synthesizer::TYPE_STRING: {
+                const std::string& text = object.text;
+                value = data_start + data.size();
+                push(data, Synthesizer::makeNum<uint32_t>(text.size()));
+                data.insert(data.end(), text.begin(), text.end());
+                data.resize(SectionTable::align(data.size(), 4), '\0');
+                break;
+            }
+            default:
+                value = (uint64_t) object.number;
+                break;
+        }
+
+        push(section, Synthesizer::makeNum<uint32_t>(operands[0].number));
+        section.push_back(object.object_type);
+        section.resize(section.size() + 3, '\0');
+        push(section, Synthesizer::makeNum<uint64_t>(value));
+    }
+
+    push(section, data);
+    return section;
+}
+
+std::vector<byte> ImageWriter::makeLabels()
+{
+    std::sort(labels.begin(), labels.end(),
+              [](const Label& a, const Label& b) { return a.name < b.name; });
+
+    std::vector<byte> section = makeTableHeader(labels.size());
+    std::vector<byte> names;
+    size_t names_start = TABLE_HEADER_SIZE + labels.size() * LABEL_SIZE;
+
+    for (const Label& label : labels) {
+        for (uint value : {(uint) (names_start + names.size()),
+                           (uint) label.name.size(), label.offset,
+                           label.index}) {
+            std::vector<byte> bytes = Synthesizer::makeNum<uint32_t>(value);
+            section.insert(section.end(), bytes.begin(), bytes.end());
+        }
+        names.insert(names.end(), label.name.begin(), label.name.end());
+    }
+
+    section.insert(section.end(), names.begin(), names.end());
+    return section;
+}
+
+std::vector<byte> ImageWriter::makeImports(const InstructionList& code)
+{
+    std::vector<std::string> imports;
+    for (const Instruction& instruction : code) {
+        if (instruction.isLabel() || instruction.name() != "EXTLD")
+            continue;
+        std::string name = instruction.operands()[0].text;
+        if (std::find(imports.begin(), imports.end(), name) == imports.end())
+            imports.push_back(name);
+    }
+
+    if (imports.empty())
+        return {};
+
+    std::vector<byte> section = makeTableHeader(imports.size());
+    std::vector<byte> names;
+    size_t names_start = TABLE_HEADER_SIZE + imports.size() * IMPORT_SIZE;
+
+    for (const std::string& name : imports) {
+        for (uint value : {(uint) (names_start + names.size()),
+                           (uint) name.size()}) {
+            std::vector<byte> bytes = Synthesizer::makeNum<uint32_t>(value);
+            section.insert(section.end(), bytes.begin(), bytes.end());
+        }
+        names.insert(names.end(), name.begin(), name.end());
+    }
+
+    section.insert(section.end(), names.begin(), names.end());
+    return section;
+}
+
+std::vector<byte> ImageWriter::makeFunctions(size_t __n)
+{
+    // The functions are the last thing in the code, in the module order
+    std::vector<FunctionEntry> entries;
+    size_t end = __n;
+    for (size_t k = module.functions.size(); k > 0; k--) {
+        const Function& function = module.functions[k - 1];
+        size_t start = end - function.body.size() - 1;
+
+        FunctionEntry entry = FunctionIndex::describe(function);
+        entry.index = start;
+        entry.offset = offsets[start];
+        entry.length = offsets[end] - offsets[start];
+        entries.push_back(entry);
+        end = start;
+    }
+
+    return FunctionIndex::make(entries);
+}
+
+std::vector<byte> ImageWriter::makeTableHeader(uint __n)
+{
+    std::vector<byte> header = Synthesizer::makeNum<uint32_t>(__n);
+    header.resize(TABLE_HEADER_SIZE, '\0');
+    return header;
+}
+
+} // salt
@@ -0,0 +1,232 @@
+/**
+ * inliner.h implementation
+ *
+ */
+#include "../../include/scc/inliner.h"
+#include "../../include/scc/flow_graph.h"
+#include "../../include/scc/synthesizer.h"
+#include "../../include/logging.h"
+
+namespace salt
+{
+
+Inliner::Inliner(Module& module)
+    : module(module) {}
+
+void Inliner::setMaxSize(uint size)
+{
+    max_size = size;
+}
+
+Inliner::Report Inliner::run()
+{
+    Report report;
+
+    // Fresh IDs for the inlined objects start after the highest used one
+    std::vector<const InstructionList *> lists = {&module.prelude};
+    for (Function& function : module.functions)
+        lists.push_back(&function.body);
+    for (const InstructionList *list : lists) {
+        for (const Instruction& instruction : *list) {
+            for (const Operand& operand : instruction.operands()) {
+                if (operand.type == OPERAND_ID && operand.number >= next_id)
+                    next_id = (uint) operand.number + 1;
+            }
+        }
+    }
+
+    // Each round expands one more level of nested helpers, the callees are
+    // copied as they were at the start of the round.
+    bool changed = true;
+    for (uint round = 0; changed && round < 4; round++) {
+        changed = false;
+
+        call_sites.clear();
+        for (Function& function : module.functions) {
+            for (Instruction& instruction : function.body) {
+                if (instruction.name() == "CALLF")
+                    call_sites[instruction.operands()[0].text]++;
+            }
+        }
+
+        std::vector<Function> callees = module.functions;
+        for (Function& function : module.functions) {
+            InstructionList body;
+            for (Instruction& instruction : function.body) {
+                const Function *callee = nullptr;
+                if (instruction.name() == "CALLF") {
+                    std::string name = instruction.operands()[0].text;
+                    for (const Function& candidate : callees) {
+                        if (candidate.name == name)
+                            callee = &candidate;
+                    }
+                }
+
+                if (!callee || callee->name == function.name
+                        || !isInlinable(*callee)) {
+                    body.push_back(instruction);
+                    continue;
+                }
+
+                InstructionList copy = expand(*callee);
+                report.bytes -= instruction.code.size();
+                for (Instruction& inlined : copy)
+                    report.bytes += inlined.code.size();
+                report.inlined.push_back(function.name + " <- "
+                                         + callee->name);
+                body.insert(body.end(), copy.begin(), copy.end());
+                changed = true;
+            }
+            function.body = body;
+        }
+    }
+
+    for (const std::string& inlined : report.inlined)
+        iprint("Inlined call %s", inlined.c_str());
+    if (!report.inlined.empty())
+        iprint("Inlined %zu calls, changing the size by %ld bytes",
+               report.inlined.size(), report.bytes);
+
+    return report;
+}
+
+// private
+
+bool Inliner::isInlinable(const Function& callee)
+{
+    if (callee.name == "main" || isRecursive(callee.name))
+        return false;
+
+    uint size = 0;
+    for (const Instruction& instruction : callee.body) {
+        if (!instruction.isLabel())
+            size++;
+    }
+    if (!callee.body.empty() && callee.body.back().name() == "RETRN")
+        size--;
+
+    // A private function with a single caller is removed after inlining,
+    // so it never makes the module bigger.
+    if (!callee.is_public && call_sites[callee.name] == 1)
+        return true;
+
+    return size <= max_size;
+}
+
+bool Inliner::isRecursive(const std::string& name)
+{
+    std::set<std::string> visited;
+    std::vector<std::string> pending;
+
+    Function *start = module.findFunction(name);
+    if (!start)
+        return false;
+    for (const std::string& callee : references(start->body))
+        pending.push_back(callee);
+
+    while (!pending.empty()) {
+        std::string current = pending.back();
+        pending.pop_back();
+        if (current == name)
+            return true;
+        if (visited.count(current))
+            continue;
+        visited.insert(current);
+
+        Function *function = module.findFunction(current);
+        if (!function)
+            continue;
+        for (const std::string& callee : references(function->body))
+            pending.push_back(callee);
+    }
+
+    return false;
+}
+
+InstructionList Inliner::expand(const Function& callee)
+{
+    std::string prefix = "#" + callee.name + "." + std::to_string(copies++);
+    std::string end = prefix + ".ret";
+    std::map<uint, uint> ids;
+
+    // Objects created in the function get new IDs, everything else (like
+    // module level objects) is shared with the caller. So are the objects
+    // the function may leave on the tape, which the caller reads by the
+    // ID it knows them by.
+    FlowGraph graph(callee.body);
+    FlowGraph::Liveness may, must;
+    graph.liveness(callee.body, may, must);
+    const std::set<uint>& left = may[callee.body.size()];
+
+    for (const Instruction& instruction : callee.body) {
+        std::string name = instruction.name();
+        std::vector<Operand> operands = instruction.operands();
+        for (size_t i = 0; i < operands.size(); i++) {
+            uint id = (uint) operands[i].number;
+            if (operands[i].type == OPERAND_ID && FlowGraph::creates(name, i)
+                    && !left.count(id) && !ids.count(id))
+                ids[id] = next_id++;
+        }
+    }
+
+    InstructionList copy;
+    bool jumps_to_end = false;
+    for (size_t i = 0; i < callee.body.size(); i++) {
+        const Instruction& instruction = callee.body[i];
+        std::string name = instruction.name();
+
+        if (instruction.isLabel()) {
+            copy.push_back(Instruction(Synthesizer::label(name[0] == '#'
+                    ? prefix + name : name), instruction.position));
+            continue;
+        }
+
+        if (name == "RETRN") {
+            if (i + 1 == callee.body.size())
+                continue;
+            copy.push_back(Instruction(Synthesizer::jumpTo(end),
+                                       instruction.position));
+            jumps_to_end = true;
+            continue;
+        }
+
+        std::vector<Operand> operands = instruction.operands();
+        for (Operand& operand : operands) {
+            if (operand.type == OPERAND_ID && ids.count(operand.number))
+                operand.number = ids[(uint) operand.number];
+            if (operand.type == OPERAND_STRING && !operand.text.empty()
+                    && operand.text[0] == '#')
+                operand.text = prefix + operand.text;
+            for (std::string& label : operand.labels) {
+                if (!label.empty() && label[0] == '#')
+                    label = prefix + label;
+            }
+        }
+        copy.push_back(operands.empty() ? instruction
+                : Instruction(Synthesizer::assemble(name, operands),
+                              instruction.position));
+    }
+
+    if (jumps_to_end)
+        copy.push_back(Synthesizer::label(end));
+
+    return copy;
+}
+
+std::set<std::string> Inliner::references(const InstructionList& body)
+{
+    std::set<std::string> names;
+    for (const Instruction& instruction : body) {
+        if (instruction.name() == "EXTLD" || instruction.name() == "CALLX")
+            continue;
+        for (const Operand& operand : instruction.operands()) {
+            if (operand.type == OPERAND_STRING
+                    && module.findFunction(operand.text))
+                names.insert(operand.text);
+        }
+    }
+
+    return names;
+}
+
+} // salt
@@ -0,0 +1,90 @@
+/**
+ * instruction.h implementation
+ *
+ */
+#include "../../include/scc/instruction.h"
+#include "../../include/scc/bytecode_reader.h"
+#include "../../include/scc/synthesizer.h"
+
+#include <set>
+
+namespace salt
+{
+
+SourcePosition::SourcePosition(const InStringPosition& position, uint file)
+    : file(file), line(position.line_idx + 1),
+      column(position.inline_idx + 1) {}
+
+bool SourcePosition::isKnown() const
+{
+    return line != 0;
+}
+
+Instruction::Instruction(std::vector<byte> code)
+    : code(code) {}
+
+Instruction::Instruction(std::vector<byte> code, SourcePosition position)
+    : code(code), position(position) {}
+
+std::string Instruction::name() const
+{
+    if (isLabel())
+        return std::string(code.begin() + 1, code.end() - 1);
+    return std::string(code.begin(), code.begin() + 5);
+}
+
+bool Instruction::isLabel() const
+{
+    return !code.empty() && code[0] == '@';
+}
+
+std::vector<byte> Instruction::payload() const
+{
+    if (isLabel() || code.size() < 6)
+        return std::vector<byte>();
+    return std::vector<byte>(code.begin() + 5, code.end() - 1);
+}
+
+std::vector<Operand> Instruction::operands() const
+{
+    std::vector<Operand> operands;
+    const InstructionInfo *info;
+    if (isLabel() || !(info = InstructionSet::find(name())))
+        return operands;
+
+    std::vector<byte> data = payload();
+    BytecodeReader reader(data.data(), data.size(),
+                          Synthesizer::getEncoding());
+    for (OperandType type : info->operands)
+        operands.push_back(reader.readOperand(type));
+
+    return operands;
+}
+
+bool Instruction::writes(uint id) const
+{
+    static const std::set<std::string> first = {
+        "OBJMK", "OBJDL", "IVADD", "IVSUB", "IXADD", "IXSUB", "IXMUL",
+        "IXDIV", "IVALT", "IVAEQ"
+    };
+
+    std::string mnemonic = name();
+    std::vector<Operand> decoded = operands();
+    if (mnemonic == "RGPOP" || mnemonic == "RPUSH")
+        return decoded[1].number == id;
+    if (first.count(mnemonic))
+        return decoded[0].number == id;
+    return false;
+}
+
+bool Instruction::uses(uint id) const
+{
+    for (const Operand& operand : operands()) {
+        if (operand.type == OPERAND_ID && operand.number == id)
+            return true;
+    }
+
+    return false;
+}
+
+} // salt
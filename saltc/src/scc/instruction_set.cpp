@@ -0,0 +1,74 @@
+/**
+ * instruction_set.h implementation
+ *
+ */
+#include "../../include/scc/instruction_set.h"
+
+#include <array>
+
+namespace salt
+{
+
+const std::vector<InstructionInfo> InstructionSet::INSTRUCTIONS = {
+    {0x01, "CALLF", {OPERAND_STRING}},
+    {0x02, "CALLX", {OPERAND_STRING, OPERAND_STRING}},
+    {0x03, "CEQJF", {OPERAND_ID, OPERAND_ID, OPERAND_STRING}},
+    {0x04, "CEQJN", {OPERAND_ID, OPERAND_ID, OPERAND_STRING}},
+    {0x05, "CLTJF", {OPERAND_ID, OPERAND_ID, OPERAND_STRING}},
+    {0x06, "CLTJN", {OPERAND_ID, OPERAND_ID, OPERAND_STRING}},
+    {0x07, "CXXEQ", {OPERAND_ID, OPERAND_ID}},
+    {0x08, "CXXLT", {OPERAND_ID, OPERAND_ID}},
+    {0x09, "EXITE", {}},
+    {0x0a, "EXTLD", {OPERAND_STRING}},
+    {0x0b, "IVADD", {OPERAND_ID, OPERAND_IMMEDIATE}},
+    {0x0c, "IVAEQ", {OPERAND_ID, OPERAND_IMMEDIATE, OPERAND_ID, OPERAND_ID}},
+    {0x0d, "IVALT", {OPERAND_ID, OPERAND_IMMEDIATE, OPERAND_ID, OPERAND_ID}},
+    {0x0e, "IVSUB", {OPERAND_ID, OPERAND_IMMEDIATE}},
+    {0x0f, "IXADD", {OPERAND_ID, OPERAND_ID}},
+    {0x10, "IXDIV", {OPERAND_ID, OPERAND_ID}},
+    {0x11, "IXMUL", {OPERAND_ID, OPERAND_ID}},
+    {0x12, "IXSUB", {OPERAND_ID, OPERAND_ID}},
+    {0x13, "JMPBS", {OPERAND_ID, OPERAND_STRING, OPERAND_CASES}},
+    {0x14, "JMPFL", {OPERAND_STRING}},
+    {0x15, "JMPNF", {OPERAND_STRING}},
+    {0x16, "JMPTB", {OPERAND_ID, OPERAND_IMMEDIATE, OPERAND_STRING,
+                     OPERAND_LABELS}},
+    {0x17, "JMPTO", {OPERAND_STRING}},
+    {0x18, "KILLX", {}},
+    {0x19, "MLMAP", {}},
+    {0x1a, "OBJDL", {OPERAND_ID}},
+    {0x1b, "OBJMK", {OPERAND_ID, OPERAND_OBJECT}},
+    {0x1c, "PASSL", {}},
+    {0x1d, "PRINT", {OPERAND_ID}},
+    {0x1e, "RDUMP", {OPERAND_REGISTER}},
+    {0x1f, "RETRN", {}},
+    {0x20, "RGPOP", {OPERAND_REGISTER, OPERAND_ID}},
+    {0x21, "RNULL", {}},
+    {0x22, "RPUSH", {OPERAND_REGISTER, OPERAND_ID}},
+    {0x23, "TRACE", {}},
+};
+
+const InstructionInfo *InstructionSet::find(const std::string& name)
+{
+    for (const InstructionInfo& info : INSTRUCTIONS) {
+        if (name == info.name)
+            return &info;
+    }
+
+    return nullptr;
+}
+
+const InstructionInfo *InstructionSet::find(byte opcode)
+{
+    static std::array<const InstructionInfo *, 256> opcodes = [] {
+        std::array<const InstructionInfo *, 256> table;
+        table.fill(nullptr);
+        for (const InstructionInfo& info : INSTRUCTIONS)
+            table[(unsigned char) info.opcode] = &info;
+        return table;
+    }();
+
+    return opcodes[(unsigned char) opcode];
+}
+
+} // salt
@@ -0,0 +1,285 @@
+/**
+ * jump_tables.h implementation
+ *
+ */
+#include "../../include/scc/jump_tables.h"
+#include "../../include/scc/synthesizer.h"
+#include "../../include/logging.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace salt
+{
+
+uint JumpTables::build(Module& module)
+{
+    std::map<uint, int64_t> globals;
+    for (const Instruction& instruction : module.prelude) {
+        if (instruction.name() != "OBJMK")
+            continue;
+        std::vector<Operand> operands = instruction.operands();
+        if (operands[1].readonly
+                && operands[1].object_type == Synthesizer::TYPE_INT)
+            globals[(uint) operands[0].number] = operands[1].number;
+    }
+
+    // A table only works on an int, so the compared object has to be
+    // one no matter which copy of it is on the tape. Arithmetic never
+    // changes the type of an int.
+    std::set<uint> ints;
+    std::set<uint> others;
+    auto collect = [&](const InstructionList& body) {
+        for (const Instruction& instruction : body) {
+            std::string name = instruction.name();
+            std::vector<Operand> operands = instruction.operands();
+            if (name == "OBJMK" && operands[1].object_type
+                                   == Synthesizer::TYPE_INT)
+                ints.insert((uint) operands[0].number);
+            else if (name == "OBJMK")
+                others.insert((uint) operands[0].number);
+            else if (name == "RGPOP")
+                others.insert((uint) operands[1].number);
+        }
+    };
+    collect(module.prelude);
+    for (const Function& function : module.functions)
+        collect(function.body);
+    for (uint id : others)
+        ints.erase(id);
+
+    uint tables = 0;
+    uint cases = 0;
+    for (Function& function : module.functions)
+        cases += build(function, globals, ints, tables);
+
+    if (tables)
+        iprint("Replaced %u compares with %u jump tables", cases, tables);
+    return tables;
+}
+
+// private
+
+uint JumpTables::build(Function& function,
+                       const std::map<uint, int64_t>& globals,
+                       const std::set<uint>& ints, uint& tables)
+{
+    InstructionList& body = function.body;
+
+    // Every write of each object, to find objects which are constant
+    std::map<uint, std::vector<size_t>> writes;
+    std::map<std::string, size_t> labels;
+    std::map<std::string, uint> references;
+    for (size_t i = 0; i < body.size(); i++) {
+        if (body[i].isLabel()) {
+            labels[body[i].name()] = i;
+            continue;
+        }
+        for (const Operand& operand : body[i].operands()) {
+            if (operand.type == OPERAND_ID
+                    && body[i].writes((uint) operand.number))
+                writes[(uint) operand.number].push_back(i);
+            if (operand.type == OPERAND_STRING)
+                references[operand.text]++;
+            for (const std::string& label : operand.labels)
+                references[label]++;
+        }
+    }
+
+    // Constants alive in the whole range [from, to] of the function
+    auto constants = [&](size_t from, size_t to) {
+        std::map<uint, int64_t> known;
+        for (auto& [id, value] : globals) {
+            if (!writes.count(id))
+                known[id] = value;
+        }
+        for (auto& [id, at] : writes) {
+            std::vector<Operand> operands = body[at[0]].operands();
+            if (body[at[0]].name() != "OBJMK" || !operands[1].readonly
+                    || operands[1].object_type != Synthesizer::TYPE_INT
+                    || at[0] >= from || at.size() > 2)
+                continue;
+            if (at.size() == 2 && (body[at[1]].name() != "OBJDL"
+                    || at[1] <= to))
+                continue;
+            known[id] = operands[1].number;
+        }
+        return known;
+    };
+
+    auto jumpsAway = [&](size_t i) {
+        std::string name = body[i].name();
+        return !body[i].isLabel() && (name == "JMPTO" || name == "RETRN"
+                || name == "EXITE" || name == "KILLX");
+    };
+
+    // Changes to make, by index in the body
+    std::map<size_t, InstructionList> replaced;
+    uint compares = 0;
+
+    for (size_t i = 0; i + 1 < body.size(); i++) {
+        if (replaced.count(i) || body[i].name() != "CXXEQ")
+            continue;
+
+        std::string next = body[i + 1].name();
+        std::string prefix = "#" + function.name + ".table"
+                           + std::to_string(tables);
+        std::vector<Case> cases;
+        std::set<int64_t> keys;
+        uint id = 0;
+        int64_t key;
+
+        auto add = [&](size_t at, const std::string& label) {
+            uint compared;
+            if (!matchCompare(body[at], constants(i, at), compared, key)
+                    || (!cases.empty() && compared != id)
+                    || !ints.count(compared)
+                    || key < std::numeric_limits<int>::min()
+                    || key > std::numeric_limits<int>::max())
+                return false;
+            id = compared;
+            // A repeated key can never match, the first case wins
+            if (keys.insert(key).second)
+                cases.push_back({key, label});
+            return true;
+        };
+
+        if (next == "JMPFL") {
+            // Dispatch block, the code after it is the default case
+            size_t j = i;
+            while (j + 1 < body.size() && !replaced.count(j)
+                    && body[j].name() == "CXXEQ"
+                    && body[j + 1].name() == "JMPFL"
+                    && add(j, body[j + 1].operands()[0].text))
+                j += 2;
+            if ((j - i) / 2 < MIN_CASES)
+                continue;
+
+            std::string fallback = prefix + ".default";
+            replaced[i] = makeTable(id, fallback, prefix + ".hole", cases,
+                                    body[i].position);
+            replaced[i].push_back(Instruction(Synthesizer::label(fallback),
+                                              body[i].position));
+            for (size_t k = i + 1; k < j; k++)
+                replaced[k] = {};
+            compares += (j - i) / 2;
+            tables++;
+            i = j - 1;
+            continue;
+        }
+
+        if (next != "JMPNF")
+            continue;
+
+        // If/elif chain, each next compare is only reachable by the JMPNF
+        // of the previous one, whose body jumps away at its end
+        std::vector<size_t> links = {i};
+        std::string fallback = body[i + 1].operands()[0].text;
+        if (!add(i, prefix + ".0"))
+            continue;
+
+        while (true) {
+            if (!labels.count(fallback) || references[fallback] != 1)
+                break;
+            size_t at = labels[fallback];
+            if (at <= links.back() + 1 || at + 2 >= body.size()
+                    || !jumpsAway(at - 1) || replaced.count(at)
+                    || body[at + 1].name() != "CXXEQ"
+                    || body[at + 2].name() != "JMPNF"
+                    || !add(at + 1, prefix + "." + std::to_string(
+                            links.size())))
+                break;
+            links.push_back(at + 1);
+            fallback = body[at + 2].operands()[0].text;
+        }
+        if (links.size() < MIN_CASES)
+            continue;
+
+        replaced[i] = makeTable(id, fallback, prefix + ".hole", cases,
+                                body[i].position);
+        replaced[i].push_back(Instruction(Synthesizer::label(prefix + ".0"),
+                                          body[i].position));
+        replaced[i + 1] = {};
+        for (size_t k = 1; k < links.size(); k++) {
+            // The old label is only used by the removed JMPNF
+            replaced[links[k] - 1] = {Instruction(Synthesizer::label(
+                    prefix + "." + std::to_string(k)),
+                    body[links[k]].position)};
+            replaced[links[k]] = {};
+            replaced[links[k] + 1] = {};
+        }
+        compares += links.size();
+        tables++;
+    }
+
+    if (replaced.empty())
+        return 0;
+
+    InstructionList result;
+    for (size_t i = 0; i < body.size(); i++) {
+        if (!replaced.count(i)) {
+            result.push_back(body[i]);
+            continue;
+        }
+        result.insert(result.end(), replaced[i].begin(), replaced[i].end());
+    }
+    body = result;
+
+    return compares;
+}
+
+bool JumpTables::matchCompare(const Instruction& instruction,
+                              const std::map<uint, int64_t>& constants,
+                              uint& id, int64_t& key)
+{
+    std::vector<Operand> operands = instruction.operands();
+    uint left = (uint) operands[0].number;
+    uint right = (uint) operands[1].number;
+
+    if (constants.count(left) == constants.count(right))
+        return false;
+
+    id = constants.count(left) ? right : left;
+    key = constants.at(constants.count(left) ? left : right);
+    return true;
+}
+
+InstructionList JumpTables::makeTable(uint id, const std::string& fallback,
+                                      const std::string& hole,
+                                      const std::vector<Case>& cases,
+                                      const SourcePosition& position)
+{
+    int64_t low = cases[0].key;
+    int64_t high = cases[0].key;
+    for (const Case& entry : cases) {
+        low = std::min(low, entry.key);
+        high = std::max(high, entry.key);
+    }
+
+    if (high - low + 1 <= (int64_t) (cases.size() * MAX_SLOTS_PER_CASE)) {
+        std::vector<std::string> labels(high - low + 1, hole);
+        for (const Case& entry : cases)
+            labels[entry.key - low] = entry.label;
+        InstructionList table = {Instruction(Synthesizer::jumpTable(id,
+                (int) low, fallback, labels), position)};
+        if (cases.size() == labels.size())
+            return table;
+
+        // The JMPTB sets the flag for every label of the list, but the
+        // compares would have cleared it. An int is never less than itself.
+        table.push_back(Instruction(Synthesizer::label(hole), position));
+        table.push_back(Instruction(Synthesizer::compareLess(id, id),
+                                    position));
+        table.push_back(Instruction(Synthesizer::jumpTo(fallback),
+                                    position));
+        return table;
+    }
+
+    std::vector<std::pair<int, std::string>> sorted;
+    for (const Case& entry : cases)
+        sorted.push_back({(int) entry.key, entry.label});
+    return {Instruction(Synthesizer::jumpSearch(id, fallback, sorted),
+                        position)};
+}
+
+} // salt
@@ -0,0 +1,274 @@
+/**
+ * linker.h implementation
+ *
+ */
+#include "../../include/scc/linker.h"
+#include "../../include/scc/synthesizer.h"
+#include "../../include/scc/tree_shaker.h"
+#include "../../include/logging.h"
+
+#include <tuple>
+
+namespace salt
+{
+
+Linker::Linker(std::vector<Module> modules)
+    : modules(modules) {}
+
+Module Linker::link()
+{
+    report = Report();
+    id_base.clear();
+    file_base.clear();
+    included.clear();
+    imports.clear();
+
+    Module linked;
+    if (modules.empty())
+        return linked;
+
+    // Only the main function is an entry point of a linked program
+    std::vector<Module *> shaken;
+    for (Module& module : modules)
+        shaken.push_back(&module);
+    TreeShaker shaker(shaken);
+    shaker.keepExports(false);
+    shaker.shake();
+
+    linked.name = modules[0].name;
+    for (const Module& module : modules) {
+        id_base[module.name] = linked.object_slots;
+        file_base[module.name] = linked.files.size();
+        linked.object_slots += module.object_slots;
+        linked.files.insert(linked.files.end(), module.files.begin(),
+                            module.files.end());
+    }
+
+    includePrelude(modules[0], linked.prelude);
+
+    for (const Module& module : modules) {
+        bool main = &module == &modules[0];
+        for (const Function& function : module.functions) {
+            Function relocated;
+            relocated.name = rename(module, function.name);
+            relocated.is_public = main && function.is_public;
+            relocated.object_slots = function.object_slots;
+
+            for (const Instruction& instruction : function.body) {
+                // A module loaded from a function is loaded before anything
+                // runs, as its prelude can't be run twice
+                if (!instruction.isLabel() && instruction.name() == "EXTLD") {
+                    Module *target
+                            = findModule(instruction.operands()[0].text);
+                    if (target) {
+                        if (!included.count(target->name))
+                            includePrelude(*target, linked.prelude);
+                        continue;
+                    }
+                }
+                relocated.body.push_back(relocate(module, instruction));
+            }
+
+            linked.functions.push_back(relocated);
+        }
+    }
+
+    // Modules which are only called into without an EXTLD still need their
+    // objects
+    for (const Module& module : modules) {
+        if (!included.count(module.name) && !module.functions.empty())
+            includePrelude(module, linked.prelude);
+    }
+
+    mergeConstants(linked);
+
+    for (const std::string& call : report.calls)
+        iprint("Linked call %s", call.c_str());
+    if (report.constants)
+        iprint("Merged %u equal constants", report.constants);
+
+    return linked;
+}
+
+const Linker::Report& Linker::getReport() const
+{
+    return report;
+}
+
+// private
+
+Module *Linker::findModule(const std::string& name)
+{
+    for (Module& module : modules) {
+        if (module.name == name)
+            return &module;
+    }
+
+    return nullptr;
+}
+
+std::string Linker::rename(const Module& module, const std::string& name) const
+{
+    if (&module == &modules[0])
+        return name;
+    if (!name.empty() && name[0] == '#')
+        return "#" + module.name + "." + name.substr(1);
+    return module.name + "." + name;
+}
+
+Instruction Linker::relocate(const Module& module, const Instruction& from)
+{
+    SourcePosition position = from.position;
+    if (position.isKnown())
+        position.file += file_base[module.name];
+
+    if (from.isLabel())
+        return Instruction(Synthesizer::label(rename(module, from.name())),
+                           position);
+
+    std::string name = from.name();
+    std::vector<Operand> operands = from.operands();
+
+    if (name == "CALLX") {
+        Module *callee = findModule(operands[0].text);
+        if (callee && callee->findFunction(operands[1].text)) {
+            report.calls.push_back(module.name + " -> " + callee->name + "."
+                                   + operands[1].text);
+            return Instruction(Synthesizer::callLocal(
+                    rename(*callee, operands[1].text)), position);
+        }
+        if (callee)
+            wprint("Function '%s' not found in module '%s', the call is "
+                   "left external", operands[1].text.c_str(),
+                   callee->name.c_str());
+        return Instruction(from.code, position);
+    }
+
+    for (Operand& operand : operands) {
+        switch (operand.type) {
+            case OPERAND_ID:
+                operand.number += id_base[module.name];
+                break;
+            case OPERAND_STRING:
+                if (name != "EXTLD")
+                    operand.text = rename(module, operand.text);
+                break;
+            case OPERAND_LABELS:
+            case OPERAND_CASES:
+                for (std::string& label : operand.labels)
+                    label = rename(module, label);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return Instruction(Synthesizer::assemble(name, operands), position);
+}
+
+void Linker::includePrelude(const Module& module, InstructionList& to)
+{
+    included.insert(module.name);
+
+    for (const Instruction& instruction : module.prelude) {
+        if (!instruction.isLabel() && instruction.name() == "EXTLD") {
+            std::string import = instruction.operands()[0].text;
+            Module *target = findModule(import);
+            if (target) {
+                if (!included.count(import))
+                    includePrelude(*target, to);
+                continue;
+            }
+
+            // Each external module is only loaded once
+            if (imports.count(import))
+                continue;
+            imports.insert(import);
+        }
+
+        to.push_back(relocate(module, instruction));
+    }
+}
+
+void Linker::mergeConstants(Module& linked)
+{
+    std::vector<InstructionList *> lists = {&linked.prelude};
+    for (Function& function : linked.functions)
+        lists.push_back(&function.body);
+
+    // Objects written by a single instruction, which is their OBJMK
+    std::map<uint, uint> writers;
+    for (InstructionList *list : lists) {
+        for (const Instruction& instruction : *list) {
+            if (instruction.isLabel())
+                continue;
+            std::set<uint> written;
+            for (const Operand& operand : instruction.operands()) {
+                if (operand.type == OPERAND_ID
+                        && instruction.writes((uint) operand.number))
+                    written.insert((uint) operand.number);
+            }
+            for (uint id : written)
+                writers[id]++;
+        }
+    }
+
+    typedef std::tuple<byte, int64_t, float, std::string> Value;
+    std::map<Value, uint> first;
+    std::map<uint, uint> merged;
+
+    InstructionList prelude;
+    for (const Instruction& instruction : linked.prelude) {
+        if (instruction.isLabel() || instruction.name() != "OBJMK") {
+            prelude.push_back(instruction);
+            continue;
+        }
+
+        std::vector<Operand> operands = instruction.operands();
+        const Operand& object = operands[1];
+        uint id = (uint) operands[0].number;
+        if (!object.readonly || object.object_type == Synthesizer::TYPE_NULL
+                || writers[id] != 1) {
+            prelude.push_back(instruction);
+            continue;
+        }
+
+        Value value = {object.object_type, object.number, object.real,
+                       object.text};
+        if (!first.count(value)) {
+            first[value] = id;
+            prelude.push_back(instruction);
+            continue;
+        }
+
+        merged[id] = first[value];
+        report.constants++;
+    }
+    linked.prelude = prelude;
+
+    if (merged.empty())
+        return;
+
+    for (InstructionList *list : lists) {
+        for (Instruction& instruction : *list) {
+            if (instruction.isLabel())
+                continue;
+
+            std::vector<Operand> operands = instruction.operands();
+            bool changed = false;
+            for (Operand& operand : operands) {
+                if (operand.type == OPERAND_ID
+                        && merged.count((uint) operand.number)) {
+                    operand.number = merged[(uint) operand.number];
+                    changed = true;
+                }
+            }
+
+            if (changed)
+                instruction = Instruction(Synthesizer::assemble(
+                        instruction.name(), operands), instruction.position);
+        }
+    }
+}
+
+} // salt
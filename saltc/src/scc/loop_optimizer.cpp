@@ -0,0 +1,431 @@
+/**
+ * loop_optimizer.h implementation
+ *
+ */
+#include "../../include/scc/loop_optimizer.h"
+#include "../../include/scc/flow_graph.h"
+#include "../../include/scc/synthesizer.h"
+#include "../../include/logging.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace salt
+{
+
+/* Arithmetic changing the object in the first operand, which can't fail
+   on an int object and a number. IXDIV is missing, it fails on zero */
+static const std::set<std::string> ARITHMETIC = {
+    "IVADD", "IVSUB", "IXADD", "IXSUB", "IXMUL"
+};
+
+LoopOptimizer::Report LoopOptimizer::optimize(Module& module)
+{
+    Report report;
+
+    // Numeric constants of the prelude, as long as no function deletes or
+    // creates them again
+    std::map<uint, Operand> globals;
+    for (const Instruction& instruction : module.prelude) {
+        if (instruction.name() != "OBJMK")
+            continue;
+        std::vector<Operand> operands = instruction.operands();
+        byte type = operands[1].object_type;
+        if (operands[1].readonly && (type == Synthesizer::TYPE_INT
+                                     || type == Synthesizer::TYPE_FLOAT))
+            globals[(uint) operands[0].number] = operands[1];
+    }
+    for (const Function& function : module.functions) {
+        for (const Instruction& instruction : function.body) {
+            std::erase_if(globals, [&](const auto& global) {
+                return instruction.writes(global.first);
+            });
+        }
+    }
+
+    for (Function& function : module.functions) {
+        InstructionList& body = function.body;
+        report.loops += findLoops(body).size();
+
+        // Every change moves instructions around, so the loops are found
+        // again after each one.
+        bool changed = true;
+        for (uint round = 0; changed && round < 256; round++) {
+            changed = false;
+            for (const Loop& loop : findLoops(body)) {
+                if (!isClosed(body, loop))
+                    continue;
+                if (hoist(body, loop, globals)) {
+                    report.hoisted++;
+                    changed = true;
+                    break;
+                }
+                if (reduce(body, loop, globals)) {
+                    report.reduced++;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (report.hoisted || report.reduced)
+        iprint("Optimized %u loops: hoisted %u invariant objects, reduced "
+               "%u multiplications", report.loops, report.hoisted,
+               report.reduced);
+
+    return report;
+}
+
+// private
+
+std::vector<LoopOptimizer::Loop> LoopOptimizer::findLoops(
+        const InstructionList& body)
+{
+    std::map<std::string, size_t> labels;
+    std::map<size_t, size_t> backs;
+
+    for (size_t i = 0; i < body.size(); i++) {
+        if (body[i].isLabel()) {
+            labels[body[i].name()] = i;
+            continue;
+        }
+
+        // A jump to a label we have already seen is a back jump, the last
+        // one is the end of the loop
+        std::string target = jumpTarget(body[i]);
+        if (!target.empty() && labels.count(target))
+            backs[labels[target]] = i;
+    }
+
+    std::vector<Loop> loops;
+    for (auto& [head, back] : backs) {
+        size_t end = back + 1;
+        while (end < body.size() && body[end].isLabel())
+            end++;
+        loops.push_back({head, back, end});
+    }
+
+    std::sort(loops.begin(), loops.end(), [](const Loop& a, const Loop& b) {
+        return a.back - a.head < b.back - b.head;
+    });
+    return loops;
+}
+
+bool LoopOptimizer::isClosed(const InstructionList& body, const Loop& loop)
+{
+    std::map<std::string, size_t> labels;
+    for (size_t i = 0; i < body.size(); i++) {
+        if (body[i].isLabel())
+            labels[body[i].name()] = i;
+    }
+
+    for (size_t i = 0; i < body.size(); i++) {
+        std::string name = body[i].name();
+        std::string target = jumpTarget(body[i]);
+        bool inside = i >= loop.head && i <= loop.back;
+
+        if (inside && (name == "RETRN" || name == "EXITE" || name == "KILLX"
+                || (name == "JMPTO" && target.empty())))
+            return false;
+        if (target.empty() || !labels.count(target))
+            continue;
+
+        size_t to = labels[target];
+        if (inside && (to < loop.head || to >= loop.end))
+            return false;
+        if (!inside && to >= loop.head && to <= loop.back)
+            return false;
+    }
+
+    return true;
+}
+
+bool LoopOptimizer::isNumber(const InstructionList& body, const Loop& loop,
+                             uint id, const std::map<uint, Operand>& globals,
+                             bool int_only)
+{
+    auto numeric = [&](byte type) {
+        return type == Synthesizer::TYPE_INT
+            || (!int_only && type == Synthesizer::TYPE_FLOAT);
+    };
+
+    auto global = globals.find(id);
+    if (global != globals.end())
+        return numeric(global->second.object_type);
+
+    // Every copy the function makes has to be a number, and one of them
+    // must be on the tape on every path into the loop. Arithmetic keeps
+    // the int an int.
+    for (const Instruction& instruction : body) {
+        std::string name = instruction.name();
+        std::vector<Operand> operands = instruction.operands();
+        for (size_t i = 0; i < operands.size(); i++) {
+            if (operands[i].type != OPERAND_ID || operands[i].number != id
+                    || !FlowGraph::creates(name, i))
+                continue;
+            if (name != "OBJMK" || !numeric(operands[1].object_type))
+                return false;
+        }
+    }
+
+    FlowGraph graph(body);
+    FlowGraph::Liveness may, must;
+    graph.liveness(body, may, must);
+    return must[loop.head].count(id);
+}
+
+bool LoopOptimizer::dominatesBack(const InstructionList& body,
+                                  const Loop& loop, size_t __i)
+{
+    return FlowGraph(body).dominates(__i, loop.back, loop.head);
+}
+
+bool LoopOptimizer::hoist(InstructionList& body, const Loop& loop,
+                          const std::map<uint, Operand>& globals)
+{
+    bool calls = false;
+    for (size_t i = loop.head; i <= loop.back; i++) {
+        std::string name = body[i].name();
+        calls |= name == "CALLF" || name == "CALLX";
+    }
+
+    auto invariant = [&](uint id) {
+        // A called function may change module level objects
+        if (calls)
+            return false;
+        for (size_t i = loop.head; i <= loop.back; i++) {
+            if (body[i].writes(id))
+                return false;
+        }
+        return true;
+    };
+
+    for (size_t p = loop.head + 1; p < loop.back; p++) {
+        if (body[p].isLabel() || body[p].name() != "OBJMK")
+            continue;
+        std::vector<Operand> make = body[p].operands();
+        uint id = (uint) make[0].number;
+
+        // Arithmetic on anything but a writable int fails, and failing
+        // before the loop would fail even when the loop runs zero times
+        bool writable = !make[1].readonly
+                && make[1].object_type == Synthesizer::TYPE_INT;
+
+        std::vector<size_t> chain = {p};
+        for (size_t q = p + 1; q < loop.back; q++) {
+            std::string name = body[q].name();
+            if (body[q].isLabel() || !ARITHMETIC.count(name))
+                break;
+            std::vector<Operand> operands = body[q].operands();
+            if (operands[0].number != id || !writable)
+                break;
+            if (name[1] == 'X' && (operands[1].number == id
+                    || !invariant((uint) operands[1].number)
+                    || !isNumber(body, loop, (uint) operands[1].number,
+                                 globals, false)))
+                break;
+            chain.push_back(q);
+        }
+
+        // The chain has no jumps, so running its first instruction means
+        // running all of it. Chains on a path which skips the back jump,
+        // like inside of an if, may never run.
+        if (!dominatesBack(body, loop, p))
+            continue;
+
+        // The object may only be changed by the chain and deleted once,
+        // and must not be used outside of its lifetime in the loop
+        long deleted = -1;
+        bool valid = true;
+        for (size_t i = loop.head; i <= loop.back && valid; i++) {
+            bool in_chain = i >= p && i <= chain.back();
+            if (in_chain)
+                continue;
+            if (deleted >= 0 && body[i].uses(id))
+                valid = false;
+            else if (body[i].name() == "OBJDL" && body[i].uses(id)
+                    && i > chain.back())
+                deleted = (long) i;
+            else if (body[i].writes(id) || (i < p && body[i].uses(id)))
+                valid = false;
+        }
+        if (!valid)
+            continue;
+
+        std::string label = body[loop.head].name();
+        moveOut(body, loop, chain, deleted, id);
+        dprint("Hoisted object $%u out of the loop at '%s'", id,
+               label.c_str());
+        return true;
+    }
+
+    return false;
+}
+
+bool LoopOptimizer::reduce(InstructionList& body, const Loop& loop,
+                           const std::map<uint, Operand>& globals)
+{
+    // A called function may change the counter
+    for (size_t i = loop.head; i <= loop.back; i++) {
+        std::string name = body[i].name();
+        if (name == "CALLF" || name == "CALLX")
+            return false;
+    }
+
+    // Constant ints available at the start of the loop
+    std::map<uint, int64_t> known;
+    for (const auto& [id, constant] : globals) {
+        if (constant.object_type == Synthesizer::TYPE_INT)
+            known[id] = constant.number;
+    }
+    for (size_t i = 0; i < loop.head; i++) {
+        std::vector<Operand> operands = body[i].operands();
+        std::string name = body[i].name();
+        for (const Operand& operand : operands) {
+            if (operand.type == OPERAND_ID
+                    && body[i].writes((uint) operand.number))
+                known.erase((uint) operand.number);
+        }
+        if (name == "OBJMK" && operands[1].readonly
+                && operands[1].object_type == Synthesizer::TYPE_INT)
+            known[(uint) operands[0].number] = operands[1].number;
+    }
+
+    std::set<std::string> exits;
+    for (size_t i = loop.back + 1; i < loop.end; i++)
+        exits.insert(body[i].name());
+
+    for (size_t p = loop.head + 1; p + 2 < loop.back; p++) {
+        if (body[p].isLabel() || body[p].name() != "OBJMK"
+                || body[p + 1].name() != "IXADD"
+                || body[p + 2].name() != "IXMUL")
+            continue;
+
+        std::vector<Operand> make = body[p].operands();
+        std::vector<Operand> add = body[p + 1].operands();
+        std::vector<Operand> mul = body[p + 2].operands();
+        uint j = (uint) make[0].number;
+        uint i = (uint) add[1].number;
+        uint k = (uint) mul[1].number;
+        if (make[1].object_type != Synthesizer::TYPE_INT || make[1].number
+                || make[1].readonly || add[0].number != j
+                || mul[0].number != j || i == j || k == j || k == i
+                || !known.count(k))
+            continue;
+
+        // The product is computed before the loop, so the counter must
+        // already be an int there, and the product must have been
+        // computed in every iteration
+        if (!isNumber(body, loop, i, globals, true)
+                || !dominatesBack(body, loop, p))
+            continue;
+
+        // A constant of the function has to be the only copy ever made,
+        // so it surely has the value found above
+        size_t copies = 0;
+        for (const Instruction& instruction : body)
+            copies += instruction.name() == "OBJMK" && instruction.writes(k);
+        if (!globals.count(k) && (copies != 1
+                || !isNumber(body, loop, k, globals, true)))
+            continue;
+
+        // The counter has to change only once, by a constant step, after
+        // the multiplication and with no jumps in between
+        long step_at = -1;
+        bool valid = true;
+        for (size_t u = loop.head; u <= loop.back && valid; u++) {
+            if (body[u].writes(k))
+                valid = false;
+            if (!body[u].writes(i))
+                continue;
+            if (step_at >= 0 || u < p || body[u].name() != "IVADD")
+                valid = false;
+            step_at = (long) u;
+        }
+        if (!valid || step_at < 0)
+            continue;
+        for (size_t u = p + 1; u <= (size_t) step_at && valid; u++) {
+            std::string target = jumpTarget(body[u]);
+            if (body[u].isLabel() || (!target.empty()
+                    && !exits.count(target)))
+                valid = false;
+        }
+
+        int64_t step = body[step_at].operands()[1].number * known[k];
+        if (!valid || step < std::numeric_limits<int>::min()
+                || step > std::numeric_limits<int>::max())
+            continue;
+
+        // The product may only be read between its creation and the step
+        long deleted = -1;
+        for (size_t u = loop.head; u <= loop.back && valid; u++) {
+            if (u >= p && u <= p + 2)
+                continue;
+            if (!body[u].uses(j))
+                continue;
+            if (body[u].name() == "OBJDL" && deleted < 0 && u > p)
+                deleted = (long) u;
+            else if (u < p || u > (size_t) step_at || deleted >= 0
+                     || body[u].writes(j))
+                valid = false;
+        }
+        if (!valid)
+            continue;
+
+        std::string label = body[loop.head].name();
+        Loop moved = loop;
+        body.insert(body.begin() + step_at + 1,
+                    Instruction(Synthesizer::intAdd(j, (int) step),
+                                body[p + 2].position));
+        moved.back++;
+        moved.end++;
+        if (deleted > step_at)
+            deleted++;
+
+        moveOut(body, moved, {p, p + 1, p + 2}, deleted, j);
+        dprint("Reduced $%u = $%u * $%u in the loop at '%s' to steps of %ld",
+               j, i, k, label.c_str(), (long) step);
+        return true;
+    }
+
+    return false;
+}
+
+std::string LoopOptimizer::jumpTarget(const Instruction& instruction)
+{
+    if (instruction.isLabel())
+        return "";
+    for (const Operand& operand : instruction.operands()) {
+        if (operand.type == OPERAND_STRING && !operand.text.empty()
+                && operand.text[0] == '#')
+            return operand.text;
+    }
+
+    return "";
+}
+
+void LoopOptimizer::moveOut(InstructionList& body, const Loop& loop,
+                            const std::vector<size_t>& indices,
+                            long removed_delete, uint id)
+{
+    InstructionList result(body.begin(), body.begin() + loop.head);
+    for (size_t i : indices)
+        result.push_back(body[i]);
+
+    for (size_t i = loop.head; i < loop.end; i++) {
+        if ((long) i == removed_delete || std::find(indices.begin(),
+                indices.end(), i) != indices.end())
+            continue;
+        result.push_back(body[i]);
+    }
+
+    if (removed_delete >= 0)
+        result.push_back(Instruction(Synthesizer::objectDelete(id),
+                                     body[removed_delete].position));
+    result.insert(result.end(), body.begin() + loop.end, body.end());
+
+    body = result;
+}
+
+} // salt
@@ -0,0 +1,33 @@
+/**
+ * module.h implementation
+ *
+ */
+#include "../../include/scc/module.h"
+#include "../../include/scc/synthesizer.h"
+
+namespace salt
+{
+
+Function *Module::findFunction(const std::string& name)
+{
+    for (Function& function : functions) {
+        if (function.name == name)
+            return &function;
+    }
+
+    return nullptr;
+}
+
+InstructionList Module::render() const
+{
+    InstructionList instructions = prelude;
+    for (const Function& function : functions) {
+        instructions.push_back(Synthesizer::label(function.name));
+        instructions.insert(instructions.end(), function.body.begin(),
+                            function.body.end());
+    }
+
+    return instructions;
+}
+
+} // salt
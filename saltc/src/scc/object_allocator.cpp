@@ -0,0 +1,175 @@
+/**
+ * object_allocator.h implementation
+ */
+#include "../../include/scc/object_allocator.h"
+#include "../../include/scc/synthesizer.h"
+#include "../../include/logging.h"
+
+namespace salt
+{
+
+void ObjectAllocator::compact(Module& module)
+{
+    // Every ID of the prelude is shared, the others only once a second
+    // function uses them
+    std::map<uint, const Function *> owner;
+    std::vector<uint> order;
+    auto visit = [&](const InstructionList& body, const Function *function) {
+        for (const Instruction& instruction : body) {
+            for (const Operand& operand : instruction.operands()) {
+                if (operand.type != OPERAND_ID)
+                    continue;
+                uint id = (uint) operand.number;
+                auto found = owner.find(id);
+                if (found == owner.end()) {
+                    owner[id] = function;
+                    order.push_back(id);
+                } else if (found->second != function) {
+                    found->second = nullptr;
+                }
+            }
+        }
+    };
+
+    visit(module.prelude, nullptr);
+    for (const Function& function : module.functions)
+        visit(function.body, &function);
+
+    std::map<uint, uint> shared;
+    std::set<uint> ignored;
+    for (uint id : order) {
+        if (!owner[id]) {
+            shared[id] = (uint) shared.size();
+            ignored.insert(id);
+        }
+    }
+
+    renumber(module.prelude, shared);
+
+    ObjectAllocator allocator(shared, ignored);
+    for (Function& function : module.functions) {
+        allocator.allocate(function);
+        dprint("Function '%s' uses %u object slots", function.name.c_str(),
+               function.object_slots);
+    }
+
+    module.object_slots = allocator.base;
+}
+
+// private
+
+ObjectAllocator::ObjectAllocator(const std::map<uint, uint>& shared,
+                                 const std::set<uint>& ignored)
+    : shared(shared), ignored(ignored), base((uint) shared.size()) {}
+
+void ObjectAllocator::allocate(Function& function)
+{
+    const InstructionList& body = function.body;
+    FlowGraph graph(body);
+    FlowGraph::Liveness may, must;
+    graph.liveness(body, may, must, ignored);
+
+    // Objects which have to keep their own ID, and the pairs of objects
+    // which may be alive at the same time
+    std::set<uint> own;
+    std::map<uint, std::set<uint>> conflicts;
+    std::vector<uint> order;
+    std::set<uint> seen;
+
+    auto conflict = [&](const std::set<uint>& alive) {
+        for (uint first : alive) {
+            for (uint second : alive) {
+                if (first != second)
+                    conflicts[first].insert(second);
+            }
+        }
+    };
+
+    for (size_t i = 0; i < body.size(); i++) {
+        std::string name = body[i].name();
+        std::vector<Operand> operands = body[i].operands();
+        for (size_t k = 0; k < operands.size(); k++) {
+            uint id = (uint) operands[k].number;
+            if (operands[k].type != OPERAND_ID || shared.count(id))
+                continue;
+            if (seen.insert(id).second)
+                order.push_back(id);
+            if (!graph.reachable(i))
+                continue;
+
+            // Creating the object again shadows the old one, and reading
+            // it where it may not exist reads whatever else is on the tape
+            // under its ID, so neither can be moved to another ID
+            if (FlowGraph::creates(name, k) ? may[i].count(id)
+                                           : !must[i].count(id))
+                own.insert(id);
+        }
+
+        if (!graph.reachable(i))
+            continue;
+        std::set<uint> after = may[i];
+        FlowGraph::apply(body[i], after, ignored);
+        conflict(may[i]);
+        conflict(after);
+    }
+
+    // Objects left on the tape for the caller
+    own.insert(may[body.size()].begin(), may[body.size()].end());
+
+    std::map<uint, uint> ids = shared;
+    std::vector<std::vector<uint>> members;
+    for (uint id : order) {
+        size_t color = members.size();
+        if (!own.count(id)) {
+            for (size_t c = 0; c < members.size(); c++) {
+                bool free = true;
+                for (uint other : members[c]) {
+                    if (own.count(other) || conflicts[id].count(other)) {
+                        free = false;
+                        break;
+                    }
+                }
+                if (free) {
+                    color = c;
+                    break;
+                }
+            }
+        }
+
+        if (color == members.size())
+            members.emplace_back();
+        members[color].push_back(id);
+        ids[id] = base + (uint) color;
+    }
+
+    renumber(function.body, ids);
+    base += (uint) members.size();
+    function.object_slots = (uint) members.size();
+}
+
+void ObjectAllocator::renumber(InstructionList& instructions,
+                               const std::map<uint, uint>& ids)
+{
+    for (Instruction& instruction : instructions) {
+        std::vector<Operand> operands = instruction.operands();
+        bool changed = false;
+
+        for (Operand& operand : operands) {
+            if (operand.type != OPERAND_ID)
+                continue;
+
+            uint id = ids.at((uint) operand.number);
+            if (id != operand.number) {
+                operand.number = id;
+                changed = true;
+            }
+        }
+
+        if (changed)
+            instruction = Instruction(
+                    Synthesizer::assemble(instruction.name(), operands),
+                    instruction.position);
+    }
+}
+
+} // salt
@@ -0,0 +1,35 @@
+/**
+ * offset_index.h implementation
+ *
+ */
+#include "../../include/scc/offset_index.h"
+#include "../../include/scc/bytecode_reader.h"
+#include "../../include/scc/image_writer.h"
+#include "../../include/scc/synthesizer.h"
+
+namespace salt
+{
+
+std::vector<byte> OffsetIndex::make(const std::vector<size_t>& offsets,
+                                    uint __n)
+{
+    std::vector<byte> section = Synthesizer::makeNum<uint32_t>(__n);
+    section.resize(ImageWriter::TABLE_HEADER_SIZE, '\0');
+    section.reserve(section.size() + (size_t) __n * ENTRY_SIZE);
+
+    for (uint i = 0; i < __n; i++) {
+        std::vector<byte> bytes = Synthesizer::makeNum<uint32_t>(offsets[i]);
+        section.insert(section.end(), bytes.begin(), bytes.end());
+    }
+
+    return section;
+}
+
+uint32_t OffsetIndex::find(const byte *__b, size_t __n, uint i)
+{
+    BytecodeReader reader(__b, __n, ENCODING_FIXED);
+    reader.seek(ImageWriter::TABLE_HEADER_SIZE + (size_t) i * ENTRY_SIZE);
+    return reader.readRaw<uint32_t>();
+}
+
+} // salt
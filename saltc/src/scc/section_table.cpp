@@ -0,0 +1,200 @@
+/**
+ * section_table.h implementation
+ *
+ */
+#include "../../include/scc/section_table.h"
+#include "../../include/scc/bytecode_reader.h"
+#include "../../include/scc/synthesizer.h"
+#include "../../include/scc/validator.h"
+#include "../../include/compiler_metadata.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace salt
+{
+
+void SectionTable::add(uint type, const std::vector<byte>& data)
+{
+    Section section;
+    section.type = type;
+    section.size = data.size();
+    section.memory_size = data.size();
+    section.data = data;
+    sections.push_back(section);
+}
+
+const Section *SectionTable::find(uint type) const
+{
+    for (const Section& section : sections) {
+        if (section.type == type)
+            return &section;
+    }
+
+    return nullptr;
+}
+
+const std::vector<Section>& SectionTable::getSections() const
+{
+    return sections;
+}
+
+std::vector<byte> SectionTable::render(size_t __base)
+{
+    size_t offset = __base + sections.size() * ENTRY_SIZE;
+    for (Section& section : sections) {
+        section.offset = align(offset, getAlignment(section));
+        section.size = section.data.size();
+        offset = section.offset + section.size;
+    }
+
+    std::vector<byte> collector;
+    auto push = [&collector](std::vector<byte> bytes) {
+        collector.insert(collector.end(), bytes.begin(), bytes.end());
+    };
+
+    for (Section& section : sections) {
+        push(Synthesizer::makeNum<uint32_t>(section.type));
+        push(Synthesizer::makeNum<uint32_t>(section.flags));
+        push(Synthesizer::makeNum<uint64_t>(section.offset));
+        push(Synthesizer::makeNum<uint64_t>(section.size));
+        push(Synthesizer::makeNum<uint64_t>(section.memory_size));
+    }
+
+    // The last section is not padded, nothing follows it
+    for (Section& section : sections) {
+        collector.resize(section.offset - __base, '\0');
+        push(section.data);
+    }
+
+    return collector;
+}
+
+bool SectionTable::compress(Compression level)
+{
+    bool compressed = false;
+    for (Section& section : sections) {
+        if (section.flags & FLAG_COMPRESSED)
+            continue;
+
+        std::vector<byte> data = Compressor::compress(section.data, level);
+        if (data.size() >= section.data.size())
+            continue;
+
+        section.memory_size = section.data.size();
+        section.data = data;
+        section.flags |= FLAG_COMPRESSED;
+        compressed = true;
+    }
+
+    return compressed;
+}
+
+size_t SectionTable::getMemorySize(size_t __base) const
+{
+    size_t size = __base + sections.size() * ENTRY_SIZE;
+    for (const Section& section : sections)
+        size = align(size, PAGE_SIZE) + section.memory_size;
+
+    return size;
+}
+
+SectionTable SectionTable::read(std::span<const byte> bytecode, uint count)
+{
+    return read(bytecode, count, bytecode.size());
+}
+
+SectionTable SectionTable::read(std::span<const byte> bytecode, uint count,
+                                uint64_t __n)
+{
+    SectionTable table;
+    BytecodeReader reader(bytecode.data(), bytecode.size(), ENCODING_FIXED);
+    reader.seek(64);
+
+    size_t end = 64 + (size_t) count * ENTRY_SIZE;
+    try {
+        for (uint i = 0; i < count; i++) {
+            Section section;
+            section.type = reader.readRaw<uint32_t>();
+            section.flags = reader.readRaw<uint32_t>();
+            section.offset = reader.readRaw<uint64_t>();
+            section.size = reader.readRaw<uint64_t>();
+            section.memory_size = reader.readRaw<uint64_t>();
+            table.sections.push_back(section);
+        }
+    } catch (ValidatorError) {
+        throw ValidatorError::invalid_section;
+    }
+
+    // Sections have to be aligned, in order and inside of the file
+    for (const Section& section : table.sections) {
+        if (section.type < SECTION_CODE || section.type > SECTION_OFFSETS
+                || section.offset % getAlignment(section)
+                || section.offset < end
+                || section.size > __n
+                || section.offset > __n - section.size)
+            throw ValidatorError::invalid_section;
+
+        // A compressed byte can't expand to more than 255 bytes
+        if (section.flags & ~FLAG_COMPRESSED
+                || (section.flags & FLAG_COMPRESSED
+                    ? section.memory_size / 255 > section.size
+                    : section.memory_size != section.size))
+            throw ValidatorError::invalid_section;
+        end = section.offset + section.size;
+    }
+
+    return table;
+}
+
+std::string SectionTable::expand(std::span<const byte> bytecode, uint count)
+{
+    SectionTable table = read(bytecode, count);
+    std::string image(table.getMemorySize(64), '\0');
+    memcpy(image.data(), bytecode.data(), 64);
+
+    uint flags;
+    memcpy(&flags, image.data() + 12, sizeof(flags));
+    flags &= ~CompilerMetadata::SCC_FLAG_COMPRESSED;
+    memcpy(image.data() + 12, &flags, sizeof(flags));
+
+    size_t entry = 64;
+    size_t offset = 64 + (size_t) count * ENTRY_SIZE;
+    for (const Section& section : table.sections) {
+        offset = align(offset, PAGE_SIZE);
+        uint64_t fields[] = {section.type | (uint64_t) (section.flags
+                             & ~FLAG_COMPRESSED) << 32, offset,
+                             section.memory_size, section.memory_size};
+        memcpy(image.data() + entry, fields, sizeof(fields));
+        entry += ENTRY_SIZE;
+
+        const byte *data = bytecode.data() + section.offset;
+        if (!(section.flags & FLAG_COMPRESSED)) {
+            memcpy(image.data() + offset, data, section.size);
+            offset += section.size;
+            continue;
+        }
+
+        Decompressor decompressor(image.data() + offset, section.memory_size);
+        for (size_t k = 0; k < section.size; k += STREAM_BLOCK)
+            decompressor.feed(data + k, std::min<size_t>(STREAM_BLOCK,
+                                                         section.size - k));
+        decompressor.finish();
+        offset += section.memory_size;
+    }
+
+    return image;
+}
+
+size_t SectionTable::getAlignment(const Section& section)
+{
+    // Compressed sections are never mapped, so they are packed tighter
+    return section.flags & FLAG_COMPRESSED ? 8 : PAGE_SIZE;
+}
+
+size_t SectionTable::align(size_t __n, size_t __a)
+{
+    return (__n + __a - 1) / __a * __a;
+}
+
+} // salt
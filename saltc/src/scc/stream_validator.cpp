@@ -0,0 +1,282 @@
+/**
+ * stream_validator.h implementation
+ *
+ */
+#include "../../include/scc/stream_validator.h"
+#include "../../include/scc/bytecode_reader.h"
+#include "../../include/scc/section_table.h"
+#include "../../include/scc/validator.h"
+#include "../../include/compiler_metadata.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace salt
+{
+
+void StreamValidator::feed(const byte *__b, size_t __n)
+{
+    while (__n) {
+        size_t used = 0;
+        switch (state) {
+            case STATE_HEADER:
+            case STATE_TABLE: {
+                size_t need = 64;
+                if (state == STATE_TABLE)
+                    need += (size_t) section_amount * SectionTable::ENTRY_SIZE;
+                used = std::min(__n, need - pending.size());
+                pending.insert(pending.end(), __b, __b + used);
+                if (pending.size() < need)
+                    break;
+                if (state == STATE_HEADER)
+                    loadHeader();
+                else
+                    loadTable();
+                break;
+            }
+
+            case STATE_PADDING:
+                used = std::min<uint64_t>(__n, code_start - position);
+                break;
+
+            case STATE_CONST_STRINGS:
+            case STATE_INSTRUCTIONS:
+                used = feedItems(__b, __n);
+                break;
+
+            case STATE_TRAILER:
+                used = __n;
+                break;
+        }
+
+        __b += used;
+        __n -= used;
+        position += used;
+
+        if (state == STATE_PADDING && position == code_start) {
+            state = STATE_INSTRUCTIONS;
+            items = instruction_amount;
+            advance(position);
+        }
+    }
+}
+
+void StreamValidator::finish()
+{
+    switch (state) {
+        case STATE_HEADER:
+        case STATE_TABLE:
+            throw ValidatorError::invalid_header;
+        case STATE_PADDING:
+            throw ValidatorError::invalid_section;
+        case STATE_CONST_STRINGS:
+        case STATE_INSTRUCTIONS:
+            checkItem(pending.data(), pending.size(), true);
+            throw ValidatorError::nonterminated_instruction;
+        case STATE_TRAILER:
+            break;
+    }
+
+    // The header holds the size of the file without compression
+    if (sectioned && (position < sections_end || position != file_size))
+        throw position < sections_end ? ValidatorError::invalid_section
+                                      : ValidatorError::invalid_header;
+}
+
+void StreamValidator::validate(std::istream& stream)
+{
+    byte block[BLOCK_SIZE];
+    while (stream) {
+        stream.read(block, BLOCK_SIZE);
+        feed(block, stream.gcount());
+    }
+    finish();
+}
+
+uint StreamValidator::getInstructionCount() const
+{
+    return instructions;
+}
+
+// private
+
+void StreamValidator::loadHeader()
+{
+    const std::array<byte, 6>& magic = CompilerMetadata::SCC_HEADER;
+    if (memcmp(pending.data(), magic.data(), magic.size()) != 0
+            || pending[6] || pending[7])
+        throw ValidatorError::invalid_header;
+
+    BytecodeReader header(pending.data(), 64, ENCODING_FIXED);
+    header.seek(8);
+    version = header.readRaw<uint16_t>();
+    uint flags = CompilerMetadata::getFlags(pending.data());
+    header.seek(16);
+    instruction_amount = header.readRaw<uint>();
+    header.seek(24);
+    file_size = header.readRaw<uint64_t>();
+    header.seek(32);
+    max_instruction_width = header.readRaw<uint>();
+    header.seek(48);
+    section_amount = header.readRaw<uint>();
+    uint page_size = header.readRaw<uint>();
+
+    if (version > Synthesizer::FORMAT)
+        throw ValidatorError::invalid_header;
+    if (max_instruction_width % 16 != 0)
+        throw ValidatorError::instruction_width_violation;
+    if (flags & CompilerMetadata::SCC_FLAG_COMPRESSED)
+        throw ValidatorError::invalid_compression;
+
+    encoding = flags & CompilerMetadata::SCC_FLAG_COMPACT
+             ? ENCODING_COMPACT : ENCODING_FIXED;
+    sectioned = flags & CompilerMetadata::SCC_FLAG_SECTIONED;
+
+    if (sectioned) {
+        // Each section type can only be used once, so the table is small
+        if (version <= CompilerMetadata::SCC_LEGACY_VERSION
+                || page_size != SectionTable::PAGE_SIZE)
+            throw ValidatorError::invalid_header;
+        if (section_amount > SECTION_OFFSETS)
+            throw ValidatorError::invalid_section;
+        state = STATE_TABLE;
+        return;
+    }
+
+    pending.clear();
+    // Flat files hold the amount of const strings instead of the size
+    state = STATE_CONST_STRINGS;
+    items = (uint) file_size;
+    advance(64);
+}
+
+void StreamValidator::loadTable()
+{
+    SectionTable table = SectionTable::read(pending, section_amount,
+                                            UINT64_MAX);
+    pending.clear();
+
+    const Section *code = table.find(SECTION_CODE);
+    if (!code)
+        throw ValidatorError::invalid_section;
+    for (const Section& section : table.getSections()) {
+        if (table.find(section.type) != &section)
+            throw ValidatorError::invalid_section;
+        sections_end = section.offset + section.size;
+    }
+
+    code_start = code->offset;
+    code_end = code->offset + code->size;
+    state = STATE_PADDING;
+}
+
+size_t StreamValidator::feedItems(const byte *__b, size_t __n)
+{
+    // The code of a sectioned file ends with its section, no matter what
+    // follows it
+    size_t available = __n;
+    bool last = false;
+    if (state == STATE_INSTRUCTIONS && code_end - position <= __n) {
+        available = code_end - position;
+        last = true;
+    }
+    if (!available)
+        throw ValidatorError::invalid_section;
+
+    if (pending.empty()) {
+        size_t width = checkItem(__b, available, last);
+        if (!width) {
+            pending.assign(__b, __b + available);
+            return available;
+        }
+        nextItem(position + width);
+        return width;
+    }
+
+    // Complete the item split between blocks, it's the only copy made
+    size_t split = pending.size();
+    pending.insert(pending.end(), __b, __b + available);
+    size_t width = checkItem(pending.data(), pending.size(), last);
+    if (!width)
+        return available;
+
+    pending.clear();
+    nextItem(position + width - split);
+    return width - split;
+}
+
+size_t StreamValidator::checkItem(const byte *__b, size_t __n, bool last)
+{
+    bool legacy = version <= CompilerMetadata::SCC_LEGACY_VERSION;
+    BytecodeReader reader(__b, __n, encoding);
+    reader.setLegacy(legacy);
+
+    size_t width;
+    try {
+        if (state == STATE_CONST_STRINGS)
+            reader.skipString();
+        else
+            reader.skipInstruction();
+        width = reader.tell();
+    } catch (ValidatorError e) {
+        if (e == ValidatorError::unknown_instruction)
+            throw e;
+        width = 0;
+    }
+
+    // Without the terminating newline the item is not complete yet
+    bool complete = width && (!legacy || width < __n);
+    if (!complete) {
+        if (last)
+            throw state == STATE_CONST_STRINGS
+                    ? ValidatorError::invalid_data_width
+                    : ValidatorError::nonterminated_instruction;
+        if (state == STATE_INSTRUCTIONS && __n >= max_instruction_width)
+            throw ValidatorError::instruction_width_violation;
+        return 0;
+    }
+
+    if (state == STATE_CONST_STRINGS) {
+        if (!legacy)
+            return width;
+        if (memchr(__b, '\n', width))
+            throw ValidatorError::newline_in_string;
+        if (__b[width] != '\n')
+            throw ValidatorError::const_string_size;
+        return width + 1;
+    }
+
+    if (width + 1 >= max_instruction_width)
+        throw ValidatorError::instruction_width_violation;
+    if (legacy && __b[width] != '\n')
+        throw ValidatorError::nonterminated_instruction;
+    return legacy ? width + 1 : width;
+}
+
+void StreamValidator::nextItem(uint64_t __n)
+{
+    if (state == STATE_INSTRUCTIONS)
+        instructions++;
+    items--;
+    advance(__n);
+}
+
+void StreamValidator::advance(uint64_t __n)
+{
+    if (items)
+        return;
+
+    if (state == STATE_CONST_STRINGS) {
+        state = STATE_INSTRUCTIONS;
+        items = instruction_amount;
+        advance(__n);
+        return;
+    }
+
+    // The code section has to hold exactly the instructions
+    if (sectioned && __n != code_end)
+        throw ValidatorError::invalid_section;
+    state = STATE_TRAILER;
+}
+
+} // salt
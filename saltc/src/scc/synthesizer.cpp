@@ -5,6 +5,8 @@
  */
 
 #include "../../include/scc/synthesizer.h"
+#include "../../include/scc/instruction.h"
+#include <algorithm>
 #include <vector>
 #include <iostream>
 
@@ -16,6 +18,50 @@ std::vector<byte> Synthesizer::callLocal(std::string function)
     return make("CALLF", makeString(function));
 }
 
+std::vector<byte> Synthesizer::compareEqual(uint left, uint right)
+{
+    std::vector<byte> collector;
+    pushBytes(collector, makeId(left));
+    pushBytes(collector, makeId(right));
+    return make("CXXEQ", collector);
+}
+
+std::vector<byte> Synthesizer::compareLess(uint left, uint right)
+{
+    std::vector<byte> collector;
+    pushBytes(collector, makeId(left));
+    pushBytes(collector, makeId(right));
+    return make("CXXLT", collector);
+}
+
+std::vector<byte> Synthesizer::compareEqualJumpFlag(uint left, uint right,
+                                                    std::string label)
+{
+    return fuse("CEQJF", Instruction(compareEqual(left, right)).payload(),
+                makeString(label));
+}
+
+std::vector<byte> Synthesizer::compareEqualJumpNotFlag(uint left, uint right,
+                                                       std::string label)
+{
+    return fuse("CEQJN", Instruction(compareEqual(left, right)).payload(),
+                makeString(label));
+}
+
+std::vector<byte> Synthesizer::compareLessJumpFlag(uint left, uint right,
+                                                   std::string label)
+{
+    return fuse("CLTJF", Instruction(compareLess(left, right)).payload(),
+                makeString(label));
+}
+
+std::vector<byte> Synthesizer::compareLessJumpNotFlag(uint left, uint right,
+                                                      std::string label)
+{
+    return fuse("CLTJN", Instruction(compareLess(left, right)).payload(),
+                makeString(label));
+}
+
 std::vector<byte> Synthesizer::exit()
 {
     return make("EXITE", std::vector<byte>());
@@ -26,25 +72,107 @@ std::vector<byte> Synthesizer::externalLoad(std::string module)
     return make("EXTLD", makeString(module));
 }
 
+std::vector<byte> Synthesizer::intAdd(uint id, int value)
+{
+    std::vector<byte> collector;
+    pushBytes(collector, makeId(id));
+    pushBytes(collector, makeImmediate(value));
+    return make("IVADD", collector);
+}
+
+std::vector<byte> Synthesizer::intAddCompareLess(uint id, int value,
+                                                 uint other)
+{
+    return fuse("IVALT", Instruction(intAdd(id, value)).payload(),
+                Instruction(compareLess(id, other)).payload());
+}
+
+std::vector<byte> Synthesizer::intAddCompareEqual(uint id, int value,
+                                                  uint other)
+{
+    return fuse("IVAEQ", Instruction(intAdd(id, value)).payload(),
+                Instruction(compareEqual(id, other)).payload());
+}
+
+std::vector<byte> Synthesizer::jumpFlag(std::string label)
+{
+    return make("JMPFL", makeString(label));
+}
+
+std::vector<byte> Synthesizer::jumpNotFlag(std::string label)
+{
+    return make("JMPNF", makeString(label));
+}
+
+std::vector<byte> Synthesizer::jumpTo(std::string label)
+{
+    return make("JMPTO", makeString(label));
+}
+
+std::vector<byte> Synthesizer::jumpTable(uint id, int base,
+                                         std::string fallback,
+                                         std::vector<std::string> labels)
+{
+    std::vector<byte> collector = makeId(id);
+    pushBytes(collector, makeImmediate(base));
+    pushBytes(collector, makeString(fallback));
+    pushBytes(collector, makeImmediate(labels.size()));
+    for (const std::string& label : labels)
+        pushBytes(collector, makeString(label));
+
+    return make("JMPTB", collector);
+}
+
+std::vector<byte> Synthesizer::jumpSearch(uint id, std::string fallback,
+        std::vector<std::pair<int, std::string>> cases)
+{
+    std::sort(cases.begin(), cases.end());
+
+    std::vector<byte> collector = makeId(id);
+    pushBytes(collector, makeString(fallback));
+    pushBytes(collector, makeImmediate(cases.size()));
+    for (const auto& [key, label] : cases) {
+        pushBytes(collector, makeImmediate(key));
+        pushBytes(collector, makeString(label));
+    }
+
+    return make("JMPBS", collector);
+}
+
 std::vector<byte> Synthesizer::kill()
 {
     return make("KILLX", std::vector<byte>());
 }
 
+std::vector<byte> Synthesizer::label(std::string name)
+{
+    std::vector<byte> collector;
+    collector.push_back('@');
+    pushBytes(collector, name);
+    collector.push_back('\n');
+    return collector;
+}
+
 std::vector<byte> Synthesizer::objectMake(uint id, bool readonly)
 {
     std::vector<byte> collector;
     pushObjectData(collector, id, readonly, false, TYPE_NULL,
                    std::vector<byte>());
-    return collector;
+    return make("OBJMK", collector);
 }
 
 std::vector<byte> Synthesizer::objectMake(uint id, bool readonly, int value)
+{
+    return objectMake(id, readonly, (int64_t) value);
+}
+
+std::vector<byte> Synthesizer::objectMake(uint id, bool readonly,
+                                          int64_t value)
 {
     std::vector<byte> collector;
     pushObjectData(collector, id, readonly, false, TYPE_INT,
-                   makeNum<int>(value));
-    return collector;
+                   makeInt(value));
+    return make("OBJMK", collector);
 }
 
 std::vector<byte> Synthesizer::objectMake(uint id, bool readonly, float value)
@@ -52,7 +180,7 @@ std::vector<byte> Synthesizer::objectMake(uint id, bool readonly, float value)
     std::vector<byte> collector;
     pushObjectData(collector, id, readonly, false, TYPE_FLOAT,
                    makeNum<float>(value));
-    return collector;
+    return make("OBJMK", collector);
 }
 
 std::vector<byte> Synthesizer::objectMake(uint id, bool readonly, bool value)
@@ -60,7 +188,7 @@ std::vector<byte> Synthesizer::objectMake(uint id, bool readonly, bool value)
     std::vector<byte> collector;
     pushObjectData(collector, id, readonly, false, TYPE_BOOL,
                    makeBool(value));
-    return collector;
+    return make("OBJMK", collector);
 }
 
 std::vector<byte> Synthesizer::objectMake(uint id, bool readonly,
@@ -69,12 +197,31 @@ std::vector<byte> Synthesizer::objectMake(uint id, bool readonly,
     std::vector<byte> collector;
     pushObjectData(collector, id, readonly, false, TYPE_STRING,
                    makeString(value));
-    return collector;
+    return make("OBJMK", collector);
 }
 
 std::vector<byte> Synthesizer::objectDelete(uint id)
 {
-    return make("OBJDL", makeNum<uint>(id));
+    return make("OBJDL", makeId(id));
+}
+
+std::vector<byte> Synthesizer::print(uint id)
+{
+    return make("PRINT", makeId(id));
+}
+
+std::vector<byte> Synthesizer::assemble(const std::string& instruction,
+                                        const std::vector<Operand>& operands)
+{
+    return make(instruction.c_str(), makeOperands(operands));
+}
+
+std::vector<byte> Synthesizer::fuse(const char instruction[6],
+                                    std::vector<byte> first,
+                                    std::vector<byte> second)
+{
+    pushBytes(first, second);
+    return make(instruction, first);
 }
 
 std::vector<byte> Synthesizer::return_()
@@ -82,17 +229,117 @@ std::vector<byte> Synthesizer::return_()
     return make("RETRN", std::vector<byte>());
 }
 
+void Synthesizer::setEncoding(Encoding encoding)
+{
+    Synthesizer::encoding = encoding;
+}
+
+Encoding Synthesizer::getEncoding()
+{
+    return encoding;
+}
+
 // private
 
-std::vector<byte> Synthesizer::makeString(std::string value)
+Encoding Synthesizer::encoding = ENCODING_FIXED;
+
+std::vector<byte> Synthesizer::makeId(uint id)
+{
+    if (encoding == ENCODING_COMPACT)
+        return makeVarUint(id);
+    return makeNum<uint>(id);
+}
+
+std::vector<byte> Synthesizer::makeImmediate(int value)
+{
+    if (encoding == ENCODING_COMPACT)
+        return makeVarInt(value);
+    return makeNum<int>(value);
+}
+
+std::vector<byte> Synthesizer::makeInt(int64_t value)
+{
+    if (encoding == ENCODING_COMPACT)
+        return makeVarInt(value);
+    return makeNum<int64_t>(value);
+}
+
+std::vector<byte> Synthesizer::makeVarUint(uint64_t value)
+{
+    std::vector<byte> collector;
+    do {
+        byte part = value & 0x7f;
+        value >>= 7;
+        if (value)
+            part |= 0x80;
+        collector.push_back(part);
+    } while (value);
+
+    return collector;
+}
+
+std::vector<byte> Synthesizer::makeVarInt(int64_t value)
+{
+    // Zigzag, so small negative numbers stay small too
+    return makeVarUint(((uint64_t) value << 1) ^ (uint64_t) (value >> 63));
+}
+
+std::vector<byte> Synthesizer::makeString(const std::string& value)
 {
     std::vector<byte> collector;
-    pushBytes(collector, makeNum<int>((int) value.size()));
-    value.replace(value.begin(), value.end(), '\n', '\x11');
+    if (encoding == ENCODING_COMPACT)
+        pushBytes(collector, makeVarUint(value.size()));
+    else
+        pushBytes(collector, makeNum<int>((int) value.size()));
     pushBytes(collector, value);
     return collector;
 }
 
+std::vector<byte> Synthesizer::makeOperands(
+        const std::vector<Operand>& operands)
+{
+    std::vector<byte> collector;
+    for (const Operand& operand : operands) {
+        switch (operand.type) {
+            case OPERAND_ID:
+                pushBytes(collector, makeId((uint) operand.number));
+                break;
+            case OPERAND_IMMEDIATE:
+                pushBytes(collector, makeImmediate((int) operand.number));
+                break;
+            case OPERAND_STRING:
+                pushBytes(collector, makeString(operand.text));
+                break;
+            case OPERAND_REGISTER:
+                collector.push_back((byte) operand.number);
+                break;
+            case OPERAND_OBJECT:
+                pushBytes(collector, makeBool(operand.readonly));
+                collector.push_back(operand.object_type);
+                if (operand.object_type == TYPE_INT)
+                    pushBytes(collector, makeInt(operand.number));
+                else if (operand.object_type == TYPE_FLOAT)
+                    pushBytes(collector, makeNum<float>(operand.real));
+                else if (operand.object_type == TYPE_BOOL)
+                    pushBytes(collector, makeBool(operand.number));
+                else if (operand.object_type == TYPE_STRING)
+                    pushBytes(collector, makeString(operand.text));
+                break;
+            case OPERAND_LABELS:
+            case OPERAND_CASES:
+                pushBytes(collector, makeImmediate(operand.labels.size()));
+                for (size_t i = 0; i < operand.labels.size(); i++) {
+                    if (operand.type == OPERAND_CASES)
+                        pushBytes(collector, makeImmediate(operand.keys[i]));
+                    pushBytes(collector, makeString(operand.labels[i]));
+                }
+                break;
+        }
+    }
+
+    return collector;
+}
+
 std::vector<byte> Synthesizer::makeBool(bool value)
 {
     std::vector<byte> collector;
@@ -136,7 +383,7 @@ void Synthesizer::pushObjectData(std::vector<byte>& collector, uint id,
 {
     // Don't look at that argument list please, look into my eyes and show
     // me a better way of doing this.
-    pushBytes(collector, makeNum<uint>(id));
+    pushBytes(collector, makeId(id));
     pushBytes(collector, makeBool(readonly));
     collector.push_back(type);
     pushBytes(collector, value);
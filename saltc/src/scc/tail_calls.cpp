@@ -0,0 +1,163 @@
+/**
+ * tail_calls.h implementation
+ *
+ */
+#include "../../include/scc/tail_calls.h"
+#include "../../include/scc/flow_graph.h"
+#include "../../include/scc/synthesizer.h"
+#include "../../include/logging.h"
+
+namespace salt
+{
+
+uint TailCalls::lower(Module& module)
+{
+    Footprints footprints = measure(module);
+    uint lowered = 0;
+    for (Function& function : module.functions)
+        lowered += lower(function, footprints);
+
+    if (lowered)
+        iprint("Replaced %u tail calls with jumps", lowered);
+    return lowered;
+}
+
+// private
+
+TailCalls::Footprints TailCalls::measure(const Module& module)
+{
+    Footprints footprints;
+
+    // The functions each function calls or jumps to, with the objects it
+    // surely has its own copy of at that point, so the callee sees those
+    // instead of the ones of our caller
+    std::map<std::string, std::vector<std::pair<std::string,
+                                                std::set<uint>>>> calls;
+
+    for (const Function& function : module.functions) {
+        const InstructionList& body = function.body;
+        std::set<uint>& touched = footprints.touched[function.name];
+        FlowGraph graph(body);
+        FlowGraph::Liveness may, must;
+        graph.liveness(body, may, must);
+
+        for (size_t i = 0; i < body.size(); i++) {
+            if (!graph.reachable(i) || body[i].isLabel())
+                continue;
+
+            std::string name = body[i].name();
+            if (name == "CALLX")
+                footprints.unknown.insert(function.name);
+
+            std::vector<Operand> operands = body[i].operands();
+            for (size_t k = 0; k < operands.size(); k++) {
+                const Operand& operand = operands[k];
+                uint id = (uint) operand.number;
+                if (operand.type == OPERAND_ID) {
+                    // Making a second copy can't be told apart from
+                    // making the first one by the sets
+                    if (FlowGraph::creates(name, k) ? may[i].count(id)
+                                                    : !must[i].count(id))
+                        touched.insert(id);
+                    continue;
+                }
+
+                std::vector<std::string> labels = operand.labels;
+                if (operand.type == OPERAND_STRING && name != "CALLX")
+                    labels = {operand.text};
+                for (const std::string& label : labels) {
+                    if (graph.find(label) != graph.size())
+                        continue;
+                    bool known = false;
+                    for (const Function& callee : module.functions)
+                        known |= callee.name == label;
+                    if (known)
+                        calls[function.name].push_back({label, must[i]});
+                    else
+                        footprints.unknown.insert(function.name);
+                }
+            }
+        }
+
+        // Objects left on the tape for the caller
+        touched.insert(may[body.size()].begin(), may[body.size()].end());
+    }
+
+    // Anything a callee touches and the caller has no copy of is touched
+    // by the caller too
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const auto& [caller, callees] : calls) {
+            std::set<uint>& touched = footprints.touched[caller];
+            for (const auto& [callee, own] : callees) {
+                if (footprints.unknown.count(callee)
+                        && footprints.unknown.insert(caller).second)
+                    changed = true;
+                for (uint id : footprints.touched[callee]) {
+                    if (!own.count(id) && touched.insert(id).second)
+                        changed = true;
+                }
+            }
+        }
+    }
+
+    return footprints;
+}
+
+uint TailCalls::lower(Function& function, const Footprints& footprints)
+{
+    InstructionList& body = function.body;
+    InstructionList result;
+    result.reserve(body.size());
+    uint lowered = 0;
+    uint recursive = 0;
+
+    for (size_t i = 0; i < body.size(); i++) {
+        if (body[i].name() != "CALLF") {
+            result.push_back(body[i]);
+            continue;
+        }
+
+        // Only object cleanup may happen between the call and the return,
+        // a label would mean something else jumps in between.
+        size_t ret = i + 1;
+        while (ret < body.size() && !body[ret].isLabel()
+                && body[ret].name() == "OBJDL")
+            ret++;
+        if (ret == body.size() || body[ret].isLabel()
+                || body[ret].name() != "RETRN") {
+            result.push_back(body[i]);
+            continue;
+        }
+
+        // The callee must not see the objects deleted after the call
+        std::string callee = body[i].operands()[0].text;
+        bool safe = footprints.touched.count(callee)
+                && !footprints.unknown.count(callee);
+        for (size_t k = i + 1; safe && k < ret; k++) {
+            uint id = (uint) body[k].operands()[0].number;
+            safe = !footprints.touched.at(callee).count(id);
+        }
+        if (!safe) {
+            result.push_back(body[i]);
+            continue;
+        }
+
+        result.insert(result.end(), body.begin() + i + 1, body.begin() + ret);
+        result.push_back(Instruction(Synthesizer::jumpTo(callee),
+                                     body[i].position));
+        if (callee == function.name)
+            recursive++;
+        lowered++;
+        i = ret;
+    }
+
+    if (lowered)
+        dprint("Function '%s': %u tail calls, %u of them self-recursive",
+               function.name.c_str(), lowered, recursive);
+
+    body = result;
+    return lowered;
+}
+
+} // salt
@@ -0,0 +1,177 @@
+/**
+ * tree_shaker.h implementation
+ *
+ */
+#include "../../include/scc/tree_shaker.h"
+#include "../../include/logging.h"
+
+namespace salt
+{
+
+TreeShaker::TreeShaker(std::vector<Module *> modules)
+    : modules(modules) {}
+
+void TreeShaker::keepExports(bool keep)
+{
+    keep_exports = keep;
+}
+
+TreeShaker::Report TreeShaker::shake()
+{
+    Report report;
+    if (modules.empty())
+        return report;
+
+    pending.push_back({modules[0], "main"});
+    for (Module *module : modules) {
+        visit(module, module->prelude);
+        if (!keep_exports)
+            continue;
+        for (Function& function : module->functions) {
+            if (function.is_public)
+                pending.push_back({module, function.name});
+        }
+    }
+
+    while (!pending.empty()) {
+        Node node = pending.back();
+        pending.pop_back();
+        if (reachable.count(node))
+            continue;
+
+        Function *function = node.first->findFunction(node.second);
+        if (!function)
+            continue;
+
+        reachable.insert(node);
+        visit(node.first, function->body);
+    }
+
+    for (Module *module : modules)
+        sweep(module, report);
+
+    for (const std::string& removed : report.removed)
+        iprint("Removed unused %s", removed.c_str());
+    if (!report.removed.empty())
+        iprint("Removing unused code saved %zu bytes", report.bytes);
+
+    return report;
+}
+
+// private
+
+Module *TreeShaker::findModule(const std::string& name)
+{
+    for (Module *module : modules) {
+        if (module->name == name)
+            return module;
+    }
+
+    return nullptr;
+}
+
+bool TreeShaker::isPure(const std::string& name)
+{
+    Module *module = findModule(name);
+    if (!module)
+        return false;
+
+    for (const Instruction& instruction : module->prelude) {
+        std::string call = instruction.name();
+        if (!instruction.isLabel() && call != "OBJMK" && call != "OBJDL"
+                && call != "PASSL")
+            return false;
+    }
+
+    return true;
+}
+
+void TreeShaker::visit(Module *module, const InstructionList& instructions)
+{
+    for (const Instruction& instruction : instructions) {
+        std::string name = instruction.name();
+        std::vector<Operand> operands = instruction.operands();
+
+        // Creating a readonly object or deleting it is not reading it
+        if ((name == "OBJMK" && operands[1].readonly) || name == "OBJDL")
+            continue;
+
+        if (name == "CALLX") {
+            used_imports.insert({module, operands[0].text});
+            Module *callee = findModule(operands[0].text);
+            if (callee)
+                pending.push_back({callee, operands[1].text});
+            continue;
+        }
+
+        for (const Operand& operand : operands) {
+            // Labels can be called or jumped to (tail calls), so every
+            // string naming a function counts as a reference
+            if (operand.type == OPERAND_STRING && name != "EXTLD"
+                    && module->findFunction(operand.text))
+                pending.push_back({module, operand.text});
+            if (operand.type == OPERAND_ID)
+                used_objects.insert({module, (uint) operand.number});
+        }
+    }
+}
+
+void TreeShaker::sweep(Module *module, Report& report)
+{
+    std::vector<Function> functions;
+    for (Function& function : module->functions) {
+        if (reachable.count({module, function.name})) {
+            functions.push_back(function);
+            continue;
+        }
+
+        report.removed.push_back("function '" + module->name + "."
+                                 + function.name + "'");
+        report.bytes += function.name.size() + 2;
+        for (Instruction& instruction : function.body)
+            report.bytes += instruction.code.size();
+    }
+    module->functions = functions;
+
+    // Readonly objects nobody reads, together with their OBJDL
+    std::set<uint> unused;
+    for (Instruction& instruction : module->prelude) {
+        if (instruction.name() != "OBJMK")
+            continue;
+        std::vector<Operand> operands = instruction.operands();
+        uint id = (uint) operands[0].number;
+        if (operands[1].readonly && !used_objects.count({module, id}))
+            unused.insert(id);
+    }
+
+    InstructionList prelude;
+    for (Instruction& instruction : module->prelude) {
+        std::string name = instruction.name();
+        std::vector<Operand> operands = instruction.operands();
+        bool remove = false;
+
+        if (name == "EXTLD" && !used_imports.count({module,
+                                                     operands[0].text})
+                && isPure(operands[0].text)) {
+            report.removed.push_back("import of '" + operands[0].text
+                                     + "' in '" + module->name + "'");
+            remove = true;
+        }
+        if (name == "OBJMK" && unused.count((uint) operands[0].number)) {
+            report.removed.push_back("constant $"
+                    + std::to_string(operands[0].number) + " in '"
+                    + module->name + "'");
+            remove = true;
+        }
+        if (name == "OBJDL" && unused.count((uint) operands[0].number))
+            remove = true;
+
+        if (remove)
+            report.bytes += instruction.code.size();
+        else
+            prelude.push_back(instruction);
+    }
+    module->prelude = prelude;
+}
+
+} // salt
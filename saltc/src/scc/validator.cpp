@@ -4,9 +4,16 @@
  * @author bellrise
  */
 #include "../../include/scc/validator.h"
+#include "../../include/scc/bytecode_reader.h"
+#include "../../include/scc/instruction_set.h"
+#include "../../include/scc/image_writer.h"
+#include "../../include/scc/debug_table.h"
+#include "../../include/compiler_metadata.h"
 #include <stdio.h>
 #include <string.h>
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 
 namespace salt
@@ -14,18 +21,8 @@ namespace salt
 
     // PUBLIC
 
-    Validator::Validator(std::string& bytecode)
-    {
-        this->bytecode = bytecode;
-    }
-
-    Validator::Validator(std::vector<byte>& bytecode)
-    {
-        std::string code;
-        for (byte& chr : bytecode)
-            code += chr;
-        Validator((std::string&) code);
-    }
+    Validator::Validator(std::span<const byte> bytecode)
+        : bytecode(bytecode) {}
 
     void Validator::setErrorCallback(void (*__callback)(int))
     {
@@ -33,6 +30,12 @@ namespace salt
         f_callback = __callback;
     }
 
+    void Validator::setThreads(uint threads)
+    {
+        this->threads = threads ? threads
+                      : std::max(1u, std::thread::hardware_concurrency());
+    }
+
     void Validator::validate()
     {
         try {
@@ -45,6 +48,12 @@ namespace salt
         }
     }
 
+    std::string Validator::takeExpanded()
+    {
+        bytecode = {};
+        return std::move(expanded);
+    }
+
     // PRIVATE
 
     void Validator::runValidation()
@@ -55,11 +64,16 @@ namespace salt
         if (max_instruction_width % 16 != 0)
             throw ValidatorError::instruction_width_violation;
 
-        uint pos = checkConstStrings();
-        checkInstructions(pos);
-
-        printf("Amount of instructions: %d\n", instruction_amount);
-        printf("Amount of const strings: %d\n", cstring_amount);
+        if (sectioned) {
+            if (compressed) {
+                expanded = SectionTable::expand(bytecode, section_amount);
+                bytecode = expanded;
+            }
+            checkInstructions(checkSections()->offset);
+        } else {
+            uint pos = checkConstStrings();
+            checkInstructions(pos);
+        }
     }
 
     uint Validator::checkConstStrings()
@@ -67,52 +81,302 @@ namespace salt
         uint cursor = 64;
         uint len;
 
-        std::string buf;
+        BytecodeReader reader(bytecode.data(), bytecode.size(), encoding);
 
         for (uint i = 0; i < cstring_amount; i++) {
-            len = getUint(cursor) + 4;
-        
-            buf = bytecode.substr(cursor, len);
-            if (buf.find('\n') != std::string::npos)
+            reader.seek(cursor);
+            reader.skipString();
+            len = reader.tell() - cursor;
+
+            // SCC4 strings are only length prefixed
+            if (!isLegacy()) {
+                cursor += len;
+                continue;
+            }
+
+            if (memchr(bytecode.data() + cursor, '\n', len))
                 throw ValidatorError::newline_in_string;
 
-            if (bytecode[cursor + len] != '\n')
+            if (cursor + len >= bytecode.size()
+                    || bytecode[cursor + len] != '\n')
                 throw ValidatorError::const_string_size;
-            
-            cursor += len + 1; 
+
+            cursor += len + 1;
         }
 
         return cursor;
     }
 
-    void Validator::checkMagic()
+    const Section *Validator::checkSections()
+    {
+        sections = SectionTable::read(bytecode, section_amount);
+
+        // The header holds the size of the file without compression
+        BytecodeReader header(bytecode.data(), 64, ENCODING_FIXED);
+        header.seek(24);
+        if (header.readRaw<uint64_t>() != bytecode.size())
+            throw ValidatorError::invalid_header;
+
+        const Section *code = sections.find(SECTION_CODE);
+        if (!code)
+            throw ValidatorError::invalid_section;
+        code_end = code->offset + code->size;
+
+        for (const Section& section : sections.getSections()) {
+            if (sections.find(section.type) != &section)
+                throw ValidatorError::invalid_section;
+
+            switch (section.type) {
+                case SECTION_CONSTANTS:
+                    checkTable(section, ImageWriter::CONSTANT_SIZE);
+                    break;
+                case SECTION_LABELS:
+                    checkTable(section, ImageWriter::LABEL_SIZE);
+                    break;
+                case SECTION_IMPORTS:
+                    checkTable(section, ImageWriter::IMPORT_SIZE);
+                    break;
+                case SECTION_FUNCTIONS:
+                    checkTable(section, FunctionIndex::ENTRY_SIZE);
+                    break;
+                case SECTION_DEBUG:
+                    checkDebug(section);
+                    break;
+                case SECTION_OFFSETS:
+                    checkOffsets(section);
+                    offsets = &section;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        return code;
+    }
+
+    void Validator::checkTable(const Section& section, uint entry_size)
+    {
+        BytecodeReader reader(bytecode.data() + section.offset, section.size,
+                              ENCODING_FIXED);
+        try {
+            uint count = reader.readRaw<uint32_t>();
+            reader.seek(ImageWriter::TABLE_HEADER_SIZE);
+            if (count > section.size / entry_size)
+                throw ValidatorError::invalid_section;
+
+            for (uint i = 0; i < count; i++) {
+                size_t entry = reader.tell();
+                uint64_t offset;
+                uint64_t length;
+
+                if (section.type == SECTION_CONSTANTS) {
+                    reader.readRaw<uint32_t>();
+                    byte type = reader.readByte();
+                    reader.seek(entry + 8);
+                    offset = reader.readRaw<uint64_t>();
+                    if (type > Synthesizer::TYPE_STRING)
+                        throw ValidatorError::invalid_section;
+                    if (type != Synthesizer::TYPE_STRING)
+                        continue;
+                    if (offset % 4 || section.size < 4
+                            || offset > section.size - 4)
+                        throw ValidatorError::invalid_section;
+                    reader.seek(offset);
+                    length = reader.readRaw<uint32_t>();
+                    offset += 4;
+                    reader.seek(entry + entry_size);
+                } else if (section.type == SECTION_FUNCTIONS) {
+                    FunctionEntry function = FunctionIndex::read(
+                            bytecode.data() + section.offset, section.size,
+                            i);
+                    const Section *code = sections.find(SECTION_CODE);
+                    if (function.hash != FunctionIndex::hash(function.name)
+                            || function.offset > code->size
+                            || function.length > code->size - function.offset
+                            || function.index >= instruction_amount)
+                        throw ValidatorError::invalid_section;
+                    reader.seek(entry + entry_size);
+                    continue;
+                } else {
+                    offset = reader.readRaw<uint32_t>();
+                    length = reader.readRaw<uint32_t>();
+                    if (section.type == SECTION_LABELS
+                            && (reader.readRaw<uint32_t>()
+                                >= sections.find(SECTION_CODE)->size
+                            || reader.readRaw<uint32_t>()
+                                >= instruction_amount))
+                        throw ValidatorError::invalid_section;
+                }
+
+                if (offset > section.size || length > section.size - offset)
+                    throw ValidatorError::invalid_section;
+            }
+        } catch (ValidatorError) {
+            throw ValidatorError::invalid_section;
+        }
+    }
+
+    void Validator::checkDebug(const Section& section)
+    {
+        const byte *data = bytecode.data() + section.offset;
+        try {
+            size_t files = DebugTable::readFiles(data, section.size).size();
+            std::vector<DebugRow> rows = DebugTable::readRows(data,
+                                                              section.size);
+            for (size_t i = 0; i < rows.size(); i++) {
+                if (rows[i].index >= instruction_amount
+                        || rows[i].position.file >= files
+                        || (i && rows[i].index <= rows[i - 1].index))
+                    throw ValidatorError::invalid_section;
+            }
+        } catch (ValidatorError) {
+            throw ValidatorError::invalid_section;
+        }
+    }
+
+    void Validator::checkOffsets(const Section& section)
     {
-        std::string top = bytecode.substr(0, 8);
+        BytecodeReader reader(bytecode.data() + section.offset, section.size,
+                              ENCODING_FIXED);
+        try {
+            if (reader.readRaw<uint32_t>() != instruction_amount
+                    || (section.size - ImageWriter::TABLE_HEADER_SIZE)
+                        / OffsetIndex::ENTRY_SIZE < instruction_amount)
+                throw ValidatorError::invalid_section;
+        } catch (ValidatorError) {
+            throw ValidatorError::invalid_section;
+        }
+    }
 
-        // wtf.. I can't use std::string operator== here
-        if (strncmp(MAGIC.c_str(), top.c_str(), 8) != 0)
+    void Validator::checkMagic()
+    {
+        // The magic contains a null byte, so it's compared as memory
+        if (memcmp(MAGIC.data(), bytecode.data(), 8) != 0)
             throw ValidatorError::invalid_header;
     }
 
-    void Validator::checkInstructions(uint __n)
+    void Validator::checkInstructions(size_t __n)
+    {
+        code_start = __n;
+        if (threads > 1 && sectioned && checkRanges(splitCode(__n)))
+            return;
+
+        BytecodeReader reader(bytecode.data(), bytecode.size(), encoding);
+        reader.setLegacy(isLegacy());
+        reader.seek(__n);
+        checkRange(reader, 0, instruction_amount);
+
+        // The code section has to hold exactly the instructions
+        if (sectioned && reader.tell() != code_end)
+            throw ValidatorError::invalid_section;
+    }
+
+    void Validator::checkRange(BytecodeReader& reader, uint first,
+                               uint amount) const
     {
-        std::string ins;
+        for (uint i = 0; i < amount; i++) {
+            if (offsets && OffsetIndex::find(bytecode.data() + offsets->offset,
+                                             offsets->size, first + i)
+                    != reader.tell() - code_start)
+                throw ValidatorError::invalid_section;
 
-        for (uint i = 0; i < instruction_amount; i++) {
-            ins = getInstruction(__n);
-            __n += ins.size() + 1;
+            size_t width = skipInstruction(reader);
 
-            // Just check if the compiler didn't do anything stupid...
-            if (ins.size() + 1 >= max_instruction_width)
+            // Older files leave the maximum width at zero
+            if (max_instruction_width && width + 1 >= max_instruction_width)
                 throw ValidatorError::instruction_width_violation;
-            
-            // If this checks, the compiler is very drunk so im just
-            // crashing at this point.
-            if (ins.size() < 5) {
-                std::cout << "what just happened\n";
-                exit(1);
+        }
+    }
+
+    std::vector<Validator::Range> Validator::splitCode(size_t __n) const
+    {
+        const Section *labels = sections.find(SECTION_LABELS);
+        if ((!offsets && !labels) || code_end - __n < PARALLEL_MIN_SIZE)
+            return {};
+
+        // Code offset and instruction index of every boundary. With the
+        // offset index any instruction is one, so the ranges come out even.
+        std::vector<std::pair<size_t, uint>> boundaries;
+        if (offsets) {
+            uint step = instruction_amount / (threads * 4) + 1;
+            for (uint i = step; i < instruction_amount; i += step) {
+                size_t offset = OffsetIndex::find(
+                        bytecode.data() + offsets->offset, offsets->size, i);
+                boundaries.push_back({__n + offset, i});
             }
+        } else {
+            BytecodeReader reader(bytecode.data() + labels->offset,
+                                  labels->size, ENCODING_FIXED);
+            uint count = reader.readRaw<uint32_t>();
+            for (uint i = 0; i < count; i++) {
+                reader.seek(ImageWriter::TABLE_HEADER_SIZE
+                            + (size_t) i * ImageWriter::LABEL_SIZE + 8);
+                size_t offset = reader.readRaw<uint32_t>();
+                boundaries.push_back({__n + offset,
+                                      reader.readRaw<uint32_t>()});
+            }
+        }
+        std::sort(boundaries.begin(), boundaries.end());
+
+        std::vector<Range> ranges;
+        size_t target = (code_end - __n) / (threads * 4) + 1;
+        size_t start = __n;
+        uint first = 0;
+        for (const auto& [offset, index] : boundaries) {
+            if (index < first)
+                return {};
+            if (offset - start < target || index == first)
+                continue;
+            ranges.push_back({start, offset, first, index - first});
+            start = offset;
+            first = index;
         }
+        ranges.push_back({start, code_end, first, instruction_amount - first});
+
+        return ranges;
+    }
+
+    bool Validator::checkRanges(const std::vector<Range>& ranges) const
+    {
+        if (ranges.size() < 2)
+            return false;
+
+        // The error of each range, or -1, and if it ended where it should
+        std::vector<int> errors(ranges.size(), -1);
+        std::vector<char> aligned(ranges.size(), false);
+        std::atomic<size_t> next = 0;
+
+        auto work = [&]() {
+            for (size_t i = next++; i < ranges.size(); i = next++) {
+                BytecodeReader reader(bytecode.data(), bytecode.size(),
+                                      encoding);
+                reader.setLegacy(isLegacy());
+                reader.seek(ranges[i].start);
+                try {
+                    checkRange(reader, ranges[i].first, ranges[i].amount);
+                    aligned[i] = reader.tell() == ranges[i].end;
+                } catch (ValidatorError e) {
+                    errors[i] = e;
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (uint k = 0; k < std::min<size_t>(threads, ranges.size()); k++)
+            pool.emplace_back(work);
+        for (std::thread& thread : pool)
+            thread.join();
+
+        // Each range only starts at a real boundary if the ranges before it
+        // ended there
+        for (size_t i = 0; i < ranges.size(); i++) {
+            if (errors[i] >= 0)
+                throw (ValidatorError) errors[i];
+            if (!aligned[i])
+                return false;
+        }
+
+        return true;
     }
 
     void Validator::loadHeader()
@@ -120,9 +384,31 @@ namespace salt
         if (bytecode.size() <= 64)
             throw ValidatorError::invalid_header;
 
+        version = getUint(8) & 0xffff;
+        if (version > Synthesizer::FORMAT)
+            throw ValidatorError::invalid_header;
+
         instruction_amount = getUint(16);
-        cstring_amount = getUint(24);
         max_instruction_width = getUint(32);
+
+        uint flags = CompilerMetadata::getFlags(bytecode.data());
+        if (flags & CompilerMetadata::SCC_FLAG_COMPACT)
+            encoding = ENCODING_COMPACT;
+        else
+            encoding = ENCODING_FIXED;
+
+        // Sections are new in SCC4, and have to fit the page size
+        sectioned = flags & CompilerMetadata::SCC_FLAG_SECTIONED;
+        compressed = flags & CompilerMetadata::SCC_FLAG_COMPRESSED;
+
+        // Sectioned files have no const strings, the field is the size of
+        // the expanded file instead
+        cstring_amount = sectioned ? 0 : getUint(24);
+        section_amount = getUint(48);
+        code_end = bytecode.size();
+        if ((compressed && !sectioned) || (sectioned && (isLegacy()
+                || getUint(52) != SectionTable::PAGE_SIZE)))
+            throw ValidatorError::invalid_header;
     }
 
     void Validator::printBytes(char *__b, uint __n)
@@ -146,17 +432,33 @@ namespace salt
     {
         if (__n + 4 >= bytecode.size())
             throw ValidatorError::invalid_data_width;
-            
-        return * (uint *) &bytecode.c_str()[__n];
+
+        uint value;
+        memcpy(&value, bytecode.data() + __n, sizeof(value));
+        return value;
     }
 
-    std::string Validator::getInstruction(uint __n)
+    size_t Validator::skipInstruction(BytecodeReader& reader) const
     {
-        int endl = bytecode.find('\n', __n);
-        if ((const size_t) endl == std::string::npos)
+        size_t start = reader.tell();
+        try {
+            reader.skipInstruction();
+        } catch (ValidatorError e) {
+            if (e == ValidatorError::unknown_instruction)
+                throw e;
             throw ValidatorError::nonterminated_instruction;
-        
-        return bytecode.substr(__n, endl - __n); 
+        }
+
+        // The newline is not a part of the legacy instruction
+        size_t end = reader.tell();
+        reader.endInstruction();
+
+        return end - start;
+    }
+
+    bool Validator::isLegacy() const
+    {
+        return version <= CompilerMetadata::SCC_LEGACY_VERSION;
     }
 
 } // salt
\ No newline at end of file
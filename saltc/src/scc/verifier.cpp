@@ -0,0 +1,345 @@
+/**
+ * verifier.h implementation
+ *
+ */
+#include "../../include/scc/verifier.h"
+#include "../../include/scc/synthesizer.h"
+#include "../../include/scc/validator.h"
+
+namespace salt
+{
+
+/* Any value an existing object can have */
+static const uint8_t ANY_TYPE = 0x3e;
+
+Verifier::Verifier(const Module& module)
+    : module(module) {}
+
+Verifier::Report Verifier::verify()
+{
+    report = Report();
+    prelude_calls.clear();
+
+    State globals = run(module.prelude, State(), false);
+    globals.registers.clear();
+    checkPreludeCalls(globals);
+    for (const Function& function : module.functions)
+        run(function.body, globals, true);
+
+    return report;
+}
+
+bool Verifier::isProven() const
+{
+    return report.unproven == 0;
+}
+
+// private
+
+bool Verifier::State::merge(const State& other)
+{
+    bool changed = false;
+    for (auto& [id, value] : objects) {
+        auto found = other.objects.find(id);
+        uint8_t joined = value | (found == other.objects.end()
+                                  ? (uint8_t) VALUE_ABSENT : found->second);
+        changed |= joined != value;
+        value = joined;
+    }
+    for (const auto& [id, value] : other.objects) {
+        if (!objects.count(id)) {
+            objects[id] = value | VALUE_ABSENT;
+            changed = true;
+        }
+    }
+
+    for (uint id : other.touched)
+        changed |= touched.insert(id).second;
+
+    for (auto it = registers.begin(); it != registers.end();) {
+        auto found = other.registers.find(it->first);
+        if (found == other.registers.end()) {
+            it = registers.erase(it);
+            changed = true;
+            continue;
+        }
+        uint8_t joined = it->second | found->second;
+        changed |= joined != it->second;
+        it->second = joined;
+        ++it;
+    }
+
+    return changed;
+}
+
+Verifier::State Verifier::run(const InstructionList& body,
+                              const State& entry, bool function)
+{
+    labels.clear();
+    for (size_t i = 0; i < body.size(); i++) {
+        if (body[i].isLabel())
+            labels[body[i].name()] = i;
+    }
+    body_entry = entry;
+    in_function = function;
+
+    // The state at each instruction, the last one is the end of the body
+    std::vector<State> states(body.size() + 1);
+    std::vector<bool> reached(body.size() + 1, false);
+    std::vector<size_t> pending = {0};
+    states[0] = entry;
+    reached[0] = true;
+
+    auto flow = [&](size_t target, const State& state) {
+        if (!reached[target]) {
+            states[target] = state;
+            reached[target] = true;
+            pending.push_back(target);
+        } else if (states[target].merge(state)) {
+            pending.push_back(target);
+        }
+    };
+
+    while (!pending.empty()) {
+        size_t i = pending.back();
+        pending.pop_back();
+        if (i == body.size())
+            continue;
+
+        State state = states[i];
+        bool next = step(body[i], state, false);
+        for (size_t target : targets(body[i]))
+            flow(target, state);
+        if (next)
+            flow(i + 1, state);
+    }
+
+    // Every state is final now, so the checks see all the paths
+    for (size_t i = 0; i < body.size(); i++) {
+        if (!reached[i])
+            continue;
+        State state = states[i];
+        step(body[i], state, true);
+        if (!body[i].isLabel())
+            report.instructions++;
+    }
+
+    // Running off the end of a function returns from it
+    if (!reached[body.size()])
+        return State();
+    if (function)
+        checkReturn(states[body.size()]);
+    return states[body.size()];
+}
+
+bool Verifier::step(const Instruction& instruction, State& state, bool check)
+{
+    if (instruction.isLabel())
+        return true;
+
+    std::string name = instruction.name();
+    std::vector<Operand> operands = instruction.operands();
+    auto id = [&](size_t i) { return (uint) operands[i].number; };
+
+    if (name == "OBJMK") {
+        touch(state, id(0));
+        state.objects[id(0)] = typeOf(operands[1].object_type);
+    } else if (name == "OBJDL") {
+        require(state, id(0), ANY_TYPE, check);
+        touch(state, id(0));
+        state.objects.erase(id(0));
+    } else if (name == "RGPOP") {
+        auto found = state.registers.find(id(0));
+        touch(state, id(1));
+        state.objects[id(1)] = found == state.registers.end()
+                             ? (uint8_t) VALUE_UNKNOWN : found->second;
+    } else if (name == "RPUSH") {
+        require(state, id(1), ANY_TYPE, check);
+        auto found = state.objects.find(id(1));
+        uint8_t value = found == state.objects.end()
+                      ? 0 : found->second & ~VALUE_ABSENT;
+        state.registers[id(0)] = value ? value : (uint8_t) VALUE_UNKNOWN;
+        touch(state, id(1));
+        state.objects.erase(id(1));
+    } else if (name == "RNULL") {
+        state.registers.clear();
+    } else if (name == "CALLF" || name == "CALLX" || name == "EXTLD") {
+        if (check && name == "CALLF" && !hasFunction(operands[0].text))
+            throw ValidatorError::unknown_label;
+        if (check)
+            checkCall(state, name == "CALLF");
+        state.registers.clear();
+    } else if (name == "PRINT") {
+        require(state, id(0), ANY_TYPE, check);
+    } else if (name == "CXXEQ" || name == "CXXLT") {
+        require(state, id(0), ANY_TYPE, check);
+        require(state, id(1), ANY_TYPE, check);
+    } else if (name == "IVADD" || name == "IVSUB") {
+        require(state, id(0), VALUE_INT, check);
+    } else if (name == "IXADD" || name == "IXSUB" || name == "IXMUL"
+            || name == "IXDIV") {
+        require(state, id(0), VALUE_INT, check);
+        require(state, id(1), VALUE_INT | VALUE_FLOAT, check);
+    } else if (name == "IVAEQ" || name == "IVALT") {
+        require(state, id(0), VALUE_INT, check);
+        require(state, id(2), ANY_TYPE, check);
+        require(state, id(3), ANY_TYPE, check);
+    } else if (name == "CEQJF" || name == "CEQJN" || name == "CLTJF"
+            || name == "CLTJN") {
+        require(state, id(0), ANY_TYPE, check);
+        require(state, id(1), ANY_TYPE, check);
+        jumpOut(operands[2].text, state, check);
+    } else if (name == "JMPFL" || name == "JMPNF") {
+        jumpOut(operands[0].text, state, check);
+    } else if (name == "JMPTO") {
+        jumpOut(operands[0].text, state, check);
+        return false;
+    } else if (name == "JMPTB" || name == "JMPBS") {
+        // Every value jumps somewhere, at worst to the fallback label
+        require(state, id(0), VALUE_INT, check);
+        const Operand& fallback = operands[name == "JMPTB" ? 2 : 1];
+        jumpOut(fallback.text, state, check);
+        for (const std::string& label : operands.back().labels)
+            jumpOut(label, state, check);
+        return false;
+    } else if (name == "RETRN") {
+        if (check && in_function)
+            checkReturn(state);
+        return false;
+    } else if (name == "EXITE" || name == "KILLX") {
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<size_t> Verifier::targets(const Instruction& instruction) const
+{
+    std::vector<size_t> found;
+    if (instruction.isLabel())
+        return found;
+
+    std::string name = instruction.name();
+    if (name.compare(0, 3, "JMP") && name[0] != 'C')
+        return found;
+
+    for (const Operand& operand : instruction.operands()) {
+        if (operand.type != OPERAND_STRING && operand.type != OPERAND_LABELS
+                && operand.type != OPERAND_CASES)
+            continue;
+        std::vector<std::string> names = operand.labels;
+        if (operand.type == OPERAND_STRING)
+            names = {operand.text};
+        for (const std::string& label : names) {
+            auto local = labels.find(label);
+            if (local != labels.end())
+                found.push_back(local->second);
+        }
+    }
+
+    return found;
+}
+
+void Verifier::jumpOut(const std::string& label, const State& state,
+                       bool check)
+{
+    if (!check || labels.count(label))
+        return;
+    if (!hasFunction(label))
+        throw ValidatorError::unknown_label;
+    if (in_function)
+        checkReturn(state);
+    checkCall(state, true);
+}
+
+void Verifier::require(const State& state, uint id, uint8_t types,
+                       bool check)
+{
+    if (!check)
+        return;
+
+    auto found = state.objects.find(id);
+    if (found == state.objects.end() || found->second & VALUE_ABSENT)
+        throw ValidatorError::unknown_id;
+
+    uint8_t value = found->second;
+    if (value & VALUE_UNKNOWN) {
+        report.unproven++;
+        value &= ~VALUE_UNKNOWN;
+    }
+    if (value & ~types)
+        throw ValidatorError::invalid_type;
+}
+
+void Verifier::checkReturn(const State& state) const
+{
+    // The caller would still expect the objects it had before the call
+    if (!state.touched.empty())
+        throw ValidatorError::undeleted_object;
+
+    for (const auto& [id, value] : state.objects) {
+        if (value != VALUE_ABSENT && !body_entry.objects.count(id))
+            throw ValidatorError::undeleted_object;
+    }
+}
+
+void Verifier::checkCall(const State& state, bool strict)
+{
+    if (!in_function) {
+        prelude_calls.push_back({state, strict});
+        return;
+    }
+
+    // Every function is verified with the objects the prelude leaves
+    if (!state.touched.empty())
+        throw ValidatorError::unknown_id;
+}
+
+void Verifier::checkPreludeCalls(const State& globals) const
+{
+    for (const auto& [state, strict] : prelude_calls) {
+        for (const auto& [id, value] : globals.objects) {
+            auto found = state.objects.find(id);
+            uint8_t at_call = found == state.objects.end()
+                            ? (uint8_t) VALUE_ABSENT : found->second;
+            if (strict && (at_call & VALUE_ABSENT) && !(value & VALUE_ABSENT))
+                throw ValidatorError::unknown_id;
+            if (at_call & ~value & ~VALUE_ABSENT)
+                throw ValidatorError::invalid_type;
+        }
+    }
+}
+
+void Verifier::touch(State& state, uint id) const
+{
+    if (in_function && body_entry.objects.count(id))
+        state.touched.insert(id);
+}
+
+bool Verifier::hasFunction(const std::string& name) const
+{
+    for (const Function& function : module.functions) {
+        if (function.name == name)
+            return true;
+    }
+
+    return false;
+}
+
+uint8_t Verifier::typeOf(byte type)
+{
+    switch (type) {
+        case Synthesizer::TYPE_INT:
+            return VALUE_INT;
+        case Synthesizer::TYPE_FLOAT:
+            return VALUE_FLOAT;
+        case Synthesizer::TYPE_BOOL:
+            return VALUE_BOOL;
+        case Synthesizer::TYPE_STRING:
+            return VALUE_STRING;
+        default:
+            return VALUE_NULL;
+    }
+}
+
+} // salt
@@ -8,11 +8,13 @@
 #include "../include/utils.h"
 #include "../include/compiler_metadata.h"
 #include "../include/scc/synthesizer.h"
+#include "../include/scc/image_writer.h"
 #include "../include/logging.h"
 #include <filesystem>
 #include <string>
 #include <cstring>
 #include <array>
+#include <algorithm>
 
 using std::string;
 using std::memcpy;
@@ -26,33 +28,88 @@ namespace salt
             dprint("Initializing '%s' source file object", filepath.c_str());
             this->code = load_file(filepath);
             dprint("Source code loaded");
+            module.name = path(filepath).stem().string();
+            module.files.push_back(filepath);
     }
 
     string SourceFile::getFilename() const {return filename;}
     
     string SourceFile::getFilePath() const {return filepath;}
     
-    void SourceFile::includeBuiltins() {meta.include_builtins = true;}
+    void SourceFile::includeBuiltins() {
+        meta.include_builtins = true;
+        module.prelude.insert(
+            module.prelude.begin(),
+            Synthesizer::externalLoad("builtins"));
+    }
     
+    void SourceFile::setCompression(Compression compression) {
+        this->compression = compression;
+    }
+
+    void SourceFile::setVerified(bool verified) {
+        meta.verified = verified;
+    }
+
     std::array<byte, 64> SourceFile::makeSCCHeader() {
         std::array<byte, 64> header;
         header.fill('\00');
         header.data();
         memcpy(header.data(), CompilerMetadata::SCC_HEADER.data(), 6);
         memcpy(header.data()+8, CompilerMetadata::SCC_VERSION.data(), 2);
+        uint flags = 0;
+        if(Synthesizer::getEncoding() == ENCODING_COMPACT)
+            flags |= CompilerMetadata::SCC_FLAG_COMPACT;
+        flags |= CompilerMetadata::SCC_FLAG_SECTIONED;
+        if(meta.compressed)
+            flags |= CompilerMetadata::SCC_FLAG_COMPRESSED;
+        if(meta.verified)
+            flags |= CompilerMetadata::SCC_FLAG_VERIFIED;
+        memcpy(header.data()+12, Synthesizer::makeNum(flags).data(), 4);
         memcpy(
             header.data()+16,
             Synthesizer::makeNum(meta.instructions).data(),
             4);
         //memcpy(header.data()+24, 'this->string_literals_amount', 4); ??
+        memcpy(
+            header.data()+24,
+            Synthesizer::makeNum(meta.memory_size).data(),
+            8);
         memcpy(
             header.data()+32,
             Synthesizer::makeNum(meta.max_instruction_width).data(),
             4);
+        memcpy(
+            header.data()+40,
+            Synthesizer::makeNum(meta.object_slots).data(),
+            4);
+        memcpy(
+            header.data()+48,
+            Synthesizer::makeNum(meta.sections).data(),
+            4);
+        memcpy(
+            header.data()+52,
+            Synthesizer::makeNum(SectionTable::PAGE_SIZE).data(),
+            4);
         memcpy(
             header.data()+56,
             CompilerMetadata::COMPILER_SIGNATURE.data(),
             8);
         return header;
     }
+
+    std::vector<byte> SourceFile::makeSCCBody() {
+        ImageWriter writer(module);
+        writer.setCompression(compression);
+        std::vector<byte> body = writer.write(64);
+        meta.instructions = writer.getInstructionCount();
+        // The validator counts the legacy newline too
+        meta.max_instruction_width =
+            ((writer.getMaxWidth() + 1) / 16 + 1) * 16;
+        meta.object_slots = module.object_slots;
+        meta.sections = writer.getSectionCount();
+        meta.compressed = writer.isCompressed();
+        meta.memory_size = writer.getMemorySize();
+        return body;
+    }
 } // salt
\ No newline at end of file
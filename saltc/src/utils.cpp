@@ -25,6 +25,12 @@ string load_file(string filepath) {
     return buffer.str();
 }
 
+void save_file(string filepath, const std::vector<byte>& data) {
+    std::ofstream file(filepath.c_str(), std::ios::binary);
+    file.write(data.data(), data.size());
+    file.close();
+}
+
 InStringPosition::InStringPosition(string& str, string::iterator iterator)
     :line_idx(std::count(str.begin(), iterator, '\n')),
     idx(std::distance(str.begin(), iterator)),
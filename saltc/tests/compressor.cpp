@@ -0,0 +1,153 @@
+/**
+ * Tests of the Compressor and the Decompressor.
+ */
+#include "test.h"
+#include "../include/scc/compressor.h"
+#include "../include/scc/section_table.h"
+#include "../include/scc/validator.h"
+
+#include <string.h>
+
+using namespace salt;
+typedef Synthesizer S;
+
+/* Sentinel for data which was decompressed without an error */
+static const int DECODED = -1;
+
+/* Data with long repeats, short repeats and bytes which never repeat */
+static std::vector<byte> sample(size_t __n)
+{
+    std::vector<byte> data;
+    uint32_t random = 1;
+    while (data.size() < __n) {
+        random = random * 1103515245 + 12345;
+        switch (random >> 29) {
+            case 0:
+            case 1: {
+                std::string text = "OBJMK PRINT OBJDL RETRN ";
+                data.insert(data.end(), text.begin(), text.end());
+                break;
+            }
+            case 2:
+                data.insert(data.end(), 300, (byte) (random >> 8));
+                break;
+            default:
+                data.push_back((byte) (random >> 16));
+                break;
+        }
+    }
+
+    data.resize(__n);
+    return data;
+}
+
+/* Decompress the data fed in blocks, and return the error or DECODED */
+static int decompress(const std::vector<byte>& compressed,
+                      std::vector<byte>& output, size_t block)
+{
+    try {
+        Decompressor decompressor(output.data(), output.size());
+        for (size_t i = 0; i < compressed.size(); i += block)
+            decompressor.feed(compressed.data() + i,
+                              std::min(block, compressed.size() - i));
+        decompressor.finish();
+    } catch (ValidatorError e) {
+        return e;
+    }
+
+    return DECODED;
+}
+
+TEST(compressor_round_trips)
+{
+    for (Compression level : {COMPRESSION_FAST, COMPRESSION_SMALL}) {
+        for (size_t size : {0, 1, 15, 1000, 200000}) {
+            std::vector<byte> data = sample(size);
+            std::vector<byte> compressed = Compressor::compress(data, level);
+
+            // Blocks of one byte split every sequence at every field
+            for (size_t block : {1, 7, 4096}) {
+                std::vector<byte> output(data.size());
+                CHECK_EQ(decompress(compressed, output, block), DECODED);
+                CHECK(output == data);
+            }
+        }
+    }
+}
+
+TEST(compressor_makes_repeats_smaller)
+{
+    std::vector<byte> data(100000, 'a');
+    for (Compression level : {COMPRESSION_FAST, COMPRESSION_SMALL})
+        CHECK(Compressor::compress(data, level).size() < 1000);
+
+    std::vector<byte> mixed = sample(100000);
+    CHECK(Compressor::compress(mixed, COMPRESSION_SMALL).size()
+          <= Compressor::compress(mixed, COMPRESSION_FAST).size());
+}
+
+TEST(compressor_rejects_corrupt_data)
+{
+    std::vector<byte> data = sample(5000);
+    std::vector<byte> compressed = Compressor::compress(data,
+                                                        COMPRESSION_SMALL);
+    std::vector<byte> output(data.size());
+
+    // Cut short, and with a wrong decompressed size
+    std::vector<byte> truncated(compressed.begin(), compressed.end() - 3);
+    CHECK_EQ(decompress(truncated, output, 4096),
+             ValidatorError::invalid_compression);
+    std::vector<byte> small(data.size() - 1);
+    CHECK_EQ(decompress(compressed, small, 4096),
+             ValidatorError::invalid_compression);
+    std::vector<byte> big(data.size() + 1);
+    CHECK_EQ(decompress(compressed, big, 4096),
+             ValidatorError::invalid_compression);
+
+    // A match reaching back before the start of the data
+    std::vector<byte> before = {0x10, 'a', 0x02, 0x00};
+    std::vector<byte> two(6);
+    CHECK_EQ(decompress(before, two, 4096),
+             ValidatorError::invalid_compression);
+
+    // More literals than fit
+    std::vector<byte> literals = {0x50, 'a', 'b', 'c', 'd', 'e'};
+    std::vector<byte> four(4);
+    CHECK_EQ(decompress(literals, four, 1),
+             ValidatorError::invalid_compression);
+}
+
+TEST(compressor_sections_are_validated)
+{
+    Module module;
+    std::string text(2000, 'x');
+    module.prelude = {S::objectMake(0, true, text)};
+    module.functions = {Function{"main", true, {S::print(0), S::print(0),
+                                                S::return_()}}};
+
+    std::string bytes = test::image(module, COMPRESSION_SMALL);
+    Validator validator(bytes);
+    validator.validate();
+    CHECK(!validator.takeExpanded().empty());
+
+    // Breaking the first compressed section breaks its matches
+    uint amount;
+    memcpy(&amount, bytes.data() + 48, sizeof(amount));
+    const Section *found = nullptr;
+    SectionTable table = SectionTable::read(bytes, amount);
+    for (const Section& section : table.getSections()) {
+        if (!found && (section.flags & SectionTable::FLAG_COMPRESSED))
+            found = &section;
+    }
+    CHECK(found);
+    if (!found)
+        return;
+
+    memset(&bytes[found->offset], 0xff, 8);
+    try {
+        Validator(bytes).validate();
+        CHECK(!"accepted a corrupt section");
+    } catch (ValidatorError e) {
+        CHECK_EQ(e, ValidatorError::invalid_compression);
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * Tests of the ConstantFolder.
+ */
+#include "test.h"
+#include "../include/constant_folder.h"
+#include "../include/source_file.h"
+#include "../include/tokenizer.h"
+
+#include <filesystem>
+#include <stdint.h>
+
+using namespace salt;
+
+/* Tokenize and fold the code, and return the values of the tokens */
+static std::string fold(const std::string& code)
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path()
+                               / "salt_fold.salt";
+    save_file(path.string(), std::vector<byte>(code.begin(), code.end()));
+
+    SourceFile source(path.string());
+    Tokenizer tokenizer(source);
+    ConstantFolder folder(tokenizer.getTokens());
+
+    std::string values;
+    for (const Token& token : folder.fold())
+        values += (values.empty() ? "" : " ") + token.value;
+    return values;
+}
+
+/* An int constant */
+static ConstValue integer(int64_t value)
+{
+    ConstValue constant;
+    constant.type = TOKL_INT;
+    constant.integer = value;
+    return constant;
+}
+
+TEST(constant_folder_folds_expressions)
+{
+    CHECK_EQ(fold("int x = 1 << 20;"), "int x = 1048576 ;");
+    CHECK_EQ(fold("int x = (2 + 3) * 4 - 1;"), "int x = 19 ;");
+    CHECK_EQ(fold("string s = \"a\" + \"b\";"), "string s = \"ab\" ;");
+}
+
+TEST(constant_folder_propagates_constants)
+{
+    CHECK_EQ(fold("const int A = 3; int x = A * 2;"),
+             "const int A = 3 ; int x = 6 ;");
+
+    // Objects which aren't const can change, so they're left alone
+    CHECK_EQ(fold("int b = 2; int y = b + 1;"),
+             "int b = 2 ; int y = b + 1 ;");
+}
+
+TEST(constant_folder_keeps_expressions_failing_at_runtime)
+{
+    CHECK_EQ(fold("int y = 10 / 0;"), "int y = 10 / 0 ;");
+    CHECK_EQ(fold("int y = 1 << 64;"), "int y = 1 << 64 ;");
+}
+
+TEST(constant_folder_wraps_like_the_vm)
+{
+    ConstValue sum = ConstantFolder::evaluate(AOP_ADD, integer(INT64_MAX),
+                                              integer(1));
+    CHECK_EQ(sum.type, TOKL_INT);
+    CHECK_EQ(sum.integer, INT64_MIN);
+
+    // The quotient doesn't fit, the VM raises an error instead
+    ConstValue quotient = ConstantFolder::evaluate(AOP_DIV,
+            integer(INT64_MIN), integer(-1));
+    CHECK_EQ(quotient.type, TOK_0);
+}
+
+TEST(constant_folder_compares_ints_exactly)
+{
+    // Both are the same double
+    int64_t big = ((int64_t) 1 << 53) + 1;
+    ConstValue equal = ConstantFolder::evaluate(COP_EQUAL, integer(big),
+                                                integer(big - 1));
+    CHECK_EQ(equal.type, TOKL_BOOL);
+    CHECK(!equal.boolean);
+
+    ConstValue less = ConstantFolder::evaluate(COP_LT, integer(big - 1),
+                                               integer(big));
+    CHECK_EQ(less.type, TOKL_BOOL);
+    CHECK(less.boolean);
+    CHECK(!ConstantFolder::evaluate(COP_GOREQ, integer(big - 1),
+                                    integer(big)).boolean);
+}
+
+TEST(constant_folder_resolves_escapes_of_objects)
+{
+    ConstValue value;
+    value.type = TOKL_STRING;
+    value.str = "a\\nb";
+
+    Instruction object(ConstantFolder::makeObject(3, value));
+    CHECK_EQ(object.operands()[1].text, "a\nb");
+}
@@ -0,0 +1,71 @@
+/**
+ * Tests of the Encoder and of reading the strings back.
+ */
+#include "test.h"
+#include "../include/scc/encoder.h"
+#include "../include/scc/bytecode_reader.h"
+
+using namespace salt;
+typedef Synthesizer S;
+
+/* A string with both a real 0x11 byte and a newline */
+static const std::string TEXT = std::string("a\x11") + "b\nc";
+
+/* Encode the instruction and read its operands back */
+static std::vector<Operand> roundTrip(const Instruction& instruction)
+{
+    std::vector<byte> bytes = Encoder::encode(instruction);
+    BytecodeReader reader(bytes.data(), bytes.size(), S::getEncoding());
+
+    std::string label;
+    const InstructionInfo *info = reader.readInstruction(label);
+    std::vector<Operand> operands;
+    for (OperandType type : info->operands)
+        operands.push_back(reader.readOperand(type));
+    reader.endInstruction();
+
+    CHECK(reader.atEnd());
+    return operands;
+}
+
+TEST(encoder_keeps_strings_raw)
+{
+    for (Encoding encoding : {ENCODING_FIXED, ENCODING_COMPACT}) {
+        S::setEncoding(encoding);
+        Instruction instruction = S::objectMake(3, true, TEXT);
+        CHECK_EQ(instruction.operands()[1].text, TEXT);
+
+        std::vector<Operand> operands = roundTrip(instruction);
+        CHECK_EQ(operands[0].number, 3);
+        CHECK_EQ(operands[1].text, TEXT);
+    }
+
+    S::setEncoding(ENCODING_FIXED);
+}
+
+TEST(encoder_keeps_labels_raw)
+{
+    std::string name = std::string("f\x11") + "g";
+    std::vector<Operand> operands = roundTrip(S::callLocal(name));
+    CHECK_EQ(operands[0].text, name);
+
+    std::vector<byte> bytes = Encoder::encode(S::label(name));
+    BytecodeReader reader(bytes.data(), bytes.size(), S::getEncoding());
+    std::string label;
+    CHECK(reader.readInstruction(label) == nullptr);
+    CHECK_EQ(label, name);
+}
+
+TEST(reader_unescapes_legacy_strings)
+{
+    // Only SCC3 strings escape their newlines as 0x11
+    std::string escaped = "a\x11" "b";
+    std::vector<byte> bytes = S::makeString(escaped);
+
+    BytecodeReader reader(bytes.data(), bytes.size(), ENCODING_FIXED);
+    CHECK_EQ(reader.readString(), escaped);
+
+    BytecodeReader legacy(bytes.data(), bytes.size(), ENCODING_FIXED);
+    legacy.setLegacy(true);
+    CHECK_EQ(legacy.readString(), "a\nb");
+}
@@ -0,0 +1,112 @@
+/**
+ * Tests of the FunctionIndex.
+ */
+#include "test.h"
+#include "../include/scc/bytecode_reader.h"
+#include "../include/scc/function_index.h"
+#include "../include/scc/section_table.h"
+
+#include <string.h>
+
+using namespace salt;
+using salt::test::op;
+typedef Synthesizer S;
+
+TEST(function_index_describes_functions)
+{
+    // Arguments are the RGPOP calls at the start of the function
+    Function function{"add", true, {
+        op("RGPOP", {0, 100}),
+        op("RGPOP", {1, 101}),
+        op("IXADD", {100, 101}),
+        op("RPUSH", {2, 100}),
+        op("RGPOP", {3, 102}),
+        S::objectDelete(101),
+        S::objectDelete(102),
+        S::return_()
+    }};
+    function.object_slots = 3;
+
+    FunctionEntry entry = FunctionIndex::describe(function);
+    CHECK_EQ(entry.name, "add");
+    CHECK_EQ(entry.hash, FunctionIndex::hash("add"));
+    CHECK_EQ(entry.arity, 2);
+    CHECK_EQ(entry.registers, 4);
+    CHECK_EQ(entry.flags, FunctionIndex::FLAG_PUBLIC);
+    CHECK_EQ(entry.object_slots, 3u);
+
+    function.is_public = false;
+    CHECK_EQ(FunctionIndex::describe(function).flags, 0);
+}
+
+TEST(function_index_finds_every_function)
+{
+    std::vector<FunctionEntry> entries;
+    for (uint i = 0; i < 50; i++) {
+        Function function{"f" + std::to_string(i), false, {S::return_()}};
+        FunctionEntry entry = FunctionIndex::describe(function);
+        entry.offset = i * 10;
+        entry.length = 10;
+        entry.index = i;
+        entries.push_back(entry);
+    }
+
+    std::vector<byte> section = FunctionIndex::make(entries);
+    for (const FunctionEntry& wanted : entries) {
+        FunctionEntry found;
+        CHECK(FunctionIndex::find(section.data(), section.size(),
+                                  wanted.name, found));
+        CHECK_EQ(found.name, wanted.name);
+        CHECK_EQ(found.offset, wanted.offset);
+        CHECK_EQ(found.index, wanted.index);
+    }
+
+    FunctionEntry missing;
+    CHECK(!FunctionIndex::find(section.data(), section.size(), "f50",
+                               missing));
+
+    // Sorted by hash, which is what the search relies on
+    for (uint i = 1; i < entries.size(); i++) {
+        CHECK(FunctionIndex::read(section.data(), section.size(), i - 1).hash
+              <= FunctionIndex::read(section.data(), section.size(), i).hash);
+    }
+}
+
+TEST(function_index_points_at_the_function_labels)
+{
+    Module module;
+    module.prelude = {S::objectMake(0, true, std::string("x"))};
+    module.functions = {
+        Function{"main", true, {S::print(0), S::callLocal("f"),
+                                S::return_()}},
+        Function{"f", false, {S::print(0), S::print(0), S::return_()}}
+    };
+
+    std::string bytes = test::image(module);
+    uint amount;
+    memcpy(&amount, bytes.data() + 48, sizeof(amount));
+    SectionTable table = SectionTable::read(bytes, amount);
+    const Section *code = table.find(SECTION_CODE);
+    const Section *functions = table.find(SECTION_FUNCTIONS);
+    CHECK(code && functions);
+    if (!code || !functions)
+        return;
+
+    const byte *data = (const byte *) bytes.data();
+    for (const Function& function : module.functions) {
+        FunctionEntry entry;
+        CHECK(FunctionIndex::find(data + functions->offset, functions->size,
+                                  function.name, entry));
+
+        std::string label;
+        BytecodeReader reader(data + code->offset + entry.offset,
+                              entry.length, ENCODING_FIXED);
+        CHECK(!reader.readInstruction(label));
+        CHECK_EQ(label, function.name);
+    }
+
+    // The last function ends with the code
+    FunctionEntry last;
+    FunctionIndex::find(data + functions->offset, functions->size, "f", last);
+    CHECK_EQ(last.offset + last.length, code->size);
+}
@@ -0,0 +1,102 @@
+/**
+ * Tests of the Fuser.
+ */
+#include "test.h"
+#include "../include/scc/fuser.h"
+
+using namespace salt;
+using salt::test::op;
+typedef Synthesizer S;
+
+TEST(fuser_fuses_compares_and_jumps)
+{
+    Module module;
+    module.prelude = {S::objectMake(7, true, (int64_t) 3)};
+    module.functions = {Function{"main", true, {
+        S::objectMake(100, false, (int64_t) 0),
+        S::label("#top"),
+        S::print(100),
+        S::intAdd(100, 1),
+        op("CXXLT", {100, 7}),
+        S::jumpFlag("#top"),
+        S::objectDelete(100),
+        S::return_()
+    }}};
+
+    std::string expected = test::run(module);
+    InstructionList& body = module.functions[0].body;
+    CHECK_EQ(Fuser::fuse(body), 1u);
+
+    // The compare is fused with the jump first, so the add stays alone
+    CHECK_EQ(expected, "012");
+    CHECK_EQ(test::run(module), expected);
+    CHECK(test::find(body, "CLTJF") < body.size());
+    CHECK_EQ(test::find(body, "CXXLT"), body.size());
+    CHECK_EQ(test::find(body, "JMPFL"), body.size());
+}
+
+TEST(fuser_fuses_adds_and_compares)
+{
+    Module module;
+    module.prelude = {S::objectMake(7, true, (int64_t) 2)};
+    module.functions = {Function{"main", true, {
+        S::objectMake(100, false, (int64_t) 0),
+        S::intAdd(100, 2),
+        op("CXXEQ", {100, 7}),
+        S::print(100),
+        S::objectDelete(100),
+        S::return_()
+    }}};
+
+    std::string expected = test::run(module);
+    CHECK_EQ(Fuser::fuse(module.functions[0].body), 1u);
+    CHECK_EQ(test::run(module), expected);
+    CHECK_EQ(module.functions[0].body[1].name(), "IVAEQ");
+}
+
+TEST(fuser_never_fuses_over_labels)
+{
+    // The jump can land between the compare and the conditional jump
+    InstructionList body = {
+        op("CXXEQ", {1, 2}),
+        S::label("#between"),
+        S::jumpFlag("#between")
+    };
+
+    CHECK_EQ(Fuser::fuse(body), 0u);
+    CHECK_EQ(body.size(), 3u);
+    CHECK(Fuser::histogram(body).empty());
+}
+
+TEST(fuser_keeps_positions)
+{
+    SourcePosition position;
+    position.line = 3;
+    position.column = 5;
+
+    InstructionList body = {
+        Instruction(op("CXXLT", {1, 2}).code, position),
+        S::jumpNotFlag("#end"),
+        S::label("#end")
+    };
+
+    CHECK_EQ(Fuser::fuse(body), 1u);
+    CHECK_EQ(body[0].name(), "CLTJN");
+    CHECK(body[0].position == position);
+}
+
+TEST(fuser_counts_pairs)
+{
+    InstructionList body = {
+        op("CXXLT", {1, 2}),
+        S::jumpFlag("#a"),
+        op("CXXLT", {1, 2}),
+        S::jumpFlag("#a"),
+        S::label("#a")
+    };
+
+    Fuser::PairHistogram pairs = Fuser::histogram(body);
+    std::pair<std::string, std::string> key = {"CXXLT", "JMPFL"};
+    CHECK_EQ(pairs[key], 2u);
+    CHECK_EQ((pairs[{"JMPFL", "CXXLT"}]), 1u);
+}
@@ -0,0 +1,155 @@
+/**
+ * Tests of the Inliner.
+ */
+#include "test.h"
+#include "../include/scc/inliner.h"
+
+using namespace salt;
+using salt::test::op;
+typedef Synthesizer S;
+
+TEST(inliner_gives_copies_their_own_objects)
+{
+    // Both functions use 100, the copy must not delete the caller's one
+    Module module;
+    module.functions = {
+        Function{"main", true, {
+            S::objectMake(100, true, std::string("main")),
+            S::callLocal("f"),
+            S::callLocal("f"),
+            S::print(100),
+            S::objectDelete(100),
+            S::return_()
+        }},
+        Function{"f", true, {
+            S::objectMake(100, true, std::string("f")),
+            S::print(100),
+            S::objectDelete(100),
+            S::return_()
+        }}
+    };
+
+    std::string expected = test::run(module);
+    Inliner::Report report = Inliner(module).run();
+    const InstructionList& body = module.functions[0].body;
+
+    CHECK_EQ(report.inlined.size(), 2u);
+    CHECK_EQ(expected, "ffmain");
+    CHECK_EQ(test::run(module), expected);
+    CHECK_EQ(test::find(body, "CALLF"), body.size());
+}
+
+TEST(inliner_turns_returns_into_jumps)
+{
+    Module module;
+    module.prelude = {
+        S::objectMake(1, true, (int64_t) 1),
+        S::objectMake(2, true, (int64_t) 2)
+    };
+    module.functions = {
+        Function{"main", true, {
+            S::callLocal("f"),
+            S::print(2),
+            S::return_()
+        }},
+        Function{"f", false, {
+            op("CXXEQ", {1, 1}),
+            S::jumpNotFlag("#skip"),
+            S::print(1),
+            S::return_(),
+            S::label("#skip"),
+            S::print(2),
+            S::return_()
+        }}
+    };
+
+    std::string expected = test::run(module);
+    Inliner(module).run();
+    const InstructionList& body = module.functions[0].body;
+
+    CHECK_EQ(expected, "12");
+    CHECK_EQ(test::run(module), expected);
+    CHECK_EQ(test::find(body, "RETRN"), body.size() - 1);
+    CHECK(test::find(body, "JMPTO") < body.size());
+}
+
+TEST(inliner_skips_recursive_functions)
+{
+    Module module;
+    module.prelude = {
+        S::objectMake(1, false, (int64_t) 0),
+        S::objectMake(2, true, (int64_t) 3)
+    };
+    module.functions = {
+        Function{"main", true, {S::callLocal("f"), S::return_()}},
+        Function{"f", false, {
+            S::intAdd(1, 1),
+            S::print(1),
+            op("CXXLT", {1, 2}),
+            S::jumpNotFlag("#end"),
+            S::callLocal("f"),
+            S::label("#end"),
+            S::return_()
+        }}
+    };
+
+    std::string expected = test::run(module);
+    CHECK(Inliner(module).run().inlined.empty());
+    CHECK_EQ(expected, "123");
+    CHECK_EQ(test::run(module), expected);
+}
+
+TEST(inliner_respects_the_maximum_size)
+{
+    // A public helper called twice is only inlined if it's small enough,
+    // while a private one called once always is
+    InstructionList helper = {S::print(1), S::print(1), S::return_()};
+    Module module;
+    module.prelude = {S::objectMake(1, true, std::string("x"))};
+    module.functions = {
+        Function{"main", true, {
+            S::callLocal("twice"),
+            S::callLocal("twice"),
+            S::callLocal("once"),
+            S::return_()
+        }},
+        Function{"twice", true, helper},
+        Function{"once", false, helper}
+    };
+
+    Inliner inliner(module);
+    inliner.setMaxSize(1);
+    Inliner::Report report = inliner.run();
+
+    CHECK_EQ(report.inlined.size(), 1u);
+    CHECK_EQ(report.inlined[0], "main <- once");
+    CHECK_EQ(test::run(module), "xxxxxx");
+}
+
+TEST(inliner_keeps_objects_left_for_the_caller)
+{
+    // The callee creates the result, the caller reads and deletes it
+    Module module;
+    module.functions = {
+        Function{"main", true, {
+            S::objectMake(100, true, std::string("main")),
+            S::callLocal("f"),
+            S::print(200),
+            S::objectDelete(200),
+            S::print(100),
+            S::objectDelete(100),
+            S::return_()
+        }},
+        Function{"f", false, {
+            S::objectMake(100, true, std::string("f")),
+            S::objectDelete(100),
+            S::objectMake(200, true, std::string("result")),
+            S::return_()
+        }}
+    };
+
+    std::string expected = test::run(module);
+    CHECK_EQ(Inliner(module).run().inlined.size(), 1u);
+    CHECK_EQ(expected, "resultmain");
+    CHECK_EQ(test::run(module), expected);
+}
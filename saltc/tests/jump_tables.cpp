@@ -0,0 +1,86 @@
+/**
+ * Tests of the JumpTables pass.
+ */
+#include "test.h"
+#include "../include/scc/jump_tables.h"
+
+using namespace salt;
+using salt::test::op;
+typedef Synthesizer S;
+
+/* Dispatch block comparing $100 against the prelude constants, each case
+   printing its key. The constant of each key has the key as its ID. */
+static Module dispatch(Instruction value,
+                       std::vector<int64_t> keys = {1, 2, 3, 4})
+{
+    Module module;
+    for (int64_t key : keys)
+        module.prelude.push_back(S::objectMake(key, true, key));
+
+    InstructionList body = {value};
+    for (int64_t key : keys) {
+        body.push_back(S::compareEqual(100, key));
+        body.push_back(S::jumpFlag("#case" + std::to_string(key)));
+    }
+    body.push_back(S::jumpTo("#end"));
+    for (int64_t key : keys) {
+        body.push_back(S::label("#case" + std::to_string(key)));
+        body.push_back(S::print(key));
+        body.push_back(S::jumpTo("#end"));
+    }
+    body.push_back(S::label("#end"));
+    body.push_back(S::objectDelete(100));
+    body.push_back(S::return_());
+
+    module.functions = {Function{"main", true, body}};
+    return module;
+}
+
+TEST(jump_tables_replace_compares_of_ints)
+{
+    Module module = dispatch(S::objectMake(100, false, (int64_t) 3));
+
+    std::string expected = test::run(module);
+    CHECK_EQ(JumpTables::build(module), 1u);
+    CHECK_EQ(expected, "3");
+    CHECK_EQ(test::run(module), expected);
+    CHECK(test::find(module.functions[0].body, "JMPTB")
+          < module.functions[0].body.size());
+}
+
+TEST(jump_tables_keep_compares_of_other_types)
+{
+    // A float equal to a key matches the CXXEQ, but a table would fail
+    Module module = dispatch(S::objectMake(100, false, 3.0f));
+
+    std::string expected = test::run(module);
+    CHECK_EQ(JumpTables::build(module), 0u);
+    CHECK_EQ(expected, "3");
+    CHECK_EQ(test::run(module), expected);
+}
+
+TEST(jump_tables_keep_compares_of_objects_from_registers)
+{
+    Module module = dispatch(op("RGPOP", {0, 100}));
+    CHECK_EQ(JumpTables::build(module), 0u);
+}
+
+TEST(jump_tables_clear_the_flag_in_holes)
+{
+    // 4 is a hole of the table, the compares leave the flag cleared for it
+    // just like for values outside of the table
+    for (int64_t value : {3, 4, 6}) {
+        Module module = dispatch(S::objectMake(100, false, value),
+                                 {1, 2, 3, 5});
+        module.prelude.push_back(S::objectMake(50, true, std::string("+")));
+        InstructionList& body = module.functions[0].body;
+        body.insert(body.end() - 2, {S::jumpNotFlag("#done"), S::print(50),
+                                     S::label("#done")});
+
+        std::string expected = test::run(module);
+        CHECK_EQ(JumpTables::build(module), 1u);
+        CHECK_EQ(expected, value == 3 ? "3+" : "");
+        CHECK_EQ(test::run(module), expected);
+        CHECK(test::find(body, "JMPTB") < body.size());
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * Tests of the Linker.
+ */
+#include "test.h"
+#include "../include/scc/linker.h"
+
+using namespace salt;
+using salt::test::op;
+typedef Synthesizer S;
+
+/* Return true if any instruction of the module is the mnemonic */
+static bool uses(const Module& module, const std::string& name)
+{
+    for (const Instruction& instruction : module.render()) {
+        if (!instruction.isLabel() && instruction.name() == name)
+            return true;
+    }
+
+    return false;
+}
+
+/* A main module calling "greet" of "lib", both having a "hi" constant */
+static std::vector<Module> program()
+{
+    Module main;
+    main.name = "main";
+    main.object_slots = 1;
+    main.prelude = {S::externalLoad("lib"),
+                    S::objectMake(0, true, std::string("hi\n"))};
+    main.functions = {Function{"main", true, {
+        op("CALLX", {}, {"lib", "greet"}),
+        S::print(0),
+        S::return_()
+    }}};
+
+    Module lib;
+    lib.name = "lib";
+    lib.object_slots = 2;
+    lib.prelude = {S::objectMake(0, true, std::string("hi\n")),
+                   S::objectMake(1, true, std::string("lib\n"))};
+    lib.functions = {
+        Function{"greet", true, {
+            S::print(1),
+            S::jumpTo("#x"),
+            S::print(1),
+            S::label("#x"),
+            S::print(0),
+            S::return_()
+        }},
+        Function{"unused", true, {S::print(1), S::return_()}}
+    };
+
+    return {main, lib};
+}
+
+TEST(linker_joins_modules)
+{
+    Linker linker(program());
+    Module linked = linker.link();
+
+    CHECK_EQ(linked.name, "main");
+    CHECK_EQ(linked.object_slots, 3u);
+    CHECK_EQ(test::run(linked), "lib\nhi\nhi\n");
+    CHECK(!uses(linked, "EXTLD"));
+    CHECK(!uses(linked, "CALLX"));
+
+    // Functions of the other modules are renamed, private and shaken
+    CHECK(linked.findFunction("main"));
+    CHECK(linked.findFunction("main")->is_public);
+    Function *greet = linked.findFunction("lib.greet");
+    CHECK(greet);
+    if (greet) {
+        CHECK(!greet->is_public);
+        CHECK_EQ(greet->body[1].operands()[0].text, "#lib.x");
+    }
+    CHECK(!linked.findFunction("lib.unused"));
+
+    CHECK_EQ(linker.getReport().calls.size(), 1u);
+    CHECK_EQ(linker.getReport().constants, 1u);
+}
+
+TEST(linker_moves_object_ids)
+{
+    std::vector<Module> modules = program();
+    modules[0].prelude[1] = S::objectMake(0, true, std::string("main\n"));
+
+    Linker linker(modules);
+    Module linked = linker.link();
+
+    // Nothing is equal, so each module keeps its own objects
+    CHECK_EQ(test::run(linked), "lib\nhi\nmain\n");
+    CHECK_EQ(linker.getReport().constants, 0u);
+
+    Function *greet = linked.findFunction("lib.greet");
+    CHECK(greet);
+    if (greet)
+        CHECK_EQ(greet->body[0].operands()[0].number, 2);
+}
+
+TEST(linker_leaves_unknown_modules)
+{
+    std::vector<Module> modules = program();
+    modules[0].prelude.insert(modules[0].prelude.begin(),
+                              S::externalLoad("io"));
+    modules[0].functions[0].body.insert(modules[0].functions[0].body.begin(),
+                                        op("CALLX", {}, {"io", "write"}));
+
+    Module linked = Linker(modules).link();
+    CHECK_EQ(linked.prelude[0].name(), "EXTLD");
+    CHECK_EQ(linked.prelude[0].operands()[0].text, "io");
+
+    size_t call = test::find(linked.functions[0].body, "CALLX");
+    CHECK(call < linked.functions[0].body.size());
+    if (call < linked.functions[0].body.size())
+        CHECK_EQ(linked.functions[0].body[call].operands()[0].text, "io");
+}
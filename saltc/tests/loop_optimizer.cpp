@@ -0,0 +1,124 @@
+/**
+ * Tests of the LoopOptimizer.
+ */
+#include "test.h"
+#include "../include/scc/loop_optimizer.h"
+
+using namespace salt;
+using salt::test::op;
+typedef Synthesizer S;
+
+/* Loop counting $100 from 0 to the prelude constant $7, the body goes
+   between the condition and the step */
+static Module loop(std::vector<int64_t> constants, InstructionList inside)
+{
+    Module module;
+    for (size_t i = 0; i < constants.size(); i++)
+        module.prelude.push_back(S::objectMake(7 + i, true, constants[i]));
+
+    InstructionList body = {
+        S::objectMake(100, false, (int64_t) 0),
+        S::label("#top"),
+        S::compareLessJumpNotFlag(100, 7, "#end")
+    };
+    body.insert(body.end(), inside.begin(), inside.end());
+    body.insert(body.end(), {
+        S::intAdd(100, 1),
+        S::jumpTo("#top"),
+        S::label("#end"),
+        S::objectDelete(100),
+        S::return_()
+    });
+
+    module.functions = {Function{"main", true, body}};
+    return module;
+}
+
+TEST(loop_optimizer_hoists_invariant_objects)
+{
+    Module module = loop({3}, {
+        S::objectMake(101, true, std::string("x")),
+        S::print(101),
+        S::objectDelete(101)
+    });
+
+    std::string expected = test::run(module);
+    LoopOptimizer::Report report = LoopOptimizer::optimize(module);
+    const InstructionList& body = module.functions[0].body;
+
+    CHECK_EQ(report.hoisted, 1u);
+    CHECK_EQ(expected, "xxx");
+    CHECK_EQ(test::run(module), expected);
+    CHECK(test::find(body, "OBJMK", 1) < test::find(body, "CLTJN"));
+}
+
+TEST(loop_optimizer_keeps_division_in_the_loop)
+{
+    // The loop never runs, so the division by zero never happens
+    Module module = loop({0, 0}, {
+        S::objectMake(101, false, (int64_t) 10),
+        op("IXDIV", {101, 8}),
+        S::print(101),
+        S::objectDelete(101)
+    });
+
+    LoopOptimizer::Report report = LoopOptimizer::optimize(module);
+    CHECK_EQ(report.hoisted, 0u);
+    CHECK_EQ(test::run(module), "");
+}
+
+TEST(loop_optimizer_keeps_arithmetic_on_non_numbers_in_the_loop)
+{
+    Module module = loop({0}, {
+        S::objectMake(101, false, (int64_t) 10),
+        op("IXADD", {101, 8}),
+        S::print(101),
+        S::objectDelete(101)
+    });
+    module.prelude.push_back(S::objectMake(8, true, std::string("s")));
+
+    LoopOptimizer::Report report = LoopOptimizer::optimize(module);
+    CHECK_EQ(report.hoisted, 0u);
+    CHECK_EQ(test::run(module), "");
+}
+
+TEST(loop_optimizer_keeps_branches_in_the_loop)
+{
+    // The object is only made when the counter is 1
+    Module module = loop({3, 1}, {
+        S::compareEqualJumpNotFlag(100, 8, "#skip"),
+        S::objectMake(101, true, std::string("x")),
+        S::print(101),
+        S::objectDelete(101),
+        S::label("#skip")
+    });
+
+    std::string expected = test::run(module);
+    LoopOptimizer::Report report = LoopOptimizer::optimize(module);
+    const InstructionList& body = module.functions[0].body;
+
+    CHECK_EQ(report.hoisted, 0u);
+    CHECK_EQ(expected, "x");
+    CHECK_EQ(test::run(module), expected);
+    CHECK(test::find(body, "OBJMK", 1) > test::find(body, "CEQJN"));
+}
+
+TEST(loop_optimizer_reduces_multiplications)
+{
+    Module module = loop({4, 5}, {
+        S::objectMake(101, false, (int64_t) 0),
+        op("IXADD", {101, 100}),
+        op("IXMUL", {101, 8}),
+        S::print(101),
+        S::objectDelete(101)
+    });
+
+    std::string expected = test::run(module);
+    LoopOptimizer::Report report = LoopOptimizer::optimize(module);
+    const InstructionList& body = module.functions[0].body;
+
+    CHECK_EQ(report.reduced, 1u);
+    CHECK_EQ(expected, "051015");
+    CHECK_EQ(test::run(module), expected);
+    CHECK(test::find(body, "IXMUL") < test::find(body, "CLTJN"));
+}
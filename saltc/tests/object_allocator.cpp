@@ -0,0 +1,195 @@
+/**
+ * Tests of the ObjectAllocator.
+ */
+#include "test.h"
+#include "../include/scc/object_allocator.h"
+
+using namespace salt;
+using salt::test::op;
+typedef Synthesizer S;
+
+/* ID of the first operand of the instruction */
+static int64_t first(const Instruction& instruction)
+{
+    return instruction.operands()[0].number;
+}
+
+TEST(allocator_keeps_objects_of_an_early_return)
+{
+    // Both objects are only deleted on the path which returns early, so
+    // the string can't reuse their IDs after the jump
+    Module module;
+    module.functions = {Function{"main", true, {
+        S::objectMake(100, false, (int64_t) 1),
+        S::objectMake(101, false, (int64_t) 2),
+        S::compareEqual(100, 101),
+        S::jumpNotFlag("#skip"),
+        S::objectDelete(101),
+        S::objectDelete(100),
+        S::return_(),
+        S::label("#skip"),
+        S::objectMake(102, true, std::string("b")),
+        S::print(100),
+        S::print(102),
+        S::objectDelete(102),
+        S::objectDelete(101),
+        S::objectDelete(100),
+        S::return_()
+    }}};
+
+    std::string expected = test::run(module);
+    ObjectAllocator::compact(module);
+    const InstructionList& body = module.functions[0].body;
+
+    CHECK_EQ(expected, "1b");
+    CHECK_EQ(test::run(module), expected);
+
+    int64_t a = first(body[0]), b = first(body[1]), c = first(body[8]);
+    CHECK(a != b && a != c && b != c);
+    CHECK_EQ(first(body[9]), a);
+    CHECK_EQ(first(body[10]), c);
+    CHECK_EQ(first(body[13]), a);
+    CHECK_EQ(module.functions[0].object_slots, 3u);
+}
+
+TEST(allocator_reuses_ids_of_deleted_objects)
+{
+    Module module;
+    module.functions = {Function{"main", true, {
+        S::objectMake(100, true, std::string("a")),
+        S::print(100),
+        S::objectDelete(100),
+        S::objectMake(101, true, std::string("b")),
+        S::print(101),
+        S::objectDelete(101),
+        S::return_()
+    }}};
+
+    std::string expected = test::run(module);
+    ObjectAllocator::compact(module);
+
+    CHECK_EQ(test::run(module), expected);
+    CHECK_EQ(first(module.functions[0].body[3]), 0);
+    CHECK_EQ(module.functions[0].object_slots, 1u);
+    CHECK_EQ(module.object_slots, 1u);
+}
+
+TEST(allocator_gives_functions_their_own_ranges)
+{
+    // The callee must not get the ID of an object the caller still uses
+    Module module;
+    module.prelude = {S::objectMake(7, true, std::string("\n"))};
+    module.functions = {
+        Function{"main", true, {
+            S::objectMake(100, true, std::string("main")),
+            S::callLocal("f"),
+            S::print(100),
+            S::print(7),
+            S::objectDelete(100),
+            S::return_()
+        }},
+        Function{"f", false, {
+            S::objectMake(200, true, std::string("f")),
+            S::print(200),
+            S::print(7),
+            S::objectDelete(200),
+            S::return_()
+        }}
+    };
+
+    std::string expected = test::run(module);
+    ObjectAllocator::compact(module);
+
+    CHECK_EQ(test::run(module), expected);
+    CHECK_EQ(first(module.prelude[0]), 0);
+    CHECK_EQ(first(module.functions[0].body[0]), 1);
+    CHECK_EQ(first(module.functions[1].body[0]), 2);
+    CHECK_EQ(first(module.functions[1].body[2]), 0);
+    CHECK_EQ(module.functions[0].object_slots, 1u);
+    CHECK_EQ(module.functions[1].object_slots, 1u);
+    CHECK_EQ(module.object_slots, 3u);
+}
+
+TEST(allocator_keeps_shadowed_objects_apart)
+{
+    // 100 is created again while it's alive, so it keeps an ID of its own
+    // and the string created at the end can't take it
+    Module module;
+    module.functions = {Function{"main", true, {
+        S::objectMake(100, false, (int64_t) 1),
+        S::objectMake(101, false, (int64_t) 2),
+        S::print(101),
+        S::objectDelete(101),
+        S::objectMake(100, false, (int64_t) 3),
+        S::print(100),
+        S::objectDelete(100),
+        S::print(100),
+        S::objectDelete(100),
+        S::objectMake(102, true, std::string("x")),
+        S::print(102),
+        S::objectDelete(102),
+        S::return_()
+    }}};
+
+    std::string expected = test::run(module);
+    ObjectAllocator::compact(module);
+    const InstructionList& body = module.functions[0].body;
+
+    CHECK_EQ(expected, "231x");
+    CHECK_EQ(test::run(module), expected);
+    CHECK(first(body[0]) != first(body[1]));
+    CHECK_EQ(first(body[4]), first(body[0]));
+    CHECK_EQ(first(body[9]), first(body[1]));
+}
+
+TEST(allocator_follows_loops)
+{
+    // The counter is alive around the whole loop, the temporary only
+    // inside of it
+    Module module;
+    module.prelude = {S::objectMake(7, true, (int64_t) 3)};
+    module.functions = {Function{"main", true, {
+        S::objectMake(100, false, (int64_t) 0),
+        S::label("#top"),
+        S::objectMake(101, false, (int64_t) 10),
+        op("IXADD", {101, 100}),
+        S::print(101),
+        S::objectDelete(101),
+        S::intAdd(100, 1),
+        S::compareLessJumpFlag(100, 7, "#top"),
+        S::objectMake(102, true, std::string("end")),
+        S::print(102),
+        S::objectDelete(102),
+        S::objectDelete(100),
+        S::return_()
+    }}};
+
+    std::string expected = test::run(module);
+    ObjectAllocator::compact(module);
+    const InstructionList& body = module.functions[0].body;
+
+    CHECK_EQ(expected, "101112end");
+    CHECK_EQ(test::run(module), expected);
+    CHECK(first(body[0]) != first(body[2]));
+    CHECK_EQ(first(body[8]), first(body[2]));
+    CHECK_EQ(module.object_slots, 3u);
+}
+
+TEST(allocator_keeps_positions)
+{
+    SourcePosition position;
+    position.line = 4;
+    position.column = 2;
+
+    Module module;
+    module.functions = {Function{"main", true, {
+        Instruction(S::objectMake(100, true, std::string("a")), position),
+        Instruction(S::print(100), position),
+        Instruction(S::objectDelete(100), position),
+        S::return_()
+    }}};
+
+    ObjectAllocator::compact(module);
+    for (size_t i = 0; i < 3; i++)
+        CHECK(module.functions[0].body[i].position == position);
+}
@@ -0,0 +1,120 @@
+/**
+ * Tests of the OffsetIndex.
+ */
+#include "test.h"
+#include "../include/scc/bytecode_reader.h"
+#include "../include/scc/offset_index.h"
+#include "../include/scc/section_table.h"
+#include "../include/scc/validator.h"
+
+#include <string.h>
+
+using namespace salt;
+typedef Synthesizer S;
+
+/* A module with labels, jumps and instructions of different widths */
+static Module program()
+{
+    Module module;
+    module.prelude = {S::objectMake(0, true, std::string("hello\n")),
+                      S::objectMake(1, false, (int64_t) 70000)};
+    module.functions = {
+        Function{"main", true, {
+            S::print(0),
+            S::label("#x"),
+            S::intAdd(1, 1),
+            S::jumpTable(1, 0, "#x", {"#x", "#y"}),
+            S::label("#y"),
+            S::callLocal("f"),
+            S::return_()
+        }},
+        Function{"f", false, {S::print(0), S::return_()}}
+    };
+    return module;
+}
+
+/* Return the table of a file with an uncompressed table */
+static SectionTable sections(const std::string& bytes)
+{
+    uint amount;
+    memcpy(&amount, bytes.data() + 48, sizeof(amount));
+    return SectionTable::read(bytes, amount);
+}
+
+TEST(offset_index_round_trips)
+{
+    std::vector<size_t> offsets = {0, 3, 10, 70000, 70001};
+    std::vector<byte> section = OffsetIndex::make(offsets, 4);
+    CHECK_EQ(section.size(), 8 + 4 * OffsetIndex::ENTRY_SIZE);
+
+    for (uint i = 0; i < 4; i++)
+        CHECK_EQ(OffsetIndex::find(section.data(), section.size(), i),
+                 offsets[i]);
+
+    // The size of the code following the offsets isn't written
+    try {
+        OffsetIndex::find(section.data(), section.size(), 4);
+        CHECK(!"read past the section");
+    } catch (ValidatorError e) {
+        CHECK_EQ(e, ValidatorError::invalid_data_width);
+    }
+}
+
+TEST(offset_index_points_at_each_instruction)
+{
+    for (Encoding encoding : {ENCODING_FIXED, ENCODING_COMPACT}) {
+        S::setEncoding(encoding);
+        std::string bytes = test::image(program());
+        SectionTable table = sections(bytes);
+        const Section *code = table.find(SECTION_CODE);
+        const Section *offsets = table.find(SECTION_OFFSETS);
+        CHECK(code && offsets);
+        if (!code || !offsets)
+            continue;
+
+        const byte *data = (const byte *) bytes.data();
+        uint amount;
+        memcpy(&amount, data + offsets->offset, sizeof(amount));
+        CHECK_EQ(amount, (offsets->size - 8) / OffsetIndex::ENTRY_SIZE);
+
+        // Labels have an entry too, so the index is the instruction count
+        BytecodeReader reader(data + code->offset, code->size, encoding);
+        for (uint i = 0; i < amount; i++) {
+            CHECK_EQ(OffsetIndex::find(data + offsets->offset, offsets->size,
+                                       i), reader.tell());
+            reader.skipInstruction();
+        }
+        CHECK_EQ(reader.tell(), code->size);
+    }
+
+    S::setEncoding(ENCODING_FIXED);
+}
+
+TEST(offset_index_is_validated)
+{
+    std::string bytes = test::image(program());
+    const Section *offsets = sections(bytes).find(SECTION_OFFSETS);
+    CHECK(offsets);
+    if (!offsets)
+        return;
+
+    // An entry which points into the middle of an instruction
+    std::string wrong = bytes;
+    wrong[offsets->offset + 8 + 2 * OffsetIndex::ENTRY_SIZE]++;
+    try {
+        Validator(wrong).validate();
+        CHECK(!"accepted a wrong offset");
+    } catch (ValidatorError e) {
+        CHECK_EQ(e, ValidatorError::invalid_section);
+    }
+
+    // A count which doesn't match the header
+    std::string count = bytes;
+    count[offsets->offset]++;
+    try {
+        Validator(count).validate();
+        CHECK(!"accepted a wrong count");
+    } catch (ValidatorError e) {
+        CHECK_EQ(e, ValidatorError::invalid_section);
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * Tests of the source positions kept by the passes which rebuild
+ * instructions, read back from the debug table.
+ */
+#include "test.h"
+#include "../include/scc/debug_table.h"
+#include "../include/scc/inliner.h"
+#include "../include/scc/jump_tables.h"
+#include "../include/scc/loop_optimizer.h"
+#include "../include/scc/object_allocator.h"
+
+using namespace salt;
+using salt::test::op;
+typedef Synthesizer S;
+
+/* Put each instruction on a line of its own, starting at the given line */
+static InstructionList place(InstructionList body, uint line)
+{
+    for (Instruction& instruction : body) {
+        instruction.position.file = 0;
+        instruction.position.line = line++;
+        instruction.position.column = 1;
+    }
+
+    return body;
+}
+
+/* Compact the module and check that the debug table has the position of
+   every instruction in it */
+static void checkTable(Module& module)
+{
+    ObjectAllocator::compact(module);
+    InstructionList code = module.render();
+    std::vector<byte> table = DebugTable::make(code, {"test.salt"});
+
+    for (size_t i = 0; i < code.size(); i++) {
+        if (code[i].isLabel())
+            continue;
+        SourcePosition position;
+        CHECK(code[i].position.isKnown());
+        CHECK(DebugTable::find(table.data(), table.size(), i, position));
+        CHECK(position == code[i].position);
+    }
+}
+
+TEST(inliner_keeps_positions)
+{
+    Module module;
+    module.functions = {
+        Function{"main", true, place({
+            S::callLocal("f"),
+            S::return_()
+        }, 1)},
+        Function{"f", false, place({
+            S::objectMake(100, true, std::string("f")),
+            S::print(100),
+            S::objectDelete(100),
+            S::return_()
+        }, 10)}
+    };
+
+    Inliner(module).run();
+    const InstructionList& body = module.functions[0].body;
+
+    CHECK_EQ(test::find(body, "CALLF"), body.size());
+    CHECK_EQ(body[test::find(body, "PRINT")].position.line, 11u);
+    checkTable(module);
+}
+
+TEST(loop_optimizer_keeps_positions)
+{
+    Module module;
+    module.prelude = place({
+        S::objectMake(7, true, (int64_t) 4),
+        S::objectMake(8, true, (int64_t) 5)
+    }, 1);
+    module.functions = {Function{"main", true, place({
+        S::objectMake(100, false, (int64_t) 0),
+        S::label("#top"),
+        S::compareLessJumpNotFlag(100, 7, "#end"),
+        S::objectMake(101, false, (int64_t) 0),
+        op("IXADD", {101, 100}),
+        op("IXMUL", {101, 8}),
+        S::print(101),
+        S::objectDelete(101),
+        S::intAdd(100, 1),
+        S::jumpTo("#top"),
+        S::label("#end"),
+        S::objectDelete(100),
+        S::return_()
+    }, 10)}};
+
+    CHECK_EQ(LoopOptimizer::optimize(module).reduced, 1u);
+    const InstructionList& body = module.functions[0].body;
+
+    // The step of the product is at the multiplication, and its delete
+    // after the loop is where it was deleted in the loop
+    size_t step = test::find(body, "IVADD", test::find(body, "IVADD") + 1);
+    CHECK(step < body.size());
+    CHECK_EQ(body[step].position.line, 15u);
+    CHECK_EQ(body[test::find(body, "OBJDL")].position.line, 17u);
+    checkTable(module);
+}
+
+TEST(jump_tables_keep_positions)
+{
+    Module module;
+    InstructionList prelude, body = {S::objectMake(100, false, (int64_t) 3)};
+    for (int64_t key = 1; key <= 4; key++) {
+        prelude.push_back(S::objectMake(key, true, key));
+        body.push_back(S::compareEqual(100, key));
+        body.push_back(S::jumpFlag("#case" + std::to_string(key)));
+    }
+    body.push_back(S::jumpTo("#end"));
+    for (int64_t key = 1; key <= 4; key++) {
+        body.push_back(S::label("#case" + std::to_string(key)));
+        body.push_back(S::print(key));
+        body.push_back(S::jumpTo("#end"));
+    }
+    body.push_back(S::label("#end"));
+    body.push_back(S::objectDelete(100));
+    body.push_back(S::return_());
+
+    module.prelude = place(prelude, 1);
+    module.functions = {Function{"main", true, place(body, 10)}};
+
+    CHECK_EQ(JumpTables::build(module), 1u);
+    const InstructionList& built = module.functions[0].body;
+
+    CHECK_EQ(built[test::find(built, "JMPTB")].position.line, 11u);
+    checkTable(module);
+}
@@ -0,0 +1,124 @@
+/**
+ * Tests of the StreamValidator.
+ */
+#include "test.h"
+#include "../include/scc/section_table.h"
+#include "../include/scc/stream_validator.h"
+#include "../include/scc/validator.h"
+
+#include <sstream>
+#include <string.h>
+
+using namespace salt;
+typedef Synthesizer S;
+
+/* Sentinel for a file which passes the validation */
+static const int VALID = -1;
+
+/* A module with a long string, so instructions and strings span blocks */
+static Module program(size_t prints = 1)
+{
+    Module module;
+    module.prelude = {S::objectMake(0, true, std::string("hello\n")),
+                      S::objectMake(1, true, std::string(300, 'x'))};
+
+    InstructionList body;
+    for (size_t i = 0; i < prints; i++)
+        body.push_back(S::print(i % 2));
+    body.push_back(S::callLocal("f"));
+    body.push_back(S::return_());
+
+    module.functions = {
+        Function{"main", true, body},
+        Function{"f", false, {S::print(0), S::return_()}}
+    };
+    return module;
+}
+
+/* Feed the bytes in blocks, and return the error or VALID */
+static int validate(const std::string& bytes, size_t block)
+{
+    StreamValidator validator;
+    try {
+        for (size_t i = 0; i < bytes.size(); i += block)
+            validator.feed((const byte *) bytes.data() + i,
+                           std::min(block, bytes.size() - i));
+        validator.finish();
+    } catch (ValidatorError e) {
+        return e;
+    }
+
+    return VALID;
+}
+
+TEST(stream_validator_accepts_written_files)
+{
+    for (Encoding encoding : {ENCODING_FIXED, ENCODING_COMPACT}) {
+        S::setEncoding(encoding);
+        std::string bytes = test::image(program(2000));
+
+        // Every split of the header, table, instructions and strings
+        for (size_t block : {(size_t) 1, (size_t) 3, (size_t) 64, (size_t) 4096,
+                             bytes.size()})
+            CHECK_EQ(validate(bytes, block), VALID);
+
+        // Each print adds one instruction, wherever the blocks end
+        std::istringstream stream(bytes);
+        std::istringstream empty(test::image(program(0)));
+        StreamValidator validator, baseline;
+        validator.validate(stream);
+        baseline.validate(empty);
+        CHECK_EQ(validator.getInstructionCount(),
+                 baseline.getInstructionCount() + 2000);
+    }
+
+    S::setEncoding(ENCODING_FIXED);
+}
+
+TEST(stream_validator_agrees_with_the_validator)
+{
+    std::string bytes = test::image(program(50));
+    uint amount;
+    memcpy(&amount, bytes.data() + 48, sizeof(amount));
+    const Section code = *SectionTable::read(bytes, amount)
+            .find(SECTION_CODE);
+
+    // Break every byte of the code in turn, both have to reject the same
+    // ones, though the stream may notice a different error first
+    for (size_t i = code.offset; i < code.offset + code.size; i++) {
+        std::string broken = bytes;
+        broken[i] = (char) 0xff;
+
+        int expected = VALID;
+        try {
+            Validator(broken).validate();
+        } catch (ValidatorError e) {
+            expected = e;
+        }
+
+        // The stream validator can't check the offset index
+        if (expected == ValidatorError::invalid_section)
+            continue;
+        CHECK_EQ(validate(broken, 7) == VALID, expected == VALID);
+    }
+}
+
+TEST(stream_validator_rejects_bad_files)
+{
+    std::string bytes = test::image(program());
+
+    std::string magic = bytes;
+    magic[1] = 'X';
+    CHECK_EQ(validate(magic, 64), ValidatorError::invalid_header);
+
+    // The last section no longer fits, or the header is cut short
+    CHECK_EQ(validate(bytes.substr(0, bytes.size() - 1), 64),
+             ValidatorError::invalid_section);
+    CHECK_EQ(validate(bytes.substr(0, 40), 64),
+             ValidatorError::invalid_header);
+    CHECK_EQ(validate(bytes + "x", 64), ValidatorError::invalid_header);
+
+    // Compressed sections have to be expanded by the Validator
+    CHECK_EQ(validate(test::image(program(), COMPRESSION_SMALL), 64),
+             ValidatorError::invalid_compression);
+}
@@ -0,0 +1,115 @@
+/**
+ * Tests of the TailCalls pass.
+ */
+#include "test.h"
+#include "../include/scc/tail_calls.h"
+
+using namespace salt;
+using salt::test::op;
+typedef Synthesizer S;
+
+TEST(tail_calls_keep_objects_the_callee_reads)
+{
+    // show prints the object of main, so it can't be deleted before
+    Module module;
+    module.functions = {
+        Function{"main", true, {
+            S::objectMake(100, true, std::string("x")),
+            S::callLocal("show"),
+            S::objectDelete(100),
+            S::return_()
+        }},
+        Function{"show", false, {S::print(100), S::return_()}}
+    };
+
+    std::string expected = test::run(module);
+    CHECK_EQ(TailCalls::lower(module), 0u);
+    CHECK_EQ(expected, "x");
+    CHECK_EQ(test::run(module), expected);
+    CHECK_EQ(test::find(module.functions[0].body, "CALLF"), 1u);
+}
+
+TEST(tail_calls_keep_objects_of_nested_callees)
+{
+    // show only passes the object on, and print reads it
+    Module module;
+    module.functions = {
+        Function{"main", true, {
+            S::objectMake(100, true, std::string("x")),
+            S::callLocal("show"),
+            S::objectDelete(100),
+            S::return_()
+        }},
+        Function{"show", false, {S::callLocal("print"), S::return_()}},
+        Function{"print", false, {S::print(100), S::return_()}}
+    };
+
+    TailCalls::lower(module);
+    CHECK_EQ(test::run(module), "x");
+    CHECK_EQ(test::find(module.functions[0].body, "CALLF"), 1u);
+}
+
+TEST(tail_calls_replace_calls_to_unrelated_functions)
+{
+    Module module;
+    module.functions = {
+        Function{"main", true, {
+            S::objectMake(100, true, std::string("x")),
+            S::print(100),
+            S::callLocal("show"),
+            S::objectDelete(100),
+            S::return_()
+        }},
+        Function{"show", false, {
+            S::objectMake(100, true, std::string("y")),
+            S::print(100),
+            S::objectDelete(100),
+            S::return_()
+        }}
+    };
+
+    std::string expected = test::run(module);
+    CHECK_EQ(TailCalls::lower(module), 1u);
+    CHECK_EQ(expected, "xy");
+    CHECK_EQ(test::run(module), expected);
+
+    const InstructionList& body = module.functions[0].body;
+    CHECK_EQ(test::find(body, "OBJDL"), 2u);
+    CHECK_EQ(test::find(body, "JMPTO"), 3u);
+}
+
+TEST(tail_calls_turn_recursion_into_a_loop)
+{
+    // Count down from 3, passing the counter in a register
+    Module module;
+    module.functions = {
+        Function{"main", true, {
+            S::objectMake(100, false, (int64_t) 3),
+            op("RPUSH", {0, 100}),
+            S::callLocal("count"),
+            S::return_()
+        }},
+        Function{"count", false, {
+            op("RGPOP", {0, 100}),
+            S::print(100),
+            S::objectMake(101, true, (int64_t) 0),
+            S::compareEqualJumpFlag(100, 101, "#done"),
+            op("IVSUB", {100, 1}),
+            op("RPUSH", {0, 100}),
+            S::callLocal("count"),
+            S::objectDelete(101),
+            S::return_(),
+            S::label("#done"),
+            S::objectDelete(101),
+            S::objectDelete(100),
+            S::return_()
+        }}
+    };
+
+    std::string expected = test::run(module);
+    CHECK_EQ(TailCalls::lower(module), 2u);
+    CHECK_EQ(expected, "3210");
+    CHECK_EQ(test::run(module), expected);
+    CHECK_EQ(test::find(module.functions[1].body, "CALLF"),
+             module.functions[1].body.size());
+}
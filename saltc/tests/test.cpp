@@ -0,0 +1,381 @@
+/**
+ * test.h implementation, and the main function running all the tests.
+ */
+#include "test.h"
+#include "../include/source_file.h"
+
+#include <filesystem>
+#include <map>
+#include <stdio.h>
+
+namespace salt::test
+{
+
+namespace
+{
+    struct Test
+    {
+        const char *name;
+        void (*run)();
+    };
+
+    std::vector<Test>& tests()
+    {
+        static std::vector<Test> registered;
+        return registered;
+    }
+
+    uint failures = 0;
+
+    /* A single object of the model, the type is a Synthesizer type */
+    struct Object
+    {
+        byte type = Synthesizer::TYPE_NULL;
+        int64_t number = 0;
+        double real = 0;
+        std::string text;
+        bool readonly = false;
+
+        bool isNumber() const
+        {
+            return type == Synthesizer::TYPE_INT
+                || type == Synthesizer::TYPE_FLOAT;
+        }
+
+        double toDouble() const
+        {
+            return type == Synthesizer::TYPE_FLOAT ? real : (double) number;
+        }
+
+        std::string format() const
+        {
+            char buf[32];
+            switch (type) {
+                case Synthesizer::TYPE_INT:
+                    snprintf(buf, sizeof(buf), "%lld", (long long) number);
+                    return buf;
+                case Synthesizer::TYPE_FLOAT:
+                    snprintf(buf, sizeof(buf), "%f", real);
+                    return buf;
+                case Synthesizer::TYPE_BOOL:
+                    return number ? "true" : "false";
+                case Synthesizer::TYPE_STRING:
+                    return text;
+                default:
+                    return "null";
+            }
+        }
+
+        bool equals(const Object& other) const
+        {
+            if (isNumber() && other.isNumber())
+                return toDouble() == other.toDouble();
+            if (type != other.type)
+                return false;
+            return type == Synthesizer::TYPE_STRING ? text == other.text
+                                                    : number == other.number;
+        }
+
+        bool lessThan(const Object& other) const
+        {
+            if (isNumber() && other.isNumber())
+                return toDouble() < other.toDouble();
+            if (type != other.type)
+                return false;
+            if (type == Synthesizer::TYPE_STRING)
+                return text < other.text;
+            return type == Synthesizer::TYPE_BOOL && number < other.number;
+        }
+    };
+
+    /* Give up on modules which don't stop */
+    const size_t STEP_LIMIT = 1000000;
+}
+
+bool add(const char *name, void (*run)())
+{
+    tests().push_back({name, run});
+    return true;
+}
+
+void fail(const char *file, int line, const std::string& what)
+{
+    printf("    %s:%d: failed %s\n", file, line, what.c_str());
+    failures++;
+}
+
+Instruction op(const std::string& name, std::vector<int64_t> numbers,
+               std::vector<std::string> strings)
+{
+    const InstructionInfo *info = InstructionSet::find(name);
+    std::vector<Operand> operands;
+    size_t number = 0, string = 0;
+
+    for (OperandType type : info->operands) {
+        Operand operand;
+        operand.type = type;
+        if (type == OPERAND_STRING)
+            operand.text = strings.at(string++);
+        else if (type == OPERAND_LABELS)
+            operand.labels.assign(strings.begin() + string, strings.end());
+        else
+            operand.number = numbers.at(number++);
+        operands.push_back(operand);
+    }
+
+    return Instruction(Synthesizer::assemble(name, operands));
+}
+
+std::string run(const Module& module)
+{
+    InstructionList code = module.render();
+    std::map<std::string, size_t> labels;
+    for (size_t i = 0; i < code.size(); i++) {
+        if (code[i].isLabel())
+            labels[code[i].name()] = i;
+    }
+
+    std::map<uint, std::vector<Object>> tape;
+    std::map<int64_t, Object> registers;
+    std::vector<size_t> frames;
+    std::string output;
+    bool flag = false;
+
+    auto get = [&](int64_t id) -> Object& {
+        auto found = tape.find((uint) id);
+        if (found == tape.end() || found->second.empty())
+            throw "unknown object ID " + std::to_string(id);
+        return found->second.back();
+    };
+
+    auto getInt = [&](int64_t id) -> Object& {
+        Object& object = get(id);
+        if (object.type != Synthesizer::TYPE_INT)
+            throw "object " + std::to_string(id) + " is not an int";
+        return object;
+    };
+
+    auto getWritable = [&](int64_t id) -> Object& {
+        Object& object = getInt(id);
+        if (object.readonly)
+            throw "object " + std::to_string(id) + " is readonly";
+        return object;
+    };
+
+    // Ints wrap around like in the virtual machine
+    auto addInt = [&](int64_t id, int64_t value) {
+        Object& object = getWritable(id);
+        object.number = (int64_t) ((uint64_t) object.number
+                                   + (uint64_t) value);
+    };
+
+    auto take = [&](int64_t id) {
+        Object object = get(id);
+        tape[(uint) id].pop_back();
+        return object;
+    };
+
+    // Jumps continue after the label, so they don't run into it
+    auto jump = [&](const std::string& label) {
+        auto found = labels.find(label);
+        if (found == labels.end())
+            throw "unknown label '" + label + "'";
+        return found->second + 1;
+    };
+
+    // Returning from the outermost frame ends the prelude, which then calls
+    // the main function, or ends the program
+    size_t pc = 0;
+    bool prelude = true;
+    auto leave = [&]() {
+        if (!frames.empty()) {
+            pc = frames.back();
+            frames.pop_back();
+            return true;
+        }
+        if (prelude && labels.count("main")) {
+            prelude = false;
+            pc = jump("main");
+            return true;
+        }
+        return false;
+    };
+
+    try {
+        for (size_t steps = 0;; steps++) {
+            if (steps == STEP_LIMIT)
+                throw std::string("too many steps");
+
+            // Running into a function label or off the end returns
+            if (pc >= code.size() || (code[pc].isLabel()
+                                      && code[pc].name()[0] != '#')) {
+                if (!leave())
+                    break;
+                continue;
+            }
+
+            const Instruction& instruction = code[pc++];
+            if (instruction.isLabel())
+                continue;
+
+            std::string name = instruction.name();
+            std::vector<Operand> o = instruction.operands();
+
+            if (name == "OBJMK") {
+                Object object;
+                object.type = o[1].object_type;
+                object.number = o[1].number;
+                object.real = o[1].real;
+                object.text = o[1].text;
+                object.readonly = o[1].readonly;
+                tape[(uint) o[0].number].push_back(object);
+            } else if (name == "OBJDL") {
+                take(o[0].number);
+            } else if (name == "PRINT") {
+                output += get(o[0].number).format();
+            } else if (name == "CXXEQ" || name == "CEQJF" || name == "CEQJN") {
+                flag = get(o[0].number).equals(get(o[1].number));
+            } else if (name == "CXXLT" || name == "CLTJF" || name == "CLTJN") {
+                flag = get(o[0].number).lessThan(get(o[1].number));
+            } else if (name == "IVADD" || name == "IVAEQ" || name == "IVALT") {
+                addInt(o[0].number, o[1].number);
+                if (name == "IVAEQ")
+                    flag = get(o[2].number).equals(get(o[3].number));
+                else if (name == "IVALT")
+                    flag = get(o[2].number).lessThan(get(o[3].number));
+            } else if (name == "IVSUB") {
+                addInt(o[0].number, -o[1].number);
+            } else if (name[0] == 'I' && name[1] == 'X') {
+                Object& target = getWritable(o[0].number);
+                const Object& value = get(o[1].number);
+                if (!value.isNumber())
+                    throw "object " + std::to_string(o[1].number)
+                        + " is not a number";
+                if (name == "IXDIV" && value.toDouble() == 0)
+                    throw std::string("division by zero");
+                if (value.type == Synthesizer::TYPE_INT) {
+                    uint64_t left = (uint64_t) target.number;
+                    uint64_t right = (uint64_t) value.number;
+                    if (name == "IXDIV" && value.number == -1
+                            && target.number == INT64_MIN)
+                        throw std::string("integer overflow in division");
+                    if (name == "IXADD")
+                        target.number = (int64_t) (left + right);
+                    else if (name == "IXSUB")
+                        target.number = (int64_t) (left - right);
+                    else if (name == "IXMUL")
+                        target.number = (int64_t) (left * right);
+                    else
+                        target.number /= value.number;
+                } else {
+                    double right = value.toDouble();
+                    double left = (double) target.number;
+                    if (name == "IXADD")
+                        left += right;
+                    else if (name == "IXSUB")
+                        left -= right;
+                    else if (name == "IXMUL")
+                        left *= right;
+                    else
+                        left /= right;
+                    if (!(left >= -0x1p63 && left < 0x1p63))
+                        throw std::string("float result doesn't fit in an "
+                                          "int");
+                    target.number = (int64_t) left;
+                }
+            } else if (name == "RGPOP") {
+                tape[(uint) o[1].number].push_back(registers[o[0].number]);
+                registers.erase(o[0].number);
+            } else if (name == "RPUSH") {
+                registers[o[0].number] = take(o[1].number);
+            } else if (name == "RNULL") {
+                registers.clear();
+            } else if (name == "CALLF") {
+                frames.push_back(pc);
+                pc = jump(o[0].text);
+            } else if (name == "RETRN") {
+                if (!leave())
+                    break;
+            } else if (name == "EXITE" || name == "KILLX") {
+                break;
+            } else if (name == "CALLX" || name == "EXTLD") {
+                throw name + " is not supported";
+            }
+
+            // Conditional jumps use the flag set above
+            if (name == "JMPTO" || (name == "JMPFL" && flag)
+                    || (name == "JMPNF" && !flag)
+                    || (name == "CEQJF" && flag) || (name == "CEQJN" && !flag)
+                    || (name == "CLTJF" && flag) || (name == "CLTJN" && !flag))
+                pc = jump(o.back().text);
+            else if (name == "JMPTB") {
+                int64_t index = getInt(o[0].number).number - o[1].number;
+                flag = index >= 0 && index < (int64_t) o[3].labels.size();
+                pc = jump(flag ? o[3].labels[index] : o[2].text);
+            } else if (name == "JMPBS") {
+                int64_t value = getInt(o[0].number).number;
+                std::string label = o[1].text;
+                flag = false;
+                for (size_t i = 0; i < o[2].keys.size(); i++) {
+                    if (o[2].keys[i] == value) {
+                        label = o[2].labels[i];
+                        flag = true;
+                    }
+                }
+                pc = jump(label);
+            }
+        }
+    } catch (const std::string& error) {
+        output += "error: " + error;
+    }
+
+    return output;
+}
+
+std::string image(const Module& module, Compression compression)
+{
+    // The source file only has to exist, its module is replaced
+    std::filesystem::path path = std::filesystem::temp_directory_path()
+                               / "salt_test.salt";
+    save_file(path.string(), {});
+
+    SourceFile source(path.string());
+    source.module = module;
+    source.setCompression(compression);
+
+    std::vector<byte> body = source.makeSCCBody();
+    std::array<byte, 64> header = source.makeSCCHeader();
+    std::string bytes(header.begin(), header.end());
+    bytes.append(body.begin(), body.end());
+    return bytes;
+}
+
+size_t find(const InstructionList& body, const std::string& name,
+            size_t from)
+{
+    for (size_t i = from; i < body.size(); i++) {
+        if (body[i].name() == name)
+            return i;
+    }
+
+    return body.size();
+}
+
+} // salt::test
+
+int main()
+{
+    using namespace salt::test;
+
+    uint failed = 0;
+    for (const Test& test : tests()) {
+        uint before = failures;
+        printf("%s\n", test.name);
+        test.run();
+        if (failures != before)
+            failed++;
+    }
+
+    printf("%zu tests, %u failed\n", tests().size(), failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * A small unit test framework for the compiler passes. Each test is a
+ * function registered with the TEST macro, and the CHECK macros report the
+ * failed expression with its file and line, without stopping the test.
+ *
+ * The tests build modules directly out of Synthesizer calls, run them
+ * through a pass and compare the result, either instruction by instruction
+ * or by running the module before and after the pass on a small model of
+ * the virtual machine.
+ */
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "../include/utils.h"
+#include "../include/scc/compressor.h"
+#include "../include/scc/instruction.h"
+#include "../include/scc/module.h"
+#include "../include/scc/synthesizer.h"
+
+namespace salt::test
+{
+
+    /* Register the test, always returns true */
+    bool add(const char *name, void (*run)());
+
+    /* Report a failed check of the running test */
+    void fail(const char *file, int line, const std::string& what);
+
+    /**
+     * Assemble an instruction out of plain values. The numbers fill the ID,
+     * immediate and register operands in order, the strings fill the string
+     * operands and then the list of labels of a jump table.
+     *
+     * @param   name     mnemonic of the instruction
+     * @param   numbers  IDs, immediates and registers
+     * @param   strings  labels and other strings
+     * @return  the instruction
+     */
+    Instruction op(const std::string& name, std::vector<int64_t> numbers,
+                   std::vector<std::string> strings = {});
+
+    /**
+     * Run the module on a small model of the virtual machine, which runs the
+     * prelude and then calls the main function, like the SVM does.
+     * Only the calls within the module are supported. A runtime error ends
+     * the output with "error: " and the reason.
+     *
+     * @param   module  module to run
+     * @return  everything the module printed
+     */
+    std::string run(const Module& module);
+
+    /**
+     * Write the module the way the compiler writes its output file, with
+     * the header followed by the sections.
+     *
+     * @param   module       module to write
+     * @param   compression  compression of the sections
+     * @return  bytes of the SCC file
+     */
+    std::string image(const Module& module,
+                      Compression compression = COMPRESSION_NONE);
+
+    /* Return the index of the first instruction with the mnemonic */
+    size_t find(const InstructionList& body, const std::string& name,
+                size_t from = 0);
+
+} // salt::test
+
+#define TEST(name)                                                            \
+    static void test_##name();                                                \
+    static bool registered_##name = salt::test::add(#name, test_##name);      \
+    static void test_##name()
+
+#define CHECK(expression)                                                     \
+    do {                                                                      \
+        if (!(expression))                                                    \
+            salt::test::fail(__FILE__, __LINE__, #expression);                \
+    } while (0)
+
+#define CHECK_EQ(left, right)                                                 \
+    do {                                                                      \
+        if (!((left) == (right)))                                             \
+            salt::test::fail(__FILE__, __LINE__, #left " == " #right);        \
+    } while (0)
+
+#endif // TEST_H_
@@ -0,0 +1,55 @@
+/**
+ * Tests of the TreeShaker.
+ */
+#include "test.h"
+#include "../include/scc/tree_shaker.h"
+
+using namespace salt;
+typedef Synthesizer S;
+
+/* Module loading the library, without calling into it */
+static Module importer(const std::string& library)
+{
+    Module module;
+    module.name = "main";
+    module.prelude = {S::externalLoad(library)};
+    module.functions = {Function{"main", true, {S::return_()}}};
+    return module;
+}
+
+TEST(tree_shaker_keeps_imports_of_unknown_modules)
+{
+    // The prelude of a module which wasn't passed could do anything
+    Module module = importer("builtins");
+    TreeShaker({&module}).shake();
+
+    CHECK_EQ(test::find(module.prelude, "EXTLD"), 0u);
+}
+
+TEST(tree_shaker_keeps_imports_with_side_effects)
+{
+    Module library;
+    library.name = "library";
+    library.prelude = {
+        S::objectMake(0, true, std::string("loaded\n")),
+        S::print(0)
+    };
+
+    Module module = importer("library");
+    TreeShaker({&module, &library}).shake();
+
+    CHECK_EQ(test::find(module.prelude, "EXTLD"), 0u);
+}
+
+TEST(tree_shaker_removes_pure_imports)
+{
+    Module library;
+    library.name = "library";
+    library.prelude = {S::objectMake(0, true, std::string("unused\n"))};
+
+    Module module = importer("library");
+    TreeShaker::Report report = TreeShaker({&module, &library}).shake();
+
+    CHECK(module.prelude.empty());
+    CHECK_EQ(report.removed.size(), 2u);
+}
@@ -0,0 +1,141 @@
+/**
+ * Tests of the Validator against corrupted files.
+ */
+#include "test.h"
+#include "../include/scc/section_table.h"
+#include "../include/scc/validator.h"
+
+#include <string.h>
+
+using namespace salt;
+typedef Synthesizer S;
+
+/* Sentinel for a file which passes the validation */
+static const int VALID = -1;
+
+/* A small module with a constant, a label and a call */
+static Module program(size_t prints = 1)
+{
+    Module module;
+    module.prelude = {S::objectMake(0, true, std::string("hello\n"))};
+
+    InstructionList body;
+    for (size_t i = 0; i < prints; i++)
+        body.push_back(S::print(0));
+    body.push_back(S::callLocal("f"));
+    body.push_back(S::return_());
+
+    module.functions = {
+        Function{"main", true, body},
+        Function{"f", false, {S::print(0), S::return_()}}
+    };
+    return module;
+}
+
+/* Validate the bytes, and return the error or VALID */
+static int validate(const std::string& bytes, uint threads = 1)
+{
+    Validator validator(bytes);
+    validator.setThreads(threads);
+    try {
+        validator.validate();
+    } catch (ValidatorError e) {
+        return e;
+    }
+
+    return VALID;
+}
+
+/* Return the code section of a file with an uncompressed table */
+static Section code(const std::string& bytes)
+{
+    uint amount;
+    memcpy(&amount, bytes.data() + 48, sizeof(amount));
+    return *SectionTable::read(bytes, amount).find(SECTION_CODE);
+}
+
+TEST(validator_accepts_written_files)
+{
+    for (Encoding encoding : {ENCODING_FIXED, ENCODING_COMPACT}) {
+        S::setEncoding(encoding);
+        CHECK_EQ(validate(test::image(program())), VALID);
+        CHECK_EQ(validate(test::image(program(), COMPRESSION_SMALL)), VALID);
+    }
+
+    S::setEncoding(ENCODING_FIXED);
+}
+
+TEST(validator_rejects_a_bad_header)
+{
+    std::string bytes = test::image(program());
+
+    std::string magic = bytes;
+    magic[1] = 'X';
+    CHECK_EQ(validate(magic), ValidatorError::invalid_header);
+
+    // The header holds the size of the whole file
+    std::string size = bytes;
+    size[24]++;
+    CHECK_EQ(validate(size), ValidatorError::invalid_header);
+    CHECK_EQ(validate(bytes.substr(0, 32)), ValidatorError::invalid_header);
+
+    // The last section doesn't fit anymore
+    std::string truncated = bytes.substr(0, bytes.size() - 1);
+    CHECK_EQ(validate(truncated), ValidatorError::invalid_section);
+
+    std::string width = bytes;
+    width[32] = 7;
+    CHECK_EQ(validate(width), ValidatorError::instruction_width_violation);
+}
+
+TEST(validator_skips_a_missing_width)
+{
+    // Older files leave the maximum instruction width at zero
+    std::string bytes = test::image(program());
+    memset(&bytes[32], 0, 4);
+    CHECK_EQ(validate(bytes), VALID);
+}
+
+TEST(validator_rejects_bad_sections)
+{
+    std::string bytes = test::image(program());
+
+    // The section table starts right after the header
+    std::string type = bytes;
+    memset(&type[64], 0xff, 4);
+    CHECK(validate(type) != VALID);
+
+    std::string size = bytes;
+    uint64_t huge = 1ull << 40;
+    memcpy(&size[64 + 16], &huge, sizeof(huge));
+    CHECK(validate(size) != VALID);
+}
+
+TEST(validator_rejects_bad_instructions)
+{
+    std::string bytes = test::image(program());
+    Section section = code(bytes);
+
+    std::string opcode = bytes;
+    opcode[section.offset] = (char) 0xff;
+    CHECK_EQ(validate(opcode), ValidatorError::unknown_instruction);
+
+    // A call to a label cut short runs into the next instruction
+    std::string operand = bytes;
+    operand[section.offset + section.size - 1] = (char) 0xff;
+    CHECK(validate(operand) != VALID);
+}
+
+TEST(validator_finds_the_same_error_on_threads)
+{
+    // Big enough to be split into ranges
+    std::string bytes = test::image(program(Validator::PARALLEL_MIN_SIZE));
+    Section section = code(bytes);
+    CHECK_EQ(validate(bytes, 4), VALID);
+
+    // A PRINT is 5 bytes, so one of them is an opcode
+    std::string late = bytes;
+    memset(&late[section.offset + section.size * 3 / 4], 0xff, 5);
+    CHECK_EQ(validate(late, 4), ValidatorError::unknown_instruction);
+    CHECK_EQ(validate(late, 1), ValidatorError::unknown_instruction);
+}
@@ -0,0 +1,154 @@
+/**
+ * Tests of the Verifier.
+ */
+#include "test.h"
+#include "../include/scc/validator.h"
+#include "../include/scc/verifier.h"
+
+using namespace salt;
+using salt::test::op;
+typedef Synthesizer S;
+
+/* Sentinel for a module which was fully proven */
+static const int PROVEN = -1;
+
+/* Sentinel for a module which was checked, but not fully proven */
+static const int UNPROVEN = -2;
+
+/* Verify the module, and return the error or one of the sentinels */
+static int verify(const Module& module)
+{
+    Verifier verifier(module);
+    try {
+        verifier.verify();
+    } catch (ValidatorError e) {
+        return e;
+    }
+
+    return verifier.isProven() ? PROVEN : UNPROVEN;
+}
+
+TEST(verifier_proves_calls_which_keep_the_tape)
+{
+    Module module;
+    module.prelude = {S::objectMake(0, true, std::string("x"))};
+    module.functions = {
+        Function{"main", true, {
+            S::objectMake(100, false, (int64_t) 1),
+            S::callLocal("f"),
+            S::print(100),
+            S::print(0),
+            S::objectDelete(100),
+            S::return_()
+        }},
+        Function{"f", false, {
+            S::objectMake(200, false, (int64_t) 2),
+            S::print(200),
+            S::print(0),
+            S::objectDelete(200),
+            S::return_()
+        }}
+    };
+
+    CHECK_EQ(verify(module), PROVEN);
+}
+
+TEST(verifier_rejects_a_callee_deleting_module_objects)
+{
+    // The caller still reads the object after the call
+    Module module;
+    module.prelude = {S::objectMake(100, false, (int64_t) 1)};
+    module.functions = {
+        Function{"main", true, {
+            S::callLocal("kill"),
+            S::print(100),
+            S::return_()
+        }},
+        Function{"kill", false, {
+            S::objectDelete(100),
+            S::return_()
+        }}
+    };
+
+    CHECK_EQ(test::run(module), "error: unknown object ID 100");
+    CHECK_EQ(verify(module), ValidatorError::undeleted_object);
+}
+
+TEST(verifier_rejects_a_callee_creating_module_objects_again)
+{
+    // The caller would take the string for an int
+    Module module;
+    module.prelude = {S::objectMake(100, false, (int64_t) 1)};
+    module.functions = {
+        Function{"main", true, {
+            S::callLocal("swap"),
+            S::intAdd(100, 1),
+            S::return_()
+        }},
+        Function{"swap", false, {
+            S::objectMake(100, false, std::string("s")),
+            S::return_()
+        }}
+    };
+
+    CHECK_EQ(verify(module), ValidatorError::undeleted_object);
+
+    // Taking it into a register is the same as deleting it
+    module.functions[1].body = {op("RPUSH", {0, 100}), S::return_()};
+    CHECK_EQ(verify(module), ValidatorError::undeleted_object);
+}
+
+TEST(verifier_rejects_calls_after_deleting_module_objects)
+{
+    // Main never returns, but the callee expects the object
+    Module module;
+    module.prelude = {S::objectMake(100, false, (int64_t) 1)};
+    module.functions = {
+        Function{"main", true, {
+            S::objectDelete(100),
+            S::callLocal("f"),
+            S::exit()
+        }},
+        Function{"f", false, {
+            S::print(100),
+            S::return_()
+        }}
+    };
+
+    CHECK_EQ(verify(module), ValidatorError::unknown_id);
+
+    // Deleting it without calling anything is fine
+    module.functions[0].body = {S::objectDelete(100), S::exit()};
+    CHECK_EQ(verify(module), PROVEN);
+}
+
+TEST(verifier_checks_calls_of_the_prelude)
+{
+    // The function runs before the prelude created the object
+    Module module;
+    module.prelude = {
+        S::callLocal("f"),
+        S::objectMake(100, false, (int64_t) 1)
+    };
+    module.functions = {
+        Function{"main", true, {S::return_()}},
+        Function{"f", false, {S::print(100), S::return_()}}
+    };
+
+    CHECK_EQ(verify(module), ValidatorError::unknown_id);
+
+    // An object with another type at the call
+    module.prelude = {
+        S::objectMake(100, false, std::string("s")),
+        S::callLocal("f"),
+        S::objectDelete(100),
+        S::objectMake(100, false, (int64_t) 1)
+    };
+    CHECK_EQ(verify(module), ValidatorError::invalid_type);
+
+    module.prelude = {
+        S::objectMake(100, false, (int64_t) 1),
+        S::callLocal("f")
+    };
+    CHECK_EQ(verify(module), PROVEN);
+}
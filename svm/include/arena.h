@@ -0,0 +1,171 @@
+/**
+ * Arenas hold all the memory of a module, so it can be limited, counted and
+ * freed at once.
+ *
+ */
+#ifndef SVM_ARENA_H_
+#define SVM_ARENA_H_
+
+#include <array>
+#include <vector>
+#include <stddef.h>
+
+#include "../../saltc/include/utils.h"
+
+namespace svm
+{
+
+    /**
+     * A bump allocator over chunks which double in size, from FIRST_CHUNK up
+     * to MAX_CHUNK. Freed blocks go to a free list of their size class, and
+     * are handed out again before the chunk grows: up to SMALL_LIMIT the
+     * classes are 16 bytes apart, larger blocks are rounded up to a power of
+     * two. Blocks larger than LARGE_BLOCK, like the buffers of a growing
+     * vector, get a chunk of their own, which is freed with them.
+     *
+     * Every module has its own arena for its tape, its strings and its
+     * decoded code, and the interpreter has one for the call frames.
+     * Deleting an arena frees all of its chunks at once, without visiting
+     * the blocks in them.
+     *
+     * The totals of all arenas are kept together, so the memory limit is
+     * only checked when an arena needs a new chunk, and the amount of memory
+     * in use is exact, as nothing bypasses the arenas.
+     */
+    class Arena
+    {
+    public:
+
+        constexpr static size_t ALIGNMENT = 16;
+        constexpr static size_t SMALL_LIMIT = 512;
+        constexpr static size_t LARGE_BLOCK = 4096;
+        constexpr static size_t FIRST_CHUNK = 4096;
+        constexpr static size_t MAX_CHUNK = 1 << 20;
+
+        Arena() = default;
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        /* Free every chunk of the arena */
+        ~Arena();
+
+        /**
+         * Allocate a block of at least @a __n bytes, aligned to ALIGNMENT.
+         *
+         * @param   __n  size of the block
+         * @return  the block
+         * @throw   RuntimeError if the memory limit is reached
+         */
+        void *allocate(size_t __n);
+
+        /**
+         * Give a block back to the arena.
+         *
+         * @param   __p  block from allocate()
+         * @param   __n  size it was allocated with
+         */
+        void free(void *__p, size_t __n);
+
+        /* Bytes handed out by this arena and not freed yet */
+        size_t getUsed() const;
+
+        /**
+         * Limit the bytes of all chunks of all arenas together.
+         *
+         * @param   __n  limit in bytes, 0 for none
+         */
+        static void setLimit(size_t __n);
+
+        /* Bytes handed out by all arenas, now and at most */
+        static size_t getTotalUsed();
+        static size_t getPeakUsed();
+
+        /* Bytes of all chunks of all arenas */
+        static size_t getTotalReserved();
+
+    private:
+
+        /* One list per small class, then one per power of two */
+        constexpr static size_t CLASSES = SMALL_LIMIT / ALIGNMENT + 64;
+
+        /* Return the size class of a block, and the size of a class */
+        static size_t classOf(size_t __n);
+        static size_t sizeOf(size_t __c);
+
+        /* Continue in a new chunk with room for at least @a __n bytes */
+        void grow(size_t __n);
+
+        /**
+         * Allocate a chunk of @a __n bytes, or less if the limit is close,
+         * but at least @a __min bytes.
+         *
+         * @param   __n    size of the chunk, set to the size allocated
+         * @param   __min  size needed
+         * @return  the chunk
+         * @throw   RuntimeError if the memory limit is reached
+         */
+        byte *reserve(size_t& __n, size_t __min);
+
+        std::vector<byte *> chunks;
+        byte *next = nullptr;
+        byte *end = nullptr;
+        size_t chunk_size = FIRST_CHUNK;
+
+        /* Freed blocks, each holding a pointer to the next one */
+        std::array<void *, CLASSES> free_lists = {};
+
+        size_t used = 0;
+        size_t reserved = 0;
+
+        static size_t limit;
+        static size_t total_used;
+        static size_t peak_used;
+        static size_t total_reserved;
+
+    };
+
+    /**
+     * Standard allocator over an arena, so containers of the module can
+     * keep their storage in it.
+     */
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+
+        using value_type = T;
+
+        ArenaAllocator(Arena& arena)
+            : arena(&arena) {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other)
+            : arena(other.arena) {}
+
+        T *allocate(size_t __n)
+        {
+            return static_cast<T *>(arena->allocate(__n * sizeof(T)));
+        }
+
+        void deallocate(T *__p, size_t __n)
+        {
+            arena->free(__p, __n * sizeof(T));
+        }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const
+        {
+            return arena == other.arena;
+        }
+
+        Arena *arena;
+
+    };
+
+    /* Vector with its storage in an arena */
+    template <typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // svm
+
+#endif // SVM_ARENA_H_
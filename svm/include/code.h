@@ -0,0 +1,45 @@
+/**
+ * The decoded form of a single instruction, which the interpreter runs.
+ *
+ */
+#ifndef SVM_CODE_H_
+#define SVM_CODE_H_
+
+#include <stdint.h>
+
+namespace svm
+{
+
+    /**
+     * A single decoded instruction, 32 bytes in size. The Decoder fills in
+     * the opcode and operands when the module is loaded, and the
+     * interpreter fills in the address of the handler of the opcode before
+     * running it, so dispatching is a single indirect jump through it.
+     *
+     * Jump targets are indexes into the decoded code of the module. Operands
+     * which don't fit are stored in the tables of the module, and @a c holds
+     * their index:
+     *
+     *  - CALLX: the external function
+     *  - EXTLD: the module name, in the strings
+     *  - JMPBS: the amount of cases and the fallback target in the tables,
+     *    followed by the key and the target of every case
+     *  - JMPTB: the amount of labels and the fallback target in the tables,
+     *    followed by the target of every label
+     *  - OBJMK: the object to copy
+     */
+    struct Code
+    {
+        const void *handler = nullptr;
+        uint8_t opcode = 0;
+        uint8_t reg = 0;
+        uint32_t a = 0;
+        uint32_t b = 0;
+        uint32_t c = 0;
+        int32_t imm = 0;
+        uint32_t target = 0;
+    };
+
+} // svm
+
+#endif // SVM_CODE_H_
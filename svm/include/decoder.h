@@ -0,0 +1,85 @@
+/**
+ * The decoder translates the code of a module into decoded instructions.
+ *
+ */
+#ifndef SVM_DECODER_H_
+#define SVM_DECODER_H_
+
+#include <string>
+#include <vector>
+
+#include "module.h"
+
+namespace svm
+{
+
+    /**
+     * The decoder reads every instruction of a module once, when it's
+     * loaded, so running it never parses mnemonics, operand encodings or
+     * label names again:
+     *
+     *  - opcodes of both layouts become the Opcode of the SCC4 format
+     *  - labels are resolved to the index of the instruction after them;
+     *    '#' labels and PASSL leave no instruction behind, and function
+     *    labels become an OP_RETRN, as running into one ends the function
+     *  - OBJMK payloads are decoded into objects which are copied onto the
+     *    tape, with the SCC3 newline escapes already replaced
+     *  - an OP_END is placed after the last instruction
+     *
+     * A jump to a label which doesn't exist goes to an OP_TRAP at the end of
+     * the code, which reports it once it's actually taken, as the old
+     * interpreter did.
+     */
+    class Decoder
+    {
+    public:
+
+        /**
+         * Decode the code of the module into its code and tables.
+         *
+         * @param   module  loaded module, with the bytecode and code range
+         * @throw   ValidatorError
+         */
+        static void decode(Module& module);
+
+    private:
+
+        /* A jump target to resolve once every label is known, of an
+           instruction or, if @a table is set, at an index of the tables */
+        struct Jump
+        {
+            std::string label;
+            size_t instruction;
+            bool table;
+            size_t index;
+        };
+
+        explicit Decoder(Module& module);
+
+        /* Decode every instruction, then resolve the jumps */
+        void run();
+
+        /* Decode the instruction at the reader into the code */
+        void decodeInstruction(salt::BytecodeReader& reader, size_t __n);
+
+        /* Point every jump at its label, or at a new trap if it's unknown */
+        void resolve();
+
+        /* Record the target of the last instruction to resolve */
+        void jumpTo(const std::string& label);
+
+        /* Add a target to the tables to resolve */
+        void tableJumpTo(const std::string& label);
+
+        /* Add a string to the module, return its index */
+        uint32_t addString(const std::string& text);
+
+        Module& module;
+
+        std::vector<Jump> jumps;
+
+    };
+
+} // svm
+
+#endif // SVM_DECODER_H_
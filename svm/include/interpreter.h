@@ -0,0 +1,112 @@
+/**
+ * The interpreter runs the code of the loaded modules.
+ *
+ */
+#ifndef SVM_INTERPRETER_H_
+#define SVM_INTERPRETER_H_
+
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "module.h"
+
+namespace svm
+{
+
+    /**
+     * The interpreter runs the code the Decoder made of each module, so no
+     * instruction is parsed more than once. Dispatch is direct threaded:
+     * before a module first runs, the address of the handler of each
+     * instruction is stored in it, and each handler ends by jumping through
+     * the address of the next one, so there is a single indirect jump per
+     * instruction and no shared switch for the branch predictor to choke
+     * on. Compilers without the labels as values extension get a switch in
+     * a loop instead.
+     *
+     * Running a module first runs its prelude, the code before the first
+     * function label. Reaching a function label by running into it ends the
+     * prelude or the current function, just like RETRN and the end of the
+     * code do. After the prelude of the main module, its main function is
+     * called. Modules loaded with EXTLD are looked up next to the module
+     * loading them, and their prelude is run as soon as they're loaded.
+     *
+     * The registers and the jump flag are shared by all modules, and every
+     * module has its own tape. Strings moved from a register to the tape of
+     * another module are moved to its arena, so every module only ever
+     * points into its own arena. Modules with the verified flag skip the
+     * type checks, which the compiler already proved. Object IDs are always
+     * checked, because a missing object would be a null pointer.
+     */
+    class Interpreter
+    {
+    public:
+
+        Interpreter() = default;
+        Interpreter(const Interpreter&) = delete;
+        Interpreter& operator=(const Interpreter&) = delete;
+
+        /* Allow the debug output of MLMAP and TRACE */
+        void setDebug(bool debug);
+
+        /**
+         * Load the module and run it.
+         *
+         * @param   path  path to the main module
+         * @throw   RuntimeError
+         */
+        void run(const std::string& path);
+
+    private:
+
+        /* Return address of a function call */
+        struct Frame
+        {
+            Module *module;
+            const Code *code;
+        };
+
+        /**
+         * Load a module and register it under its name.
+         *
+         * @throw   RuntimeError
+         */
+        Module *load(const std::string& path, const std::string& name);
+
+        /**
+         * Run the code of a module from the instruction, until it returns to
+         * the caller of this function.
+         *
+         * @param   module  module to run
+         * @param   __n     index of the first instruction
+         * @throw   RuntimeError
+         */
+        void execute(Module *module, uint32_t __n);
+
+        /* Find the function of a CALLX, once */
+        void resolve(External& external);
+
+        /* Print the call stack, with the current instruction on top */
+        void trace(const Module *module, const Code *code) const;
+
+        /* Describe the position of an instruction of a module */
+        static std::string locate(const Module *module, const Code *code);
+
+        /* The registers are destroyed first, their strings are in the
+           arenas of the modules */
+        std::map<std::string, std::unique_ptr<Module>> modules;
+        Arena arena;
+        ArenaVector<Frame> frames{arena};
+        std::array<Value, 256> registers;
+
+        bool flag = false;
+        bool debug = false;
+        bool exited = false;
+
+    };
+
+} // svm
+
+#endif // SVM_INTERPRETER_H_
@@ -0,0 +1,68 @@
+/**
+ * The loader reads SCC files into modules the interpreter can run.
+ *
+ */
+#ifndef SVM_LOADER_H_
+#define SVM_LOADER_H_
+
+#include <memory>
+#include <string>
+
+#include "module.h"
+#include "../../saltc/include/scc/section_table.h"
+
+namespace svm
+{
+
+    /**
+     * The loader accepts every file the compiler writes: flat or sectioned,
+     * compressed or not, in both operand encodings, and the legacy SCC3
+     * layout. Each file goes through the Validator first, on every hardware
+     * thread, which also expands compressed sections straight into the
+     * buffer the module keeps. Files with the verified flag go through the
+     * Verifier too, as the flag lets the interpreter skip its type checks.
+     * The constant pool is put on the tape of the module and the code is
+     * decoded by the Decoder, so running it never reads the bytecode again.
+     */
+    class Loader
+    {
+    public:
+
+        /**
+         * Load a module from a file.
+         *
+         * @param   path  path to the SCC file
+         * @param   name  name of the module, used by CALLX
+         * @return  loaded module
+         * @throw   RuntimeError
+         */
+        static std::unique_ptr<Module> load(const std::string& path,
+                                            const std::string& name);
+
+    private:
+
+        /**
+         * Check the header and find the code of the module.
+         *
+         * @throw   ValidatorError
+         */
+        static void loadHeader(Module& module);
+
+        /**
+         * Run the Verifier over a module which has the verified flag set.
+         * A module which fails any of the checks still runs, with every
+         * check done at runtime.
+         *
+         * @return  true if the module was proven
+         * @throw   ValidatorError
+         */
+        static bool verify(const Module& module);
+
+        /* Put every object of the constant pool on the tape */
+        static void readConstants(Module& module, const salt::Section& section);
+
+    };
+
+} // svm
+
+#endif // SVM_LOADER_H_
@@ -0,0 +1,90 @@
+/**
+ * A module is a single loaded SCC file, with its own objects.
+ *
+ */
+#ifndef SVM_MODULE_H_
+#define SVM_MODULE_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../saltc/include/utils.h"
+#include "../../saltc/include/scc/bytecode_reader.h"
+#include "arena.h"
+#include "code.h"
+#include "tape.h"
+
+namespace svm
+{
+
+    struct Module;
+
+    /* Function of another module called with CALLX, found on first use */
+    struct External
+    {
+        std::string module;
+        std::string function;
+        Module *target = nullptr;
+        uint32_t index = 0;
+    };
+
+    /**
+     * Everything the interpreter needs to run the code of a loaded file.
+     * The bytecode is the whole file, with compressed sections already
+     * expanded, which the Decoder turns into the code the interpreter runs.
+     * It's released once the module is decoded.
+     *
+     * The code, the objects and the tape are kept in the arena of the
+     * module, which is declared first so it goes last.
+     */
+    struct Module
+    {
+        Arena arena;
+
+        std::string name;
+        std::string path;
+        std::string bytecode;
+
+        salt::Encoding encoding = salt::ENCODING_FIXED;
+        bool legacy = false;
+
+        /* Set if the file has the verified flag and the loader proved the
+           module again, so the runtime type checks can be skipped */
+        bool verified = false;
+
+        /* Range of the instructions in the bytecode */
+        size_t code_start = 0;
+        size_t code_end = 0;
+
+        /* Decoded instructions, and the offset of each of them in the
+           code, for error messages */
+        ArenaVector<Code> code{arena};
+        ArenaVector<size_t> offsets{arena};
+
+        /* Operands which don't fit in the Code, see there */
+        ArenaVector<uint32_t> tables{arena};
+        ArenaVector<Value> objects{arena};
+        std::vector<std::string> strings;
+        std::vector<External> externals;
+
+        /* Index of the instruction right after each label */
+        std::unordered_map<std::string, uint32_t> labels;
+
+        /* Set once the handlers of the code are filled in */
+        bool bound = false;
+
+        Tape tape{arena};
+
+        /**
+         * Return a reader over the code of the module.
+         *
+         * @param   __n  offset to start reading at
+         * @return  reader which ends with the code
+         */
+        salt::BytecodeReader open(size_t __n) const;
+    };
+
+} // svm
+
+#endif // SVM_MODULE_H_
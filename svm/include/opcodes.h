@@ -0,0 +1,62 @@
+/**
+ * Opcodes of the SVM calls, as assigned in the SCC4 format.
+ *
+ */
+#ifndef SVM_OPCODES_H_
+#define SVM_OPCODES_H_
+
+namespace svm
+{
+
+    /**
+     * The SCC4 opcode of every SVM call, see doc/scc.html. Legacy SCC3
+     * mnemonics are mapped to the same numbers by the InstructionSet, so
+     * the interpreter only ever deals with these. OP_END and OP_TRAP are
+     * not real instructions, the Decoder places them after the code and
+     * for jumps to unknown labels. Labels never reach the interpreter.
+     */
+    enum Opcode : unsigned char
+    {
+        OP_LABEL = 0x00,
+        OP_CALLF = 0x01,
+        OP_CALLX = 0x02,
+        OP_CEQJF = 0x03,
+        OP_CEQJN = 0x04,
+        OP_CLTJF = 0x05,
+        OP_CLTJN = 0x06,
+        OP_CXXEQ = 0x07,
+        OP_CXXLT = 0x08,
+        OP_EXITE = 0x09,
+        OP_EXTLD = 0x0a,
+        OP_IVADD = 0x0b,
+        OP_IVAEQ = 0x0c,
+        OP_IVALT = 0x0d,
+        OP_IVSUB = 0x0e,
+        OP_IXADD = 0x0f,
+        OP_IXDIV = 0x10,
+        OP_IXMUL = 0x11,
+        OP_IXSUB = 0x12,
+        OP_JMPBS = 0x13,
+        OP_JMPFL = 0x14,
+        OP_JMPNF = 0x15,
+        OP_JMPTB = 0x16,
+        OP_JMPTO = 0x17,
+        OP_KILLX = 0x18,
+        OP_MLMAP = 0x19,
+        OP_OBJDL = 0x1a,
+        OP_OBJMK = 0x1b,
+        OP_PASSL = 0x1c,
+        OP_PRINT = 0x1d,
+        OP_RDUMP = 0x1e,
+        OP_RETRN = 0x1f,
+        OP_RGPOP = 0x20,
+        OP_RNULL = 0x21,
+        OP_RPUSH = 0x22,
+        OP_TRACE = 0x23,
+        OP_END   = 0x24,
+        OP_TRAP  = 0x25
+    };
+
+} // svm
+
+#endif // SVM_OPCODES_H_
@@ -0,0 +1,32 @@
+/**
+ * Errors raised by the virtual machine while loading or running a module.
+ *
+ */
+#ifndef SVM_RUNTIME_ERROR_H_
+#define SVM_RUNTIME_ERROR_H_
+
+#include <stdexcept>
+#include <string>
+
+namespace svm
+{
+
+    /**
+     * A runtime error stops the whole virtual machine. The interpreter fills
+     * in the module and the offset of the instruction which raised it, so
+     * the handlers only have to describe what went wrong.
+     */
+    class RuntimeError : public std::runtime_error
+    {
+    public:
+
+        using std::runtime_error::runtime_error;
+
+        /* Module and code offset of the failed instruction, if known */
+        std::string where;
+
+    };
+
+} // svm
+
+#endif // SVM_RUNTIME_ERROR_H_
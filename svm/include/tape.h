@@ -0,0 +1,149 @@
+/**
+ * The tape holds the objects of a single module.
+ *
+ */
+#ifndef SVM_TAPE_H_
+#define SVM_TAPE_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+#include "value.h"
+
+namespace svm
+{
+
+    /**
+     * The tape is the object list of doc/scc.html, kept as a flat array of
+     * slots indexed by the object ID, so finding an object is a single load.
+     * The values are stored in the slots themselves.
+     * The compiler hands out IDs densely and writes the highest one to the
+     * header, which the array is sized from. IDs from DENSE_LIMIT on are
+     * kept in a map instead, so a sparse ID doesn't blow up the array.
+     *
+     * Creating an object with an ID which is already used shadows the older
+     * one until the new one is deleted, like in a recursive call. The
+     * shadowed object is moved to a node of its own, and nodes of deleted
+     * objects are kept on a free list for the next one.
+     *
+     * All of it is kept in the arena of the module.
+     */
+    class Tape
+    {
+    public:
+
+        /* IDs below this are kept in the flat array */
+        constexpr static uint DENSE_LIMIT = 1 << 16;
+
+        /**
+         * @param   arena  arena of the module
+         */
+        explicit Tape(Arena& arena);
+
+        Tape(const Tape&) = delete;
+        Tape& operator=(const Tape&) = delete;
+
+        /**
+         * Make room in the array for the IDs below @a __n, like the amount
+         * of object slots from the header.
+         *
+         * @param   __n  amount of slots
+         * @throw   RuntimeError if the memory limit is reached
+         */
+        void reserve(uint __n);
+
+        /**
+         * Put an object on the tape.
+         *
+         * @param   id     object ID
+         * @param   value  value of the object
+         * @throw   RuntimeError if the memory limit is reached
+         */
+        void push(uint id, Value&& value);
+
+        /**
+         * Find the newest object with the ID. The pointer is valid until
+         * the next push().
+         *
+         * @param   id  object ID
+         * @return  the value, or nullptr if there is none
+         */
+        Value *find(uint id);
+
+        /**
+         * Move an object off the tape, like into a register.
+         *
+         * @param   id     object ID
+         * @param   value  value to move it to
+         * @return  false if there was no such object
+         */
+        bool take(uint id, Value& value);
+
+        /**
+         * Delete an object.
+         *
+         * @param   id  object ID
+         * @return  false if there was no such object
+         */
+        bool remove(uint id);
+
+        /* Print every object by its ID, for MLMAP */
+        void dump(const std::string& name) const;
+
+    private:
+
+        /* The newest object of an ID, and the node of the one it shadows,
+           where 0 is none and n is the node at index n - 1 */
+        struct Slot
+        {
+            Value value;
+            uint32_t shadow = 0;
+
+            Slot() { value.type = Value::TYPE_NONE; }
+
+            bool empty() const { return value.type == Value::TYPE_NONE; }
+        };
+
+        /* Return the slot of the ID, or nullptr if it was never used */
+        Slot *locate(uint id);
+
+        /* Return a free node, which links to the next free one */
+        uint32_t allocate();
+
+        void dumpSlot(uint id, const Slot& slot) const;
+
+        using SparseMap = std::unordered_map<uint, Slot, std::hash<uint>,
+            std::equal_to<uint>, ArenaAllocator<std::pair<const uint, Slot>>>;
+
+        ArenaVector<Slot> slots;
+        SparseMap sparse;
+
+        /* Shadowed objects, and the first free node */
+        ArenaVector<Slot> nodes;
+        uint32_t free_nodes = 0;
+
+    };
+
+    // Defined here, as almost every instruction calls it
+    inline Value *Tape::find(uint id)
+    {
+        Slot *slot;
+        if (id < slots.size()) {
+            slot = &slots[id];
+        } else {
+            if (id < DENSE_LIMIT)
+                return nullptr;
+            auto found = sparse.find(id);
+            if (found == sparse.end())
+                return nullptr;
+            slot = &found->second;
+        }
+
+        return slot->empty() ? nullptr : &slot->value;
+    }
+
+} // svm
+
+#endif // SVM_TAPE_H_
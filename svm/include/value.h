@@ -0,0 +1,161 @@
+/**
+ * Values are what the virtual machine works with, on the tape of a module
+ * and in the registers.
+ *
+ */
+#ifndef SVM_VALUE_H_
+#define SVM_VALUE_H_
+
+#include <string>
+#include <string_view>
+#include <stdint.h>
+
+#include "../../saltc/include/utils.h"
+#include "../../saltc/include/scc/instruction_set.h"
+#include "../../saltc/include/scc/synthesizer.h"
+#include "arena.h"
+
+namespace svm
+{
+
+    /* A string in an arena, followed by its bytes */
+    struct Text
+    {
+        Arena *arena;
+        size_t size;
+    };
+
+    /**
+     * A single value of one of the Synthesizer TYPE_ types, in 16 bytes: the
+     * type and the readonly flag, and the payload inline. Only strings are
+     * allocated, in an arena, and owned by the value, so moving a value just
+     * moves the pointer. Copies have to name the arena to copy the string
+     * to. Values are stored right in the tape slots and the registers, so
+     * arithmetic never follows a pointer to get to them.
+     */
+    struct Value
+    {
+        /* Type of an empty tape slot, which no instruction ever sees */
+        constexpr static byte TYPE_NONE = (byte) 0xff;
+
+        byte type = salt::Synthesizer::TYPE_NULL;
+        bool readonly = false;
+
+        /* Ints and bools use the number, strings the text */
+        union
+        {
+            int64_t number;
+            float real;
+            Text *text;
+        };
+
+        Value();
+        Value(const Value&) = delete;
+        Value(Value&& other) noexcept;
+        Value& operator=(const Value&) = delete;
+        Value& operator=(Value&& other) noexcept;
+        ~Value();
+
+        /**
+         * Create a value from the payload of an OBJMK.
+         *
+         * @param   payload  decoded OPERAND_OBJECT
+         * @param   arena    arena to put a string in
+         * @return  new value
+         * @throw   RuntimeError for unknown types, or the memory limit
+         */
+        static Value make(const salt::Operand& payload, Arena& arena);
+
+        /**
+         * Copy the value, with a string copied to the arena.
+         *
+         * @throw   RuntimeError if the memory limit is reached
+         */
+        Value copy(Arena& arena) const;
+
+        /**
+         * Move a string which is in another arena to this one, like when
+         * a register is moved to the tape of another module.
+         *
+         * @throw   RuntimeError if the memory limit is reached
+         */
+        void adopt(Arena& arena);
+
+        /* Bytes of a string */
+        std::string_view string() const;
+
+        /* Return true for ints and floats */
+        bool isNumber() const;
+
+        /* Value of an int or a float */
+        double toDouble() const;
+
+        /* Return the value as PRINT shows it */
+        std::string format() const;
+
+        /* Name of the type, for error messages */
+        const char *typeName() const;
+
+        /**
+         * Compare the values. Ints and floats compare by their numeric
+         * value, any other mix of types is never equal.
+         */
+        bool equals(const Value& other) const;
+
+        /**
+         * Return true if the value is less than the other one. Numbers
+         * compare by value, strings by their bytes and false is less than
+         * true; any other mix of types is never less.
+         */
+        bool lessThan(const Value& other) const;
+
+    private:
+
+        /* Put a string in the arena */
+        static Text *makeText(std::string_view string, Arena& arena);
+
+        /* Free the string, if it's one */
+        void release();
+    };
+
+    static_assert(sizeof(Value) == 16, "values have to stay 16 bytes");
+
+    // Values are moved by every RPUSH and RGPOP, so these are defined here
+
+    inline Value::Value()
+        : number(0) {}
+
+    inline Value::Value(Value&& other) noexcept
+        : type(other.type), readonly(other.readonly), number(other.number)
+    {
+        other.type = salt::Synthesizer::TYPE_NULL;
+    }
+
+    inline Value& Value::operator=(Value&& other) noexcept
+    {
+        if (this == &other)
+            return *this;
+
+        release();
+        type = other.type;
+        readonly = other.readonly;
+        number = other.number;
+        other.type = salt::Synthesizer::TYPE_NULL;
+        return *this;
+    }
+
+    inline Value::~Value()
+    {
+        release();
+    }
+
+    inline void Value::release()
+    {
+        if (type == salt::Synthesizer::TYPE_STRING)
+            text->arena->free(text, sizeof(Text) + text->size);
+        type = salt::Synthesizer::TYPE_NULL;
+    }
+
+} // svm
+
+#endif // SVM_VALUE_H_
@@ -0,0 +1,164 @@
+/**
+ * arena.h implementation
+ *
+ */
+#include "../include/arena.h"
+#include "../include/runtime_error.h"
+
+#include <algorithm>
+#include <bit>
+#include <new>
+#include <stdlib.h>
+
+namespace svm
+{
+
+size_t Arena::limit = 0;
+size_t Arena::total_used = 0;
+size_t Arena::peak_used = 0;
+size_t Arena::total_reserved = 0;
+
+Arena::~Arena()
+{
+    for (byte *chunk : chunks)
+        ::free(chunk);
+    total_used -= used;
+    total_reserved -= reserved;
+}
+
+void *Arena::allocate(size_t __n)
+{
+    size_t c = classOf(__n);
+    size_t size = sizeOf(c);
+
+    void *block = free_lists[c];
+    if (block) {
+        free_lists[c] = *static_cast<void **>(block);
+    } else if (size > LARGE_BLOCK) {
+        // Large blocks get a chunk of their own, the current one goes on
+        size_t chunk = size;
+        block = reserve(chunk, size);
+    } else {
+        if ((size_t) (end - next) < size)
+            grow(size);
+        block = next;
+        next += size;
+    }
+
+    used += size;
+    total_used += size;
+    peak_used = std::max(peak_used, total_used);
+    return block;
+}
+
+void Arena::free(void *__p, size_t __n)
+{
+    if (!__p)
+        return;
+
+    size_t c = classOf(__n);
+    size_t size = sizeOf(c);
+    used -= size;
+    total_used -= size;
+
+    if (size <= LARGE_BLOCK) {
+        *static_cast<void **>(__p) = free_lists[c];
+        free_lists[c] = __p;
+        return;
+    }
+
+    // Large blocks are whole chunks, like the old buffer of a vector which
+    // grew, so they go right back
+    auto chunk = std::find(chunks.begin(), chunks.end(), __p);
+    chunks.erase(chunk);
+    ::free(__p);
+    reserved -= size;
+    total_reserved -= size;
+}
+
+size_t Arena::getUsed() const
+{
+    return used;
+}
+
+void Arena::setLimit(size_t __n)
+{
+    limit = __n;
+}
+
+size_t Arena::getTotalUsed()
+{
+    return total_used;
+}
+
+size_t Arena::getPeakUsed()
+{
+    return peak_used;
+}
+
+size_t Arena::getTotalReserved()
+{
+    return total_reserved;
+}
+
+// private
+
+size_t Arena::classOf(size_t __n)
+{
+    __n = std::max<size_t>(__n, 1);
+    if (__n <= SMALL_LIMIT)
+        return (__n - 1) / ALIGNMENT;
+
+    // 1024 bytes is the first power of two class
+    size_t bits = std::bit_width(__n - 1);
+    return SMALL_LIMIT / ALIGNMENT + bits - 10;
+}
+
+size_t Arena::sizeOf(size_t __c)
+{
+    if (__c < SMALL_LIMIT / ALIGNMENT)
+        return (__c + 1) * ALIGNMENT;
+    return (size_t) 1 << (__c - SMALL_LIMIT / ALIGNMENT + 10);
+}
+
+void Arena::grow(size_t __n)
+{
+    // Keep what's left of the current chunk in the free lists
+    size_t left = (end - next) & ~(ALIGNMENT - 1);
+    while (left >= ALIGNMENT) {
+        size_t size = std::min(left, SMALL_LIMIT);
+        size_t c = classOf(size);
+        *reinterpret_cast<void **>(next) = free_lists[c];
+        free_lists[c] = next;
+        next += size;
+        left -= size;
+    }
+
+    size_t size = std::max(__n, chunk_size);
+    next = reserve(size, __n);
+    end = next + size;
+    chunk_size = std::min(chunk_size * 2, MAX_CHUNK);
+}
+
+byte *Arena::reserve(size_t& __n, size_t __min)
+{
+    if (limit && total_reserved + __n > limit) {
+        // A smaller chunk may still fit under the limit
+        if (total_reserved + __min > limit)
+            throw RuntimeError("Memory limit of "
+                               + std::to_string(limit / 1024)
+                               + " KB exceeded");
+        __n = (limit - total_reserved) & ~(ALIGNMENT - 1);
+    }
+
+    byte *chunk = static_cast<byte *>(malloc(__n));
+    if (!chunk)
+        throw std::bad_alloc();
+
+    chunks.push_back(chunk);
+    reserved += __n;
+    total_reserved += __n;
+    return chunk;
+}
+
+} // svm
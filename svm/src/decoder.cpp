@@ -0,0 +1,192 @@
+/**
+ * decoder.h implementation
+ *
+ */
+#include "../include/decoder.h"
+#include "../include/opcodes.h"
+
+using salt::BytecodeReader;
+using salt::Operand;
+
+namespace svm
+{
+
+void Decoder::decode(Module& module)
+{
+    Decoder(module).run();
+}
+
+// private
+
+Decoder::Decoder(Module& module)
+    : module(module) {}
+
+void Decoder::run()
+{
+    BytecodeReader reader = module.open(module.code_start);
+    while (!reader.atEnd())
+        decodeInstruction(reader, reader.tell());
+
+    Code end;
+    end.opcode = OP_END;
+    module.code.push_back(end);
+    module.offsets.push_back(module.code_end);
+
+    resolve();
+}
+
+void Decoder::decodeInstruction(BytecodeReader& reader, size_t __n)
+{
+    std::string label;
+    const salt::InstructionInfo *info = reader.readInstruction(label);
+
+    if (!info) {
+        reader.endInstruction();
+        // Running into a function label ends the function before it
+        if (label[0] != '#') {
+            Code leave;
+            leave.opcode = OP_RETRN;
+            module.code.push_back(leave);
+            module.offsets.push_back(__n);
+        }
+        module.labels.emplace(label, module.code.size());
+        return;
+    }
+
+    std::vector<Operand> operands;
+    for (salt::OperandType type : info->operands)
+        operands.push_back(reader.readOperand(type));
+    reader.endInstruction();
+
+    if (info->opcode == OP_PASSL)
+        return;
+
+    Code code;
+    code.opcode = info->opcode;
+    module.code.push_back(code);
+    module.offsets.push_back(__n);
+
+    // Object IDs fill a, b and c in order, the rest depends on the call
+    Code& decoded = module.code.back();
+    uint32_t *ids[] = {&decoded.a, &decoded.b, &decoded.c};
+    size_t next_id = 0;
+    for (const Operand& operand : operands) {
+        switch (operand.type) {
+            case salt::OPERAND_ID:
+                *ids[next_id++] = (uint32_t) operand.number;
+                break;
+            case salt::OPERAND_IMMEDIATE:
+                decoded.imm = (int32_t) operand.number;
+                break;
+            case salt::OPERAND_REGISTER:
+                decoded.reg = (uint8_t) operand.number;
+                break;
+            default:
+                break;
+        }
+    }
+
+    switch (info->opcode) {
+        case OP_CALLF:
+        case OP_CEQJF:
+        case OP_CEQJN:
+        case OP_CLTJF:
+        case OP_CLTJN:
+        case OP_JMPFL:
+        case OP_JMPNF:
+        case OP_JMPTO:
+            jumpTo(operands.back().text);
+            break;
+
+        case OP_CALLX: {
+            External external;
+            external.module = operands[0].text;
+            external.function = operands[1].text;
+            decoded.c = module.externals.size();
+            module.externals.push_back(external);
+            break;
+        }
+
+        case OP_EXTLD:
+            decoded.c = addString(operands[0].text);
+            break;
+
+        case OP_JMPBS: {
+            const Operand& cases = operands[2];
+            decoded.c = module.tables.size();
+            module.tables.push_back(cases.keys.size());
+            tableJumpTo(operands[1].text);
+            for (size_t i = 0; i < cases.keys.size(); i++) {
+                module.tables.push_back((uint32_t) cases.keys[i]);
+                tableJumpTo(cases.labels[i]);
+            }
+            break;
+        }
+
+        case OP_JMPTB: {
+            const Operand& list = operands[3];
+            decoded.c = module.tables.size();
+            module.tables.push_back(list.labels.size());
+            tableJumpTo(operands[2].text);
+            for (const std::string& target : list.labels)
+                tableJumpTo(target);
+            break;
+        }
+
+        case OP_OBJMK: {
+            decoded.c = module.objects.size();
+            module.objects.push_back(Value::make(operands[1],
+                                                 module.arena));
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void Decoder::resolve()
+{
+    for (const Jump& jump : jumps) {
+        uint32_t target;
+        auto found = module.labels.find(jump.label);
+        if (found != module.labels.end()) {
+            target = found->second;
+        } else {
+            // Reported by the trap only if the jump is actually taken, at
+            // the instruction jumping to it
+            Code trap;
+            trap.opcode = OP_TRAP;
+            trap.c = addString(jump.label);
+            target = module.code.size();
+            module.code.push_back(trap);
+            module.offsets.push_back(module.offsets[jump.instruction]);
+        }
+
+        if (jump.table)
+            module.tables[jump.index] = target;
+        else
+            module.code[jump.instruction].target = target;
+    }
+    jumps.clear();
+}
+
+void Decoder::jumpTo(const std::string& label)
+{
+    jumps.push_back({label, module.code.size() - 1, false, 0});
+}
+
+void Decoder::tableJumpTo(const std::string& label)
+{
+    jumps.push_back({label, module.code.size() - 1, true,
+                     module.tables.size()});
+    module.tables.push_back(0);
+}
+
+uint32_t Decoder::addString(const std::string& text)
+{
+    module.strings.push_back(text);
+    return module.strings.size() - 1;
+}
+
+} // svm
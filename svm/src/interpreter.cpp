@@ -0,0 +1,457 @@
+/**
+ * interpreter.h implementation
+ *
+ */
+#include "../include/interpreter.h"
+#include "../include/loader.h"
+#include "../include/opcodes.h"
+#include "../include/runtime_error.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <stdio.h>
+
+// Threaded dispatch needs labels as values, a GCC extension Clang has too.
+// Building with SVM_SWITCH_DISPATCH defined selects the switch anyway.
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(SVM_SWITCH_DISPATCH)
+#define SVM_THREADED
+#endif
+
+using salt::Synthesizer;
+
+namespace svm
+{
+
+void Interpreter::setDebug(bool debug)
+{
+    this->debug = debug;
+}
+
+void Interpreter::run(const std::string& path)
+{
+    Module *main = load(path, std::filesystem::path(path).stem().string());
+    execute(main, 0);
+    if (exited)
+        return;
+
+    auto found = main->labels.find("main");
+    if (found == main->labels.end())
+        throw RuntimeError("Module '" + main->name + "' has no main function");
+    execute(main, found->second);
+}
+
+// private
+
+Module *Interpreter::load(const std::string& path, const std::string& name)
+{
+    std::unique_ptr<Module> module = Loader::load(path, name);
+    Module *loaded = module.get();
+    modules[name] = std::move(module);
+    return loaded;
+}
+
+void Interpreter::execute(Module *module, uint32_t __n)
+{
+#ifdef SVM_THREADED
+    static const void *const handlers[] = {
+        &&op_LABEL, &&op_CALLF, &&op_CALLX, &&op_CEQJF, &&op_CEQJN,
+        &&op_CLTJF, &&op_CLTJN, &&op_CXXEQ, &&op_CXXLT, &&op_EXITE,
+        &&op_EXTLD, &&op_IVADD, &&op_IVAEQ, &&op_IVALT, &&op_IVSUB,
+        &&op_IXADD, &&op_IXDIV, &&op_IXMUL, &&op_IXSUB, &&op_JMPBS,
+        &&op_JMPFL, &&op_JMPNF, &&op_JMPTB, &&op_JMPTO, &&op_KILLX,
+        &&op_MLMAP, &&op_OBJDL, &&op_OBJMK, &&op_PASSL, &&op_PRINT,
+        &&op_RDUMP, &&op_RETRN, &&op_RGPOP, &&op_RNULL, &&op_RPUSH,
+        &&op_TRACE, &&op_END, &&op_TRAP
+    };
+
+    // Every module runs its prelude first, so this binds it before any
+    // CALLX can get to it
+    if (!module->bound) {
+        for (Code& code : module->code)
+            code.handler = handlers[code.opcode];
+        module->bound = true;
+    }
+
+    #define OP(name)    op_##name:
+    #define DISPATCH()  goto *pc->handler
+#else
+    #define OP(name)    case OP_##name:
+    #define DISPATCH()  goto dispatch
+#endif
+    #define NEXT()      do { ++pc; DISPATCH(); } while (0)
+    #define JUMP(__n)   do { pc = code + (__n); DISPATCH(); } while (0)
+
+    size_t base = frames.size();
+    const Code *code = module->code.data();
+    const Code *pc = code + __n;
+
+    auto get = [&](uint id) {
+        Value *object = module->tape.find(id);
+        if (!object)
+            throw RuntimeError("Unknown object ID " + std::to_string(id));
+        return object;
+    };
+
+    auto getInt = [&](uint id) {
+        Value *object = get(id);
+        if (!module->verified && object->type != Synthesizer::TYPE_INT)
+            throw RuntimeError("Object " + std::to_string(id) + " is a "
+                               + object->typeName() + ", not an int");
+        return object;
+    };
+
+    // Readonly objects aren't tracked by the verifier, so this always runs
+    auto getWritable = [&](uint id) {
+        Value *object = getInt(id);
+        if (object->readonly)
+            throw RuntimeError("Object " + std::to_string(id)
+                               + " is readonly");
+        return object;
+    };
+
+    // Ints wrap around, like the ConstantFolder expects, so the math is
+    // done in uint64_t as signed overflow is undefined
+    auto addInt = [&](uint id, int64_t value) {
+        Value *object = getWritable(id);
+        object->number = (int64_t) ((uint64_t) object->number
+                                    + (uint64_t) value);
+    };
+
+    auto compare = [&](uint left, uint right, bool less) {
+        Value *a = get(left);
+        Value *b = get(right);
+        return less ? a->lessThan(*b) : a->equals(*b);
+    };
+
+    auto arithmetic = [&](byte op, uint to, uint from) {
+        Value *target = getWritable(to);
+        Value *value = get(from);
+        if (!module->verified && !value->isNumber())
+            throw RuntimeError("Object " + std::to_string(from) + " is a "
+                               + value->typeName() + ", not a number");
+
+        if (op == OP_IXDIV && value->toDouble() == 0)
+            throw RuntimeError("Division by zero");
+
+        if (value->type == Synthesizer::TYPE_INT) {
+            uint64_t left = (uint64_t) target->number;
+            uint64_t right = (uint64_t) value->number;
+            // The only quotient which doesn't fit
+            if (op == OP_IXDIV && value->number == -1
+                    && target->number == INT64_MIN)
+                throw RuntimeError("Integer overflow in division");
+            switch (op) {
+                case OP_IXADD: left += right; break;
+                case OP_IXSUB: left -= right; break;
+                case OP_IXMUL: left *= right; break;
+                default:
+                    target->number /= value->number;
+                    return;
+            }
+            target->number = (int64_t) left;
+            return;
+        }
+
+        double left = (double) target->number;
+        double right = value->toDouble();
+        switch (op) {
+            case OP_IXADD: left += right; break;
+            case OP_IXSUB: left -= right; break;
+            case OP_IXMUL: left *= right; break;
+            default:       left /= right; break;
+        }
+        // Also false for NaN, which has no int value either
+        if (!(left >= -0x1p63 && left < 0x1p63))
+            throw RuntimeError("Float result doesn't fit in an int");
+        target->number = (int64_t) left;
+    };
+
+    try {
+#ifdef SVM_THREADED
+        DISPATCH();
+#else
+    dispatch:
+        switch (pc->opcode) {
+#endif
+
+        OP(CALLF) {
+            frames.push_back({module, pc + 1});
+            JUMP(pc->target);
+        }
+
+        OP(CALLX) {
+            External& external = module->externals[pc->c];
+            if (!external.target)
+                resolve(external);
+            frames.push_back({module, pc + 1});
+            module = external.target;
+            code = module->code.data();
+            JUMP(external.index);
+        }
+
+        OP(CEQJF) {
+            flag = compare(pc->a, pc->b, false);
+            if (flag)
+                JUMP(pc->target);
+            NEXT();
+        }
+
+        OP(CEQJN) {
+            flag = compare(pc->a, pc->b, false);
+            if (!flag)
+                JUMP(pc->target);
+            NEXT();
+        }
+
+        OP(CLTJF) {
+            flag = compare(pc->a, pc->b, true);
+            if (flag)
+                JUMP(pc->target);
+            NEXT();
+        }
+
+        OP(CLTJN) {
+            flag = compare(pc->a, pc->b, true);
+            if (!flag)
+                JUMP(pc->target);
+            NEXT();
+        }
+
+        OP(CXXEQ) {
+            flag = compare(pc->a, pc->b, false);
+            NEXT();
+        }
+
+        OP(CXXLT) {
+            flag = compare(pc->a, pc->b, true);
+            NEXT();
+        }
+
+        OP(EXITE) {
+            exited = true;
+            return;
+        }
+
+        OP(EXTLD) {
+            const std::string& name = module->strings[pc->c];
+            if (!modules.count(name)) {
+                std::filesystem::path path = module->path;
+                Module *loaded = load(path.replace_filename(name + ".scc"),
+                                      name);
+                execute(loaded, 0);
+                if (exited)
+                    return;
+            }
+            NEXT();
+        }
+
+        OP(IVADD) {
+            addInt(pc->a, pc->imm);
+            NEXT();
+        }
+
+        OP(IVAEQ) {
+            addInt(pc->a, pc->imm);
+            flag = compare(pc->b, pc->c, false);
+            NEXT();
+        }
+
+        OP(IVALT) {
+            addInt(pc->a, pc->imm);
+            flag = compare(pc->b, pc->c, true);
+            NEXT();
+        }
+
+        OP(IVSUB) {
+            addInt(pc->a, -(int64_t) pc->imm);
+            NEXT();
+        }
+
+        OP(IXADD)
+        OP(IXDIV)
+        OP(IXMUL)
+        OP(IXSUB) {
+            arithmetic(pc->opcode, pc->a, pc->b);
+            NEXT();
+        }
+
+        OP(JMPBS) {
+            // The amount of cases and the fallback, then the cases sorted
+            // by their key
+            int64_t value = getInt(pc->a)->number;
+            const uint32_t *table = module->tables.data() + pc->c;
+            const uint32_t *cases = table + 2;
+            size_t low = 0;
+            size_t high = table[0];
+            while (low < high) {
+                size_t middle = (low + high) / 2;
+                if ((int32_t) cases[middle * 2] < value)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+
+            flag = low < table[0] && (int32_t) cases[low * 2] == value;
+            JUMP(flag ? cases[low * 2 + 1] : table[1]);
+        }
+
+        OP(JMPFL) {
+            if (flag)
+                JUMP(pc->target);
+            NEXT();
+        }
+
+        OP(JMPNF) {
+            if (!flag)
+                JUMP(pc->target);
+            NEXT();
+        }
+
+        OP(JMPTB) {
+            // Wrapping keeps the subtraction defined for any value, and
+            // turns values below the base into huge indexes
+            uint64_t index = (uint64_t) getInt(pc->a)->number
+                           - (uint64_t) (int64_t) pc->imm;
+            const uint32_t *table = module->tables.data() + pc->c;
+            flag = index < table[0];
+            JUMP(flag ? table[2 + index] : table[1]);
+        }
+
+        OP(JMPTO) {
+            JUMP(pc->target);
+        }
+
+        // Unwinds like EXITE, so the modules are still freed
+        OP(KILLX) {
+            fflush(stdout);
+            exited = true;
+            return;
+        }
+
+        OP(MLMAP) {
+            if (debug)
+                module->tape.dump(module->name);
+            NEXT();
+        }
+
+        OP(OBJDL) {
+            if (!module->tape.remove(pc->a))
+                throw RuntimeError("Unknown object ID "
+                                   + std::to_string(pc->a));
+            NEXT();
+        }
+
+        OP(OBJMK) {
+            const Value& object = module->objects[pc->c];
+            module->tape.push(pc->a, object.copy(module->arena));
+            NEXT();
+        }
+
+        // Never decoded, but part of the handler table
+        OP(LABEL)
+        OP(PASSL) {
+            NEXT();
+        }
+
+        OP(PRINT) {
+            std::string text = get(pc->a)->format();
+            fwrite(text.data(), 1, text.size(), stdout);
+            NEXT();
+        }
+
+        OP(RDUMP) {
+            std::string text = registers[pc->reg].format();
+            fwrite(text.data(), 1, text.size(), stdout);
+            NEXT();
+        }
+
+        OP(RETRN)
+        OP(END) {
+            if (frames.size() == base)
+                return;
+            module = frames.back().module;
+            code = module->code.data();
+            pc = frames.back().code;
+            frames.pop_back();
+            DISPATCH();
+        }
+
+        OP(RGPOP) {
+            Value& value = registers[pc->reg];
+            value.adopt(module->arena);
+            module->tape.push(pc->a, std::move(value));
+            NEXT();
+        }
+
+        OP(RNULL) {
+            for (Value& value : registers)
+                value = Value();
+            NEXT();
+        }
+
+        OP(RPUSH) {
+            Value& value = registers[pc->reg];
+            if (!module->tape.take(pc->a, value))
+                throw RuntimeError("Unknown object ID "
+                                   + std::to_string(pc->a));
+            NEXT();
+        }
+
+        OP(TRACE) {
+            if (debug)
+                trace(module, pc);
+            NEXT();
+        }
+
+        OP(TRAP) {
+            throw RuntimeError("Unknown label '" + module->strings[pc->c]
+                               + "'");
+        }
+
+#ifndef SVM_THREADED
+        }
+#endif
+    } catch (RuntimeError& e) {
+        if (e.where.empty())
+            e.where = locate(module, pc);
+        throw;
+    }
+
+    #undef OP
+    #undef DISPATCH
+    #undef NEXT
+    #undef JUMP
+}
+
+void Interpreter::resolve(External& external)
+{
+    auto found = modules.find(external.module);
+    if (found == modules.end())
+        throw RuntimeError("Module '" + external.module + "' is not loaded");
+
+    Module *target = found->second.get();
+    auto label = target->labels.find(external.function);
+    if (label == target->labels.end())
+        throw RuntimeError("Unknown label '" + external.function + "'");
+
+    external.target = target;
+    external.index = label->second;
+}
+
+void Interpreter::trace(const Module *module, const Code *code) const
+{
+    printf("Call stack:\n  %s\n", locate(module, code).c_str());
+    for (size_t i = frames.size(); i > 0; i--)
+        printf("  %s\n", locate(frames[i - 1].module,
+                                frames[i - 1].code).c_str());
+}
+
+std::string Interpreter::locate(const Module *module, const Code *code)
+{
+    char buf[32];
+    size_t offset = module->offsets[code - module->code.data()];
+    snprintf(buf, sizeof(buf), " +0x%04zx", offset - module->code_start);
+    return module->name + buf;
+}
+
+} // svm
@@ -0,0 +1,169 @@
+/**
+ * loader.h implementation
+ *
+ */
+#include "../include/loader.h"
+#include "../include/decoder.h"
+#include "../include/runtime_error.h"
+#include "../../saltc/include/scc/validator.h"
+#include "../../saltc/include/scc/image_reader.h"
+#include "../../saltc/include/scc/image_writer.h"
+#include "../../saltc/include/scc/verifier.h"
+#include "../../saltc/include/compiler_metadata.h"
+
+#include <fstream>
+#include <iterator>
+#include <string.h>
+
+using salt::BytecodeReader;
+using salt::CompilerMetadata;
+using salt::Synthesizer;
+
+namespace svm
+{
+
+std::unique_ptr<Module> Loader::load(const std::string& path,
+                                     const std::string& name)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw RuntimeError("Cannot open module '" + path + "'");
+
+    std::unique_ptr<Module> module = std::make_unique<Module>();
+    module->name = name;
+    module->path = path;
+    module->bytecode.assign(std::istreambuf_iterator<char>(file),
+                            std::istreambuf_iterator<char>());
+
+    // Every file is validated before any of it is decoded, the decoder
+    // and the interpreter trust the layout from then on. Compressed files
+    // are expanded by the validator, which is the only copy kept.
+    try {
+        salt::Validator validator(module->bytecode);
+        validator.setThreads(0);
+        validator.validate();
+        std::string expanded = validator.takeExpanded();
+        if (!expanded.empty())
+            module->bytecode = std::move(expanded);
+        loadHeader(*module);
+        // The flag is only a claim of the file, so it's trusted once the
+        // module is proven again
+        if (module->verified)
+            module->verified = verify(*module);
+        Decoder::decode(*module);
+    } catch (salt::ValidatorError e) {
+        throw RuntimeError("Invalid module '" + path + "': "
+                           + salt::validator_errors[e]);
+    }
+
+    // Everything needed to run the module is decoded by now
+    module->bytecode = std::string();
+    return module;
+}
+
+// private
+
+void Loader::loadHeader(Module& module)
+{
+    const std::array<byte, 6>& magic = CompilerMetadata::SCC_HEADER;
+    if (module.bytecode.size() < 64
+            || memcmp(module.bytecode.data(), magic.data(), magic.size()))
+        throw salt::ValidatorError::invalid_header;
+
+    BytecodeReader header(module.bytecode.data(), 64, salt::ENCODING_FIXED);
+    header.seek(8);
+    uint version = header.readRaw<uint16_t>();
+    uint flags = CompilerMetadata::getFlags(module.bytecode.data());
+    header.seek(24);
+    uint cstrings = header.readRaw<uint>();
+    header.seek(40);
+    uint slots = header.readRaw<uint>();
+    header.seek(48);
+    uint sections = header.readRaw<uint>();
+
+    if (version > Synthesizer::FORMAT)
+        throw salt::ValidatorError::invalid_header;
+
+    // Older files leave the slots at zero, their tape grows as it's used
+    module.tape.reserve(slots);
+    module.legacy = version <= CompilerMetadata::SCC_LEGACY_VERSION;
+    module.verified = flags & CompilerMetadata::SCC_FLAG_VERIFIED;
+    if (flags & CompilerMetadata::SCC_FLAG_COMPACT)
+        module.encoding = salt::ENCODING_COMPACT;
+
+    if (flags & CompilerMetadata::SCC_FLAG_SECTIONED) {
+        salt::SectionTable table = salt::SectionTable::read(module.bytecode,
+                                                            sections);
+        const salt::Section *code = table.find(salt::SECTION_CODE);
+        if (!code)
+            throw salt::ValidatorError::invalid_section;
+        module.code_start = code->offset;
+        module.code_end = code->offset + code->size;
+
+        const salt::Section *constants = table.find(salt::SECTION_CONSTANTS);
+        if (constants)
+            readConstants(module, *constants);
+        return;
+    }
+
+    // Flat files start the code after the const strings
+    BytecodeReader reader(module.bytecode.data(), module.bytecode.size(),
+                          module.encoding);
+    reader.seek(64);
+    for (uint i = 0; i < cstrings; i++) {
+        reader.skipString();
+        if (module.legacy && reader.readByte() != '\n')
+            throw salt::ValidatorError::const_string_size;
+    }
+    module.code_start = reader.tell();
+    module.code_end = module.bytecode.size();
+}
+
+bool Loader::verify(const Module& module)
+{
+    salt::Module image = salt::ImageReader::read(module.bytecode,
+                                                 module.name);
+    salt::Verifier verifier(image);
+    try {
+        verifier.verify();
+    } catch (salt::ValidatorError e) {
+        return false;
+    }
+
+    return verifier.isProven();
+}
+
+void Loader::readConstants(Module& module, const salt::Section& section)
+{
+    BytecodeReader reader(module.bytecode.data() + section.offset,
+                          section.size, salt::ENCODING_FIXED);
+    uint count = reader.readRaw<uint32_t>();
+
+    for (uint i = 0; i < count; i++) {
+        reader.seek(salt::ImageWriter::TABLE_HEADER_SIZE
+                    + (size_t) i * salt::ImageWriter::CONSTANT_SIZE);
+        uint id = reader.readRaw<uint32_t>();
+        byte type = reader.readByte();
+        reader.seek(reader.tell() + 3);
+        uint64_t value = reader.readRaw<uint64_t>();
+
+        salt::Operand payload;
+        payload.readonly = true;
+        payload.object_type = type;
+        payload.number = (int64_t) value;
+        if (type == Synthesizer::TYPE_FLOAT)
+            memcpy(&payload.real, &value, sizeof(float));
+        if (type == Synthesizer::TYPE_STRING) {
+            reader.seek(value);
+            uint length = reader.readRaw<uint32_t>();
+            if (length > section.size - reader.tell())
+                throw salt::ValidatorError::invalid_section;
+            payload.text.assign(module.bytecode.data() + section.offset
+                                + reader.tell(), length);
+        }
+
+        module.tape.push(id, Value::make(payload, module.arena));
+    }
+}
+
+} // svm
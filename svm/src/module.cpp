@@ -0,0 +1,18 @@
+/**
+ * module.h implementation
+ *
+ */
+#include "../include/module.h"
+
+namespace svm
+{
+
+salt::BytecodeReader Module::open(size_t __n) const
+{
+    salt::BytecodeReader reader(bytecode.data(), code_end, encoding);
+    reader.setLegacy(legacy);
+    reader.seek(__n);
+    return reader;
+}
+
+} // svm
@@ -0,0 +1,119 @@
+/**
+ * tape.h implementation
+ *
+ */
+#include "../include/tape.h"
+
+#include <algorithm>
+#include <stdio.h>
+
+namespace svm
+{
+
+Tape::Tape(Arena& arena)
+    : slots(arena), sparse(0, std::hash<uint>(), std::equal_to<uint>(), arena),
+      nodes(arena) {}
+
+void Tape::reserve(uint __n)
+{
+    __n = std::min(__n, DENSE_LIMIT);
+    if (__n > slots.size())
+        slots.resize(__n);
+}
+
+void Tape::push(uint id, Value&& value)
+{
+    if (id < DENSE_LIMIT && id >= slots.size())
+        slots.resize(id + 1);
+    Slot& slot = id < DENSE_LIMIT ? slots[id] : sparse[id];
+
+    if (!slot.empty()) {
+        uint32_t node = allocate();
+        nodes[node - 1] = std::move(slot);
+        slot.shadow = node;
+    }
+    slot.value = std::move(value);
+}
+
+bool Tape::take(uint id, Value& value)
+{
+    Slot *slot = locate(id);
+    if (!slot || slot->empty())
+        return false;
+
+    value = std::move(slot->value);
+    uint32_t node = slot->shadow;
+    if (!node) {
+        slot->value.type = Value::TYPE_NONE;
+        if (id >= DENSE_LIMIT)
+            sparse.erase(id);
+        return true;
+    }
+
+    // Bring back the shadowed object, and free its node
+    *slot = std::move(nodes[node - 1]);
+    nodes[node - 1].value.type = Value::TYPE_NONE;
+    nodes[node - 1].shadow = free_nodes;
+    free_nodes = node;
+    return true;
+}
+
+bool Tape::remove(uint id)
+{
+    Value value;
+    return take(id, value);
+}
+
+void Tape::dump(const std::string& name) const
+{
+    printf("Tape of '%s':\n", name.c_str());
+    for (size_t id = 0; id < slots.size(); id++)
+        dumpSlot(id, slots[id]);
+
+    std::vector<uint> ids;
+    for (const auto& [id, slot] : sparse)
+        ids.push_back(id);
+    std::sort(ids.begin(), ids.end());
+    for (uint id : ids)
+        dumpSlot(id, sparse.at(id));
+}
+
+// private
+
+Tape::Slot *Tape::locate(uint id)
+{
+    if (id < DENSE_LIMIT)
+        return id < slots.size() ? &slots[id] : nullptr;
+
+    auto found = sparse.find(id);
+    return found == sparse.end() ? nullptr : &found->second;
+}
+
+uint32_t Tape::allocate()
+{
+    if (!free_nodes) {
+        nodes.emplace_back();
+        return nodes.size();
+    }
+
+    uint32_t node = free_nodes;
+    free_nodes = nodes[node - 1].shadow;
+    return node;
+}
+
+void Tape::dumpSlot(uint id, const Slot& slot) const
+{
+    // The newest object first, then the ones it shadows
+    const Slot *current = &slot;
+    while (!current->empty()) {
+        const Value& value = current->value;
+        printf("  $%u  %s%s %s%s\n", id, value.readonly ? "readonly " : "",
+               value.typeName(), value.format().c_str(),
+               current == &slot ? "" : " (shadowed)");
+        if (!current->shadow)
+            break;
+        current = &nodes[current->shadow - 1];
+    }
+}
+
+} // svm
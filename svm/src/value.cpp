@@ -0,0 +1,138 @@
+/**
+ * value.h implementation
+ *
+ */
+#include "../include/value.h"
+#include "../include/runtime_error.h"
+#include "../../saltc/include/scc/synthesizer.h"
+
+#include <algorithm>
+#include <stdio.h>
+
+using salt::Synthesizer;
+
+namespace svm
+{
+
+Value Value::make(const salt::Operand& payload, Arena& arena)
+{
+    if (payload.object_type > Synthesizer::TYPE_STRING)
+        throw RuntimeError("Unknown object type "
+                           + std::to_string((int) payload.object_type));
+
+    Value value;
+    value.readonly = payload.readonly;
+    value.number = payload.number;
+    if (payload.object_type == Synthesizer::TYPE_FLOAT)
+        value.real = payload.real;
+
+    if (payload.object_type == Synthesizer::TYPE_STRING)
+        value.text = makeText(payload.text, arena);
+
+    value.type = payload.object_type;
+    return value;
+}
+
+Value Value::copy(Arena& arena) const
+{
+    Value value;
+    value.readonly = readonly;
+    value.number = number;
+    if (type == Synthesizer::TYPE_STRING)
+        value.text = makeText(string(), arena);
+    value.type = type;
+    return value;
+}
+
+void Value::adopt(Arena& arena)
+{
+    if (type != Synthesizer::TYPE_STRING || text->arena == &arena)
+        return;
+    *this = copy(arena);
+}
+
+std::string_view Value::string() const
+{
+    return {reinterpret_cast<const char *>(text + 1), text->size};
+}
+
+bool Value::isNumber() const
+{
+    return type == Synthesizer::TYPE_INT || type == Synthesizer::TYPE_FLOAT;
+}
+
+double Value::toDouble() const
+{
+    return type == Synthesizer::TYPE_FLOAT ? real : (double) number;
+}
+
+std::string Value::format() const
+{
+    char buf[32];
+    switch (type) {
+        case Synthesizer::TYPE_INT:
+            snprintf(buf, sizeof(buf), "%lld", (long long) number);
+            return buf;
+        case Synthesizer::TYPE_FLOAT:
+            snprintf(buf, sizeof(buf), "%f", real);
+            return buf;
+        case Synthesizer::TYPE_BOOL:
+            return number ? "true" : "false";
+        case Synthesizer::TYPE_STRING:
+            return std::string(string());
+        default:
+            return "null";
+    }
+}
+
+const char *Value::typeName() const
+{
+    const char *names[] = {"null", "int", "float", "bool", "string"};
+    return type >= 0 && type <= Synthesizer::TYPE_STRING
+         ? names[(int) type] : "?";
+}
+
+bool Value::equals(const Value& other) const
+{
+    if (isNumber() && other.isNumber()) {
+        if (type == Synthesizer::TYPE_INT && other.type == type)
+            return number == other.number;
+        return toDouble() == other.toDouble();
+    }
+
+    if (type != other.type)
+        return false;
+    if (type == Synthesizer::TYPE_STRING)
+        return string() == other.string();
+    return type == Synthesizer::TYPE_NULL || number == other.number;
+}
+
+bool Value::lessThan(const Value& other) const
+{
+    if (isNumber() && other.isNumber()) {
+        if (type == Synthesizer::TYPE_INT && other.type == type)
+            return number < other.number;
+        return toDouble() < other.toDouble();
+    }
+
+    if (type != other.type)
+        return false;
+    if (type == Synthesizer::TYPE_STRING)
+        return string() < other.string();
+    return type == Synthesizer::TYPE_BOOL && number < other.number;
+}
+
+// private
+
+Text *Value::makeText(std::string_view string, Arena& arena)
+{
+    Text *text = static_cast<Text *>(arena.allocate(sizeof(Text)
+                                                    + string.size()));
+    text->arena = &arena;
+    text->size = string.size();
+    std::copy(string.begin(), string.end(),
+              reinterpret_cast<char *>(text + 1));
+    return text;
+}
+
+} // svm
@@ -0,0 +1,124 @@
+/**
+ * The Salt Virtual Machine runs modules compiled by saltc.
+ *
+ */
+#include "include/arena.h"
+#include "include/interpreter.h"
+#include "include/runtime_error.h"
+#include "../saltc/include/scc/disassembler.h"
+#include "../saltc/include/scc/validator.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SVM_VERSION "0.13"
+
+static void usage(FILE *stream)
+{
+    fprintf(stream,
+        "usage: svm [OPTION].. FILE\n\n"
+        "FILE                      the compiled salt executable\n"
+        "-h, --help                show this and exit\n"
+        "-v, --version             show the version and exit\n"
+        "-m, --mem-used            show the amount of memory used at the end\n"
+        "-d, --allow-debug         allow debug output from MLMAP & TRACE\n"
+        "-l, --limit-mem [KB]      limit the memory usage to a certain amount "
+        "of kilobytes\n"
+        "-D, --disassemble         disassemble the passed file\n");
+}
+
+static void print_memory()
+{
+    fprintf(stderr, "svm: %zu bytes of memory used, %zu bytes at most, "
+            "%zu KB reserved\n", svm::Arena::getTotalUsed(),
+            svm::Arena::getPeakUsed(),
+            (svm::Arena::getTotalReserved() + 1023) / 1024);
+}
+
+static int disassemble(const char *path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::string bytecode((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+    try {
+        printf("%s", salt::Disassembler(bytecode).render().c_str());
+    } catch (salt::ValidatorError e) {
+        fprintf(stderr, "svm: cannot disassemble '%s': %s\n", path,
+                salt::validator_errors[e].c_str());
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = nullptr;
+    bool debug = false;
+    bool listing = false;
+    bool memory = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            usage(stdout);
+            return 0;
+        } else if (!strcmp(argv[i], "-v") || !strcmp(argv[i], "--version")) {
+            printf("svm %s\n", SVM_VERSION);
+            return 0;
+        } else if (!strcmp(argv[i], "-d")
+                || !strcmp(argv[i], "--allow-debug")) {
+            debug = true;
+        } else if (!strcmp(argv[i], "-D")
+                || !strcmp(argv[i], "--disassemble")) {
+            listing = true;
+        } else if (!strcmp(argv[i], "-m") || !strcmp(argv[i], "--mem-used")) {
+            memory = true;
+        } else if (!strcmp(argv[i], "-l")
+                || !strcmp(argv[i], "--limit-mem")) {
+            char *end = nullptr;
+            unsigned long kilobytes = i + 1 < argc
+                                    ? strtoul(argv[i + 1], &end, 10) : 0;
+            if (!kilobytes || *end) {
+                fprintf(stderr, "svm: '%s' needs an amount of kilobytes\n",
+                        argv[i]);
+                return 1;
+            }
+            svm::Arena::setLimit((size_t) kilobytes * 1024);
+            i++;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "svm: unknown option '%s'\n", argv[i]);
+            return 1;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (!path) {
+        usage(stderr);
+        return 1;
+    }
+
+    if (listing)
+        return disassemble(path);
+
+    svm::Interpreter interpreter;
+    interpreter.setDebug(debug);
+    try {
+        interpreter.run(path);
+    } catch (const svm::RuntimeError& e) {
+        fflush(stdout);
+        fprintf(stderr, "svm: %s%s%s\n", e.where.c_str(),
+                e.where.empty() ? "" : ": ", e.what());
+        if (memory)
+            print_memory();
+        return 1;
+    }
+
+    fflush(stdout);
+    if (memory)
+        print_memory();
+    return 0;
+}
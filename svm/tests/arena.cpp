@@ -0,0 +1,76 @@
+/**
+ * Tests of the Arena.
+ */
+#include "test.h"
+#include "../include/arena.h"
+#include "../include/runtime_error.h"
+
+#include <string.h>
+
+using namespace svm;
+
+TEST(arena_reuses_freed_blocks)
+{
+    Arena arena;
+    void *small = arena.allocate(40);
+    void *large = arena.allocate(1000);
+    CHECK_EQ((size_t) small % Arena::ALIGNMENT, 0u);
+    CHECK_EQ(arena.getUsed(), 48u + 1024);
+
+    arena.free(small, 40);
+    arena.free(large, 1000);
+    CHECK_EQ(arena.getUsed(), 0u);
+
+    // Any size of the same class gets the block back
+    CHECK_EQ(arena.allocate(33), small);
+    CHECK_EQ(arena.allocate(600), large);
+}
+
+TEST(arena_counts_all_arenas)
+{
+    size_t used = Arena::getTotalUsed();
+    size_t reserved = Arena::getTotalReserved();
+    {
+        Arena arena;
+        arena.allocate(100);
+        arena.allocate(Arena::LARGE_BLOCK * 4);
+        CHECK_EQ(Arena::getTotalUsed(), used + 112 + Arena::LARGE_BLOCK * 4);
+        CHECK(Arena::getTotalReserved() > reserved);
+        CHECK(Arena::getPeakUsed() >= Arena::getTotalUsed());
+    }
+
+    // Deleting the arena gives everything back at once
+    CHECK_EQ(Arena::getTotalUsed(), used);
+    CHECK_EQ(Arena::getTotalReserved(), reserved);
+}
+
+TEST(arena_stops_at_the_limit)
+{
+    Arena arena;
+    size_t limit = Arena::getTotalReserved() + 64 * 1024;
+    Arena::setLimit(limit);
+
+    size_t allocated = 0;
+    try {
+        for (;;) {
+            arena.allocate(256);
+            allocated += 256;
+        }
+    } catch (const RuntimeError& e) {
+        CHECK(!strncmp(e.what(), "Memory limit of", 15));
+    }
+
+    // The last chunk is cut short to fit under the limit
+    CHECK(Arena::getTotalReserved() <= limit);
+    CHECK(allocated > 60 * 1024);
+
+    try {
+        Arena other;
+        other.allocate(Arena::LARGE_BLOCK * 2);
+        CHECK(!"allocated past the limit");
+    } catch (const RuntimeError&) {}
+    CHECK(Arena::getTotalReserved() <= limit);
+
+    Arena::setLimit(0);
+    arena.allocate(Arena::LARGE_BLOCK * 2);
+}
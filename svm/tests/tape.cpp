@@ -0,0 +1,103 @@
+/**
+ * Tests of the Tape.
+ */
+#include "test.h"
+#include "../include/tape.h"
+
+using namespace svm;
+using svm::test::integer;
+
+TEST(tape_pushes_and_takes_objects)
+{
+    Arena arena;
+    Tape tape(arena);
+    tape.reserve(4);
+
+    // Dense IDs, IDs past the reserved ones and sparse ones
+    for (uint id : {0u, 3u, 100u, Tape::DENSE_LIMIT + 7})
+        tape.push(id, integer(id));
+    for (uint id : {0u, 3u, 100u, Tape::DENSE_LIMIT + 7}) {
+        CHECK(tape.find(id));
+        if (tape.find(id))
+            CHECK_EQ(tape.find(id)->number, (int64_t) id);
+    }
+    CHECK(!tape.find(1));
+    CHECK(!tape.find(5000));
+    CHECK(!tape.find(Tape::DENSE_LIMIT + 8));
+
+    Value value;
+    CHECK(tape.take(100, value));
+    CHECK_EQ(value.number, 100);
+    CHECK(!tape.find(100));
+    CHECK(!tape.take(100, value));
+
+    CHECK(tape.remove(Tape::DENSE_LIMIT + 7));
+    CHECK(!tape.find(Tape::DENSE_LIMIT + 7));
+    CHECK(!tape.remove(Tape::DENSE_LIMIT + 7));
+    CHECK(!tape.remove(1));
+}
+
+TEST(tape_shadows_objects)
+{
+    Arena arena;
+    Tape tape(arena);
+
+    // Like a recursive call, each level hides the one before it
+    for (uint id : {2u, Tape::DENSE_LIMIT}) {
+        for (int64_t i = 0; i < 5; i++)
+            tape.push(id, integer(i));
+
+        for (int64_t i = 4; i >= 0; i--) {
+            Value value;
+            CHECK(tape.find(id));
+            CHECK(tape.take(id, value));
+            CHECK_EQ(value.number, i);
+        }
+        CHECK(!tape.find(id));
+    }
+}
+
+TEST(tape_reuses_shadow_nodes)
+{
+    Arena arena;
+    Tape tape(arena);
+    tape.push(0, integer(0));
+    tape.push(1, integer(1));
+
+    size_t used = 0;
+    for (int round = 0; round < 100; round++) {
+        for (int64_t i = 0; i < 20; i++)
+            tape.push(i % 2, integer(i));
+        for (int64_t i = 0; i < 20; i++)
+            CHECK(tape.remove(i % 2));
+
+        // The nodes of the first round are all the later ones need
+        if (!round)
+            used = arena.getUsed();
+        CHECK_EQ(arena.getUsed(), used);
+    }
+
+    CHECK_EQ(tape.find(0)->number, 0);
+    CHECK_EQ(tape.find(1)->number, 1);
+}
+
+TEST(tape_frees_strings)
+{
+    Arena arena;
+    Tape tape(arena);
+    tape.reserve(2);
+    size_t used = arena.getUsed();
+
+    tape.push(0, test::string("first", arena));
+    tape.push(0, test::string("second", arena));
+    tape.push(1, test::string("other", arena));
+    CHECK_EQ(tape.find(0)->string(), "second");
+
+    CHECK(tape.remove(0));
+    CHECK_EQ(tape.find(0)->string(), "first");
+    CHECK(tape.remove(0));
+    CHECK(tape.remove(1));
+
+    // Only the node the shadowed string was moved to is left
+    CHECK(arena.getUsed() - used <= 64);
+}
@@ -0,0 +1,77 @@
+/**
+ * test.h implementation, and the main function running all the tests.
+ */
+#include "test.h"
+
+#include <vector>
+#include <stdio.h>
+
+using salt::Synthesizer;
+
+namespace svm::test
+{
+
+namespace
+{
+    struct Test
+    {
+        const char *name;
+        void (*run)();
+    };
+
+    std::vector<Test>& tests()
+    {
+        static std::vector<Test> registered;
+        return registered;
+    }
+
+    uint failures = 0;
+}
+
+bool add(const char *name, void (*run)())
+{
+    tests().push_back({name, run});
+    return true;
+}
+
+void fail(const char *file, int line, const std::string& what)
+{
+    printf("    %s:%d: failed %s\n", file, line, what.c_str());
+    failures++;
+}
+
+Value integer(int64_t number)
+{
+    Value value;
+    value.type = Synthesizer::TYPE_INT;
+    value.number = number;
+    return value;
+}
+
+Value string(const std::string& text, Arena& arena)
+{
+    salt::Operand payload;
+    payload.type = salt::OPERAND_OBJECT;
+    payload.object_type = Synthesizer::TYPE_STRING;
+    payload.text = text;
+    return Value::make(payload, arena);
+}
+
+} // svm::test
+
+int main()
+{
+    using namespace svm::test;
+
+    uint failed = 0;
+    for (const Test& test : tests()) {
+        uint before = failures;
+        printf("%s\n", test.name);
+        test.run();
+        if (failures != before)
+            failed++;
+    }
+
+    printf("%zu tests, %u failed\n", tests().size(), failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+/**
+ * A small unit test framework for the parts of the virtual machine, the
+ * same as the one of the compiler. Each test is a function registered with
+ * the TEST macro, and the CHECK macros report the failed expression with
+ * its file and line, without stopping the test.
+ */
+#ifndef SVM_TEST_H_
+#define SVM_TEST_H_
+
+#include <string>
+#include <stdint.h>
+
+#include "../include/arena.h"
+#include "../include/value.h"
+
+namespace svm::test
+{
+
+    /* Register the test, always returns true */
+    bool add(const char *name, void (*run)());
+
+    /* Report a failed check of the running test */
+    void fail(const char *file, int line, const std::string& what);
+
+    /* Create an int value */
+    Value integer(int64_t number);
+
+    /* Create a string value in the arena */
+    Value string(const std::string& text, Arena& arena);
+
+} // svm::test
+
+#define TEST(name)                                                            \
+    static void test_##name();                                                \
+    static bool registered_##name = svm::test::add(#name, test_##name);       \
+    static void test_##name()
+
+#define CHECK(expression)                                                     \
+    do {                                                                      \
+        if (!(expression))                                                    \
+            svm::test::fail(__FILE__, __LINE__, #expression);                 \
+    } while (0)
+
+#define CHECK_EQ(left, right)                                                 \
+    do {                                                                      \
+        if (!((left) == (right)))                                             \
+            svm::test::fail(__FILE__, __LINE__, #left " == " #right);         \
+    } while (0)
+
+#endif // SVM_TEST_H_
@@ -0,0 +1,94 @@
+/**
+ * Tests of the Value.
+ */
+#include "test.h"
+#include "../include/value.h"
+
+using namespace svm;
+using svm::test::integer;
+
+TEST(value_moves_own_strings)
+{
+    Arena arena;
+    {
+        Value value = test::string("hello", arena);
+        CHECK(arena.getUsed() > 0);
+
+        Value moved = std::move(value);
+        CHECK_EQ(value.type, salt::Synthesizer::TYPE_NULL);
+        CHECK_EQ(moved.string(), "hello");
+
+        // Assigning frees the string it had
+        moved = integer(1);
+        CHECK_EQ(arena.getUsed(), 0u);
+
+        value = test::string("again", arena);
+        moved = std::move(value);
+        CHECK_EQ(moved.string(), "again");
+    }
+
+    CHECK_EQ(arena.getUsed(), 0u);
+}
+
+TEST(value_copies_strings_to_arenas)
+{
+    Arena first, second;
+    Value value = test::string("hello", first);
+    size_t used = first.getUsed();
+
+    Value copy = value.copy(second);
+    CHECK_EQ(copy.string(), "hello");
+    CHECK(copy.text != value.text);
+    CHECK_EQ(copy.text->arena, &second);
+    CHECK_EQ(first.getUsed(), used);
+    CHECK_EQ(second.getUsed(), used);
+
+    Value number = integer(7).copy(second);
+    CHECK_EQ(number.number, 7);
+    CHECK_EQ(second.getUsed(), used);
+}
+
+TEST(value_adopts_strings_of_other_arenas)
+{
+    Arena first, second;
+    Value value = test::string("passed around", first);
+    size_t used = first.getUsed();
+
+    // Like a register moved to the tape of another module
+    value.adopt(second);
+    CHECK_EQ(value.string(), "passed around");
+    CHECK_EQ(value.text->arena, &second);
+    CHECK_EQ(first.getUsed(), 0u);
+    CHECK_EQ(second.getUsed(), used);
+
+    // A string already in the arena is kept as it is
+    Text *text = value.text;
+    value.adopt(second);
+    CHECK_EQ(value.text, text);
+    CHECK_EQ(second.getUsed(), used);
+
+    Value number = integer(3);
+    number.adopt(first);
+    CHECK_EQ(number.number, 3);
+    CHECK_EQ(first.getUsed(), 0u);
+}
+
+TEST(value_compares_values)
+{
+    Arena arena;
+    Value big = integer((1ll << 53) + 1);
+    Value near = integer(1ll << 53);
+    CHECK(!big.equals(near));
+    CHECK(near.lessThan(big));
+
+    Value real;
+    real.type = salt::Synthesizer::TYPE_FLOAT;
+    real.real = 2.0f;
+    CHECK(integer(2).equals(real));
+    CHECK(integer(1).lessThan(real));
+
+    Value a = test::string("a", arena), b = test::string("b", arena);
+    CHECK(a.lessThan(b));
+    CHECK(!a.equals(integer(0)));
+    CHECK(!a.lessThan(integer(0)));
+}